@@ -252,6 +252,30 @@ CalendarScheduler::Remove (const Event &ev)
   NS_ASSERT (false);
 }
 
+void
+CalendarScheduler::RemoveCancelled (std::vector<Event> &cancelled)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t bucket = 0; bucket < m_nBuckets; bucket++)
+    {
+      Bucket::iterator i = m_buckets[bucket].begin ();
+      while (i != m_buckets[bucket].end ())
+        {
+          if (i->impl->IsCancelled ())
+            {
+              cancelled.push_back (*i);
+              i = m_buckets[bucket].erase (i);
+              m_qSize--;
+            }
+          else
+            {
+              ++i;
+            }
+        }
+    }
+  ResizeDown ();
+}
+
 void
 CalendarScheduler::ResizeUp (void)
 {
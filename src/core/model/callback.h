@@ -29,6 +29,7 @@
 #include "attribute-helper.h"
 #include "simple-ref-count.h"
 #include <typeinfo>
+#include <new>
 
 /**
  * \file
@@ -131,6 +132,68 @@ struct CallbackTraits<T *>
   }
 };
 
+/**
+ * \ingroup callbackimpl
+ *
+ * Trait class to tell whether a value can be copied byte per byte and
+ * needs no destruction: the CallbackImpl holding only such values can
+ * be stored inside the Callback rather than on the heap.
+ *
+ * This is true of pointers, of pointers to member functions and of
+ * the arithmetic types.
+ */
+template <typename T>
+struct CallbackIsTrivial
+{
+  /** Value. */
+  enum { value = TypeTraits<T>::IsPointer
+         || TypeTraits<T>::IsFunctionPointer
+         || TypeTraits<T>::IsPointerToMember };
+};
+/** CallbackIsTrivial of a const type. */
+template <typename T>
+struct CallbackIsTrivial<const T>
+{
+  /** Value. */
+  enum { value = CallbackIsTrivial<T>::value };
+};
+
+/**
+ * \ingroup callbackimpl
+ * Specialize CallbackIsTrivial for an arithmetic type.
+ * \param [in] type The arithmetic type.
+ */
+#define CALLBACK_IS_TRIVIAL(type)               \
+  template <>                                   \
+  struct CallbackIsTrivial<type>                \
+  {                                             \
+    /** Value. */                               \
+    enum { value = 1 };                         \
+  }
+
+/**
+ * \ingroup callbackimpl
+ * CallbackIsTrivial of the arithmetic types.
+ * @{
+ */
+CALLBACK_IS_TRIVIAL (bool);
+CALLBACK_IS_TRIVIAL (char);
+CALLBACK_IS_TRIVIAL (signed char);
+CALLBACK_IS_TRIVIAL (unsigned char);
+CALLBACK_IS_TRIVIAL (short);
+CALLBACK_IS_TRIVIAL (unsigned short);
+CALLBACK_IS_TRIVIAL (int);
+CALLBACK_IS_TRIVIAL (unsigned int);
+CALLBACK_IS_TRIVIAL (long);
+CALLBACK_IS_TRIVIAL (unsigned long);
+CALLBACK_IS_TRIVIAL (long long);
+CALLBACK_IS_TRIVIAL (unsigned long long);
+CALLBACK_IS_TRIVIAL (float);
+CALLBACK_IS_TRIVIAL (double);
+/**@}*/
+
+#undef CALLBACK_IS_TRIVIAL
+
 /**
  * \ingroup callbackimpl
  * Abstract base class for CallbackImpl
@@ -150,6 +213,12 @@ public:
   virtual bool IsEqual (Ptr<const CallbackImplBase> other) const = 0;
   /** Get the type as a string. */
   virtual std::string GetTypeid (void) const = 0;
+  /**
+   * Copy this implementation on the heap.
+   *
+   * \return The copy.
+   */
+  virtual Ptr<CallbackImplBase> Copy (void) const = 0;
 
 protected:
   /**
@@ -437,6 +506,12 @@ public:
   FunctorCallbackImpl (T const &functor)
     : m_functor (functor) {}
   virtual ~FunctorCallbackImpl () {}
+  /** Whether this can be stored inside a Callback. */
+  enum { IsTrivial = CallbackIsTrivial<T>::value };
+  virtual Ptr<CallbackImplBase> Copy (void) const
+  {
+    return Ptr<CallbackImplBase> (new FunctorCallbackImpl (*this), false);
+  }
   /**
    * Functor with varying numbers of arguments
    * @{
@@ -584,6 +659,12 @@ public:
   MemPtrCallbackImpl (OBJ_PTR const&objPtr, MEM_PTR memPtr)
     : m_objPtr (objPtr), m_memPtr (memPtr) {}
   virtual ~MemPtrCallbackImpl () {}
+  /** Whether this can be stored inside a Callback. */
+  enum { IsTrivial = CallbackIsTrivial<OBJ_PTR>::value };
+  virtual Ptr<CallbackImplBase> Copy (void) const
+  {
+    return Ptr<CallbackImplBase> (new MemPtrCallbackImpl (*this), false);
+  }
   /**
    * Functor with varying numbers of arguments
    * @{
@@ -733,6 +814,13 @@ public:
   BoundFunctorCallbackImpl (FUNCTOR functor, ARG a)
     : m_functor (functor), m_a (a) {}
   virtual ~BoundFunctorCallbackImpl () {}
+  /** Whether this can be stored inside a Callback. */
+  enum { IsTrivial = CallbackIsTrivial<T>::value
+         && CallbackIsTrivial<typename TypeTraits<TX>::ReferencedType>::value };
+  virtual Ptr<CallbackImplBase> Copy (void) const
+  {
+    return Ptr<CallbackImplBase> (new BoundFunctorCallbackImpl (*this), false);
+  }
   /**
    * Functor with varying numbers of arguments
    * @{
@@ -868,6 +956,14 @@ public:
   TwoBoundFunctorCallbackImpl (FUNCTOR functor, ARG1 arg1, ARG2 arg2)
     : m_functor (functor), m_a1 (arg1), m_a2 (arg2) {}
   virtual ~TwoBoundFunctorCallbackImpl () {}
+  /** Whether this can be stored inside a Callback. */
+  enum { IsTrivial = CallbackIsTrivial<T>::value
+         && CallbackIsTrivial<typename TypeTraits<TX1>::ReferencedType>::value
+         && CallbackIsTrivial<typename TypeTraits<TX2>::ReferencedType>::value };
+  virtual Ptr<CallbackImplBase> Copy (void) const
+  {
+    return Ptr<CallbackImplBase> (new TwoBoundFunctorCallbackImpl (*this), false);
+  }
   /**
    * Functor with varying numbers of arguments
    * @{
@@ -991,6 +1087,15 @@ public:
   ThreeBoundFunctorCallbackImpl (FUNCTOR functor, ARG1 arg1, ARG2 arg2, ARG3 arg3)
     : m_functor (functor), m_a1 (arg1), m_a2 (arg2), m_a3 (arg3) {}
   virtual ~ThreeBoundFunctorCallbackImpl () {}
+  /** Whether this can be stored inside a Callback. */
+  enum { IsTrivial = CallbackIsTrivial<T>::value
+         && CallbackIsTrivial<typename TypeTraits<TX1>::ReferencedType>::value
+         && CallbackIsTrivial<typename TypeTraits<TX2>::ReferencedType>::value
+         && CallbackIsTrivial<typename TypeTraits<TX3>::ReferencedType>::value };
+  virtual Ptr<CallbackImplBase> Copy (void) const
+  {
+    return Ptr<CallbackImplBase> (new ThreeBoundFunctorCallbackImpl (*this), false);
+  }
   /**
    * Functor with varying numbers of arguments
    * @{
@@ -1088,19 +1193,77 @@ private:
  * \ingroup callbackimpl
  * Base class for Callback class.
  * Provides pimpl abstraction.
+ *
+ * The implementations which hold only pointers and arithmetic values,
+ * such as a member function bound to a raw object pointer, are stored
+ * inside the CallbackBase rather than on the heap: creating, copying and
+ * destroying such a callback neither allocates nor counts references.
  */
 class CallbackBase {
 public:
-  CallbackBase () : m_impl () {}
-  /** \return The impl pointer */
-  Ptr<CallbackImplBase> GetImpl (void) const { return m_impl; }
+  CallbackBase () : m_impl (), m_inline (false) {}
+  /**
+   * \return The impl pointer; an implementation stored inside
+   *         this callback is copied on the heap.
+   */
+  Ptr<CallbackImplBase> GetImpl (void) const
+  {
+    if (m_inline)
+      {
+        return PeekImpl ()->Copy ();
+      }
+    return m_impl;
+  }
+  /** \return The impl pointer, valid as long as this callback is. */
+  CallbackImplBase * PeekImpl (void) const
+  {
+    if (m_inline)
+      {
+        return reinterpret_cast<CallbackImplBase *> (const_cast<char *> (m_storage.buffer));
+      }
+    return PeekPointer (m_impl);
+  }
 protected:
   /**
    * Construct from a pimpl
    * \param [in] impl The CallbackImplBase Ptr
    */
-  CallbackBase (Ptr<CallbackImplBase> impl) : m_impl (impl) {}
-  Ptr<CallbackImplBase> m_impl;         //!< the pimpl
+  CallbackBase (Ptr<CallbackImplBase> impl) : m_impl (impl), m_inline (false) {}
+  /**
+   * Set the implementation, inside this callback if it is small and
+   * trivial enough.
+   *
+   * \tparam IMPL \deduced The CallbackImpl class.
+   * \param [in] impl The implementation.
+   */
+  template <typename IMPL>
+  void SetImpl (IMPL const &impl)
+  {
+    if (IMPL::IsTrivial && sizeof (IMPL) <= sizeof (m_storage))
+      {
+        // the implementations have a single base, at offset 0
+        CallbackImplBase *base = new (m_storage.buffer) IMPL (impl);
+        NS_ASSERT (static_cast<void *> (base) == m_storage.buffer);
+        m_impl = 0;
+        m_inline = true;
+      }
+    else
+      {
+        m_impl = Ptr<CallbackImplBase> (new IMPL (impl), false);
+        m_inline = false;
+      }
+  }
+
+  Ptr<CallbackImplBase> m_impl;         //!< the pimpl, if not stored inline
+  /** Storage of the implementation, aligned for pointers. */
+  union
+  {
+    char buffer[5 * sizeof (void *)];   //!< the implementation
+    void *pointer;                      //!< alignment
+    double real;                        //!< alignment
+    long long integer;                  //!< alignment
+  } m_storage;
+  bool m_inline;                        //!< whether the pimpl is in m_storage
 };
 
 /**
@@ -1176,8 +1339,9 @@ public:
    */
   template <typename FUNCTOR>
   Callback (FUNCTOR const &functor, bool, bool) 
-    : CallbackBase (Create<FunctorCallbackImpl<FUNCTOR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> > (functor))
-  {}
+  {
+    SetImpl (FunctorCallbackImpl<FUNCTOR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> (functor));
+  }
 
   /**
    * Construct a member function pointer call back.
@@ -1187,8 +1351,9 @@ public:
    */
   template <typename OBJ_PTR, typename MEM_PTR>
   Callback (OBJ_PTR const &objPtr, MEM_PTR memPtr)
-    : CallbackBase (Create<MemPtrCallbackImpl<OBJ_PTR,MEM_PTR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> > (objPtr, memPtr))
-  {}
+  {
+    SetImpl (MemPtrCallbackImpl<OBJ_PTR,MEM_PTR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> (objPtr, memPtr));
+  }
 
   /**
    * Construct from a CallbackImpl pointer
@@ -1199,6 +1364,23 @@ public:
     : CallbackBase (impl)
   {}
 
+  /**
+   * Construct from a CallbackImpl, stored inside this callback if
+   * it holds only pointers and arithmetic values.
+   *
+   * \tparam IMPL \deduced The CallbackImpl class.
+   * \param [in] impl The CallbackImpl
+   *
+   * \internal
+   * There are three dummy args below to ensure that this constructor is
+   * always properly disambiguated by the c++ compiler.
+   */
+  template <typename IMPL>
+  Callback (IMPL const &impl, bool, bool, bool)
+  {
+    SetImpl (impl);
+  }
+
   /**
    * Bind the first arguments
    *
@@ -1261,6 +1443,7 @@ public:
   /** Discard the implementation, set it to null */
   void Nullify (void) {
     m_impl = 0;
+    m_inline = false;
   }
 
   /**
@@ -1379,7 +1562,7 @@ public:
    * \return \c true if we are equal
    */
   bool IsEqual (const CallbackBase &other) const {
-    return m_impl->IsEqual (other.GetImpl ());
+    return PeekImpl ()->IsEqual (Ptr<const CallbackImplBase> (other.PeekImpl ()));
   }
 
   /**
@@ -1389,7 +1572,7 @@ public:
    * \return \c true if other can be dynamic_cast to my type
    */
   bool CheckType (const CallbackBase & other) const {
-    return DoCheckType (other.GetImpl ());
+    return DoCheckType (other.PeekImpl ());
   }
   /**
    * Adopt the other's implementation, if type compatible
@@ -1397,22 +1580,22 @@ public:
    * \param [in] other Callback
    */
   bool Assign (const CallbackBase &other) {
-    return DoAssign (other.GetImpl ());
+    return DoAssign (other);
   }
 private:
   /** \return The pimpl pointer */
   CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *DoPeekImpl (void) const {
-    return static_cast<CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *> (PeekPointer (m_impl));
+    return static_cast<CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *> (PeekImpl ());
   }
   /**
    * Check for compatible types
    *
-   * \param [in] other Callback Ptr
+   * \param [in] other CallbackImpl pointer
    * \return \c true if other can be dynamic_cast to my type
    */
-  bool DoCheckType (Ptr<const CallbackImplBase> other) const {
+  bool DoCheckType (const CallbackImplBase *other) const {
     if (other != 0 &&
-        dynamic_cast<const CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *> (PeekPointer (other)) != 0)
+        dynamic_cast<const CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *> (other) != 0)
       {
         return true;
       }
@@ -1428,19 +1611,19 @@ private:
   /**
    * Adopt the other's implementation, if type compatible
    *
-   * \param [in] other Callback Ptr to adopt from
+   * \param [in] other Callback to adopt from
    */
-  bool DoAssign (Ptr<const CallbackImplBase> other) {
-    if (!DoCheckType (other))
+  bool DoAssign (const CallbackBase &other) {
+    if (!DoCheckType (other.PeekImpl ()))
       {
-        std::string othTid = other->GetTypeid ();
+        std::string othTid = other.PeekImpl ()->GetTypeid ();
         std::string myTid = CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9>::DoGetTypeid ();
         NS_FATAL_ERROR_CONT ("Incompatible types. (feed to \"c++filt -t\" if needed)" << std::endl <<
                         "got=" << othTid << std::endl <<
                         "expected=" << myTid);
         return false;
       }
-    m_impl = const_cast<CallbackImplBase *> (PeekPointer (other));
+    CallbackBase::operator = (other);
     return true;
   }
 };
@@ -1675,65 +1858,47 @@ Callback<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> MakeNullCallback (void) {
  */   
 template <typename R, typename TX, typename ARG>
 Callback<R> MakeBoundCallback (R (*fnPtr)(TX), ARG a1) {
-  Ptr<CallbackImpl<R,empty,empty,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX),R,TX,empty,empty,empty,empty,empty,empty,empty,empty> >(fnPtr, a1);
-  return Callback<R> (impl);
+  return Callback<R> (BoundFunctorCallbackImpl<R (*)(TX),R,TX,empty,empty,empty,empty,empty,empty,empty,empty> (fnPtr, a1), true, true, true);
 }
 template <typename R, typename TX, typename ARG, 
           typename T1>
 Callback<R,T1> MakeBoundCallback (R (*fnPtr)(TX,T1), ARG a1) {
-  Ptr<CallbackImpl<R,T1,empty,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1),R,TX,T1,empty,empty,empty,empty,empty,empty,empty> > (fnPtr, a1);
-  return Callback<R,T1> (impl);
+  return Callback<R,T1> (BoundFunctorCallbackImpl<R (*)(TX,T1),R,TX,T1,empty,empty,empty,empty,empty,empty,empty> (fnPtr, a1), true, true, true);
 }
 template <typename R, typename TX, typename ARG, 
           typename T1, typename T2>
 Callback<R,T1,T2> MakeBoundCallback (R (*fnPtr)(TX,T1,T2), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2),R,TX,T1,T2,empty,empty,empty,empty,empty,empty> > (fnPtr, a1);
-  return Callback<R,T1,T2> (impl);
+  return Callback<R,T1,T2> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2),R,TX,T1,T2,empty,empty,empty,empty,empty,empty> (fnPtr, a1), true, true, true);
 }
 template <typename R, typename TX, typename ARG,
           typename T1, typename T2,typename T3>
 Callback<R,T1,T2,T3> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,T3,empty,empty,empty,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3),R,TX,T1,T2,T3,empty,empty,empty,empty,empty> > (fnPtr, a1);
-  return Callback<R,T1,T2,T3> (impl);
+  return Callback<R,T1,T2,T3> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3),R,TX,T1,T2,T3,empty,empty,empty,empty,empty> (fnPtr, a1), true, true, true);
 }
 template <typename R, typename TX, typename ARG,
           typename T1, typename T2,typename T3,typename T4>
 Callback<R,T1,T2,T3,T4> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3,T4), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,empty,empty,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4),R,TX,T1,T2,T3,T4,empty,empty,empty,empty> > (fnPtr, a1);
-  return Callback<R,T1,T2,T3,T4> (impl);
+  return Callback<R,T1,T2,T3,T4> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4),R,TX,T1,T2,T3,T4,empty,empty,empty,empty> (fnPtr, a1), true, true, true);
 }
 template <typename R, typename TX, typename ARG,
           typename T1, typename T2,typename T3,typename T4,typename T5>
 Callback<R,T1,T2,T3,T4,T5> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3,T4,T5), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,empty,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5),R,TX,T1,T2,T3,T4,T5,empty,empty,empty> > (fnPtr, a1);
-  return Callback<R,T1,T2,T3,T4,T5> (impl);
+  return Callback<R,T1,T2,T3,T4,T5> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5),R,TX,T1,T2,T3,T4,T5,empty,empty,empty> (fnPtr, a1), true, true, true);
 }
 template <typename R, typename TX, typename ARG,
           typename T1, typename T2,typename T3,typename T4,typename T5, typename T6>
 Callback<R,T1,T2,T3,T4,T5,T6> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3,T4,T5,T6), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,T6,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5,T6),R,TX,T1,T2,T3,T4,T5,T6,empty,empty> > (fnPtr, a1);
-  return Callback<R,T1,T2,T3,T4,T5,T6> (impl);
+  return Callback<R,T1,T2,T3,T4,T5,T6> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5,T6),R,TX,T1,T2,T3,T4,T5,T6,empty,empty> (fnPtr, a1), true, true, true);
 }
 template <typename R, typename TX, typename ARG,
           typename T1, typename T2,typename T3,typename T4,typename T5, typename T6, typename T7>
 Callback<R,T1,T2,T3,T4,T5,T6,T7> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3,T4,T5,T6,T7), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5,T6,T7),R,TX,T1,T2,T3,T4,T5,T6,T7,empty> > (fnPtr, a1);
-  return Callback<R,T1,T2,T3,T4,T5,T6,T7> (impl);
+  return Callback<R,T1,T2,T3,T4,T5,T6,T7> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5,T6,T7),R,TX,T1,T2,T3,T4,T5,T6,T7,empty> (fnPtr, a1), true, true, true);
 }
 template <typename R, typename TX, typename ARG,
           typename T1, typename T2,typename T3,typename T4,typename T5, typename T6, typename T7, typename T8>
 Callback<R,T1,T2,T3,T4,T5,T6,T7,T8> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3,T4,T5,T6,T7,T8), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5,T6,T7,T8),R,TX,T1,T2,T3,T4,T5,T6,T7,T8> > (fnPtr, a1);
-  return Callback<R,T1,T2,T3,T4,T5,T6,T7,T8> (impl);
+  return Callback<R,T1,T2,T3,T4,T5,T6,T7,T8> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5,T6,T7,T8),R,TX,T1,T2,T3,T4,T5,T6,T7,T8> (fnPtr, a1), true, true, true);
 }
 /**@}*/
 
@@ -1748,58 +1913,42 @@ Callback<R,T1,T2,T3,T4,T5,T6,T7,T8> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3,T4
  */
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2>
 Callback<R> MakeBoundCallback (R (*fnPtr)(TX1,TX2), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,empty,empty,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2),R,TX1,TX2,empty,empty,empty,empty,empty,empty,empty> >(fnPtr, a1, a2);
-  return Callback<R> (impl);
+  return Callback<R> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2),R,TX1,TX2,empty,empty,empty,empty,empty,empty,empty> (fnPtr, a1, a2), true, true, true);
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1>
 Callback<R,T1> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,empty,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1),R,TX1,TX2,T1,empty,empty,empty,empty,empty,empty> > (fnPtr, a1, a2);
-  return Callback<R,T1> (impl);
+  return Callback<R,T1> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1),R,TX1,TX2,T1,empty,empty,empty,empty,empty,empty> (fnPtr, a1, a2), true, true, true);
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1, typename T2>
 Callback<R,T1,T2> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,T2,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2),R,TX1,TX2,T1,T2,empty,empty,empty,empty,empty> > (fnPtr, a1, a2);
-  return Callback<R,T1,T2> (impl);
+  return Callback<R,T1,T2> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2),R,TX1,TX2,T1,T2,empty,empty,empty,empty,empty> (fnPtr, a1, a2), true, true, true);
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1, typename T2,typename T3>
 Callback<R,T1,T2,T3> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2,T3), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,T2,T3,empty,empty,empty,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3),R,TX1,TX2,T1,T2,T3,empty,empty,empty,empty> > (fnPtr, a1, a2);
-  return Callback<R,T1,T2,T3> (impl);
+  return Callback<R,T1,T2,T3> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3),R,TX1,TX2,T1,T2,T3,empty,empty,empty,empty> (fnPtr, a1, a2), true, true, true);
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1, typename T2,typename T3,typename T4>
 Callback<R,T1,T2,T3,T4> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2,T3,T4), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,empty,empty,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4),R,TX1,TX2,T1,T2,T3,T4,empty,empty,empty> > (fnPtr, a1, a2);
-  return Callback<R,T1,T2,T3,T4> (impl);
+  return Callback<R,T1,T2,T3,T4> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4),R,TX1,TX2,T1,T2,T3,T4,empty,empty,empty> (fnPtr, a1, a2), true, true, true);
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1, typename T2,typename T3,typename T4,typename T5>
 Callback<R,T1,T2,T3,T4,T5> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2,T3,T4,T5), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,empty,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4,T5),R,TX1,TX2,T1,T2,T3,T4,T5,empty,empty> > (fnPtr, a1, a2);
-  return Callback<R,T1,T2,T3,T4,T5> (impl);
+  return Callback<R,T1,T2,T3,T4,T5> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4,T5),R,TX1,TX2,T1,T2,T3,T4,T5,empty,empty> (fnPtr, a1, a2), true, true, true);
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1, typename T2,typename T3,typename T4,typename T5, typename T6>
 Callback<R,T1,T2,T3,T4,T5,T6> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2,T3,T4,T5,T6), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,T6,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4,T5,T6),R,TX1,TX2,T1,T2,T3,T4,T5,T6,empty> > (fnPtr, a1, a2);
-  return Callback<R,T1,T2,T3,T4,T5,T6> (impl);
+  return Callback<R,T1,T2,T3,T4,T5,T6> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4,T5,T6),R,TX1,TX2,T1,T2,T3,T4,T5,T6,empty> (fnPtr, a1, a2), true, true, true);
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1, typename T2,typename T3,typename T4,typename T5, typename T6, typename T7>
 Callback<R,T1,T2,T3,T4,T5,T6,T7> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2,T3,T4,T5,T6,T7), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4,T5,T6,T7),R,TX1,TX2,T1,T2,T3,T4,T5,T6,T7> > (fnPtr, a1, a2);
-  return Callback<R,T1,T2,T3,T4,T5,T6,T7> (impl);
+  return Callback<R,T1,T2,T3,T4,T5,T6,T7> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4,T5,T6,T7),R,TX1,TX2,T1,T2,T3,T4,T5,T6,T7> (fnPtr, a1, a2), true, true, true);
 }
 /**@}*/
 
@@ -1815,51 +1964,37 @@ Callback<R,T1,T2,T3,T4,T5,T6,T7> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2,T3,
  */
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3>
 Callback<R> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,empty,empty,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3),R,TX1,TX2,TX3,empty,empty,empty,empty,empty,empty> >(fnPtr, a1, a2, a3);
-  return Callback<R> (impl);
+  return Callback<R> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3),R,TX1,TX2,TX3,empty,empty,empty,empty,empty,empty> (fnPtr, a1, a2, a3), true, true, true);
 }
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3,
           typename T1>
 Callback<R,T1> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3,T1), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,T1,empty,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1),R,TX1,TX2,TX3,T1,empty,empty,empty,empty,empty> > (fnPtr, a1, a2, a3);
-  return Callback<R,T1> (impl);
+  return Callback<R,T1> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1),R,TX1,TX2,TX3,T1,empty,empty,empty,empty,empty> (fnPtr, a1, a2, a3), true, true, true);
 }
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3,
           typename T1, typename T2>
 Callback<R,T1,T2> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3,T1,T2), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,T1,T2,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2),R,TX1,TX2,TX3,T1,T2,empty,empty,empty,empty> > (fnPtr, a1, a2, a3);
-  return Callback<R,T1,T2> (impl);
+  return Callback<R,T1,T2> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2),R,TX1,TX2,TX3,T1,T2,empty,empty,empty,empty> (fnPtr, a1, a2, a3), true, true, true);
 }
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3,
           typename T1, typename T2,typename T3>
 Callback<R,T1,T2,T3> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3,T1,T2,T3), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,T1,T2,T3,empty,empty,empty,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3),R,TX1,TX2,TX3,T1,T2,T3,empty,empty,empty> > (fnPtr, a1, a2, a3);
-  return Callback<R,T1,T2,T3> (impl);
+  return Callback<R,T1,T2,T3> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3),R,TX1,TX2,TX3,T1,T2,T3,empty,empty,empty> (fnPtr, a1, a2, a3), true, true, true);
 }
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3,
           typename T1, typename T2,typename T3,typename T4>
 Callback<R,T1,T2,T3,T4> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3,T1,T2,T3,T4), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,empty,empty,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3,T4),R,TX1,TX2,TX3,T1,T2,T3,T4,empty,empty> > (fnPtr, a1, a2, a3);
-  return Callback<R,T1,T2,T3,T4> (impl);
+  return Callback<R,T1,T2,T3,T4> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3,T4),R,TX1,TX2,TX3,T1,T2,T3,T4,empty,empty> (fnPtr, a1, a2, a3), true, true, true);
 }
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3,
           typename T1, typename T2,typename T3,typename T4,typename T5>
 Callback<R,T1,T2,T3,T4,T5> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3,T1,T2,T3,T4,T5), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,empty,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3,T4,T5),R,TX1,TX2,TX3,T1,T2,T3,T4,T5,empty> > (fnPtr, a1, a2, a3);
-  return Callback<R,T1,T2,T3,T4,T5> (impl);
+  return Callback<R,T1,T2,T3,T4,T5> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3,T4,T5),R,TX1,TX2,TX3,T1,T2,T3,T4,T5,empty> (fnPtr, a1, a2, a3), true, true, true);
 }
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3,
           typename T1, typename T2,typename T3,typename T4,typename T5, typename T6>
 Callback<R,T1,T2,T3,T4,T5,T6> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3,T1,T2,T3,T4,T5,T6), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,T6,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3,T4,T5,T6),R,TX1,TX2,TX3,T1,T2,T3,T4,T5,T6> > (fnPtr, a1, a2, a3);
-  return Callback<R,T1,T2,T3,T4,T5,T6> (impl);
+  return Callback<R,T1,T2,T3,T4,T5,T6> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3,T4,T5,T6),R,TX1,TX2,TX3,T1,T2,T3,T4,T5,T6> (fnPtr, a1, a2, a3), true, true, true);
 }
 /**@}*/
 
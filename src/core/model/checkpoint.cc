@@ -0,0 +1,119 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "checkpoint.h"
+#include "simulator.h"
+#include "simulator-impl.h"
+#include "fatal-error.h"
+#include "abort.h"
+#include "log.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::Checkpoint implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Checkpoint");
+
+const uint32_t Checkpoint::PARENT;
+uint32_t Checkpoint::g_failures = 0;
+
+uint32_t
+Checkpoint::Fork (uint32_t variants, uint32_t parallel)
+{
+  NS_LOG_FUNCTION (variants << parallel);
+  std::string impl = Simulator::GetImplementation ()->GetInstanceTypeId ().GetName ();
+  NS_ABORT_MSG_UNLESS (impl == "ns3::DefaultSimulatorImpl",
+                       "Checkpoint::Fork does not support " << impl);
+  if (parallel == 0)
+    {
+      parallel = variants;
+    }
+
+  // do not print the buffered output once per process
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::clog.flush ();
+  std::fflush (0);
+
+  g_failures = 0;
+  std::map<pid_t, uint32_t> running;
+  uint32_t next = 0;
+  while (next < variants || !running.empty ())
+    {
+      if (next < variants && running.size () < parallel)
+        {
+          pid_t pid = fork ();
+          if (pid < 0)
+            {
+              NS_FATAL_ERROR ("Could not fork variant " << next << ": " << std::strerror (errno));
+            }
+          if (pid == 0)
+            {
+              NS_LOG_LOGIC ("variant " << next << " starts at " << Simulator::Now ());
+              return next;
+            }
+          running[pid] = next;
+          next++;
+          continue;
+        }
+      int status;
+      pid_t pid = waitpid (-1, &status, 0);
+      if (pid < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+          NS_FATAL_ERROR ("Could not wait for the variants: " << std::strerror (errno));
+        }
+      std::map<pid_t, uint32_t>::iterator i = running.find (pid);
+      if (i == running.end ())
+        {
+          // not one of the variants
+          continue;
+        }
+      if (!WIFEXITED (status) || WEXITSTATUS (status) != 0)
+        {
+          NS_LOG_WARN ("variant " << i->second << " failed with status " << status);
+          g_failures++;
+        }
+      running.erase (i);
+    }
+  Simulator::Stop ();
+  return PARENT;
+}
+
+uint32_t
+Checkpoint::GetFailures (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return g_failures;
+}
+
+} // namespace ns3
@@ -0,0 +1,104 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::Checkpoint declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ * \brief Continue a warmed-up simulation in several variants.
+ *
+ * Fork checkpoints the whole state of the simulation, which is the state
+ * of the process: the pending events of the scheduler, the objects and
+ * their attributes, the packets and the states of the random number
+ * generators. Each variant continues the simulation from this state in
+ * a copy of the process created with \c fork(). For example:
+ *
+ * \code
+ *   static uint32_t g_variant;
+ *
+ *   static void
+ *   StartVariants (void)
+ *   {
+ *     g_variant = Checkpoint::Fork (4);
+ *     if (g_variant != Checkpoint::PARENT)
+ *       {
+ *         RandomVariableStream::AdvanceAllSubstreams (g_variant);
+ *         Config::Set ("/NodeList/0/...", ...);   // configure the variant
+ *       }
+ *   }
+ *
+ *   Simulator::Schedule (Seconds (30), &StartVariants);
+ *   Simulator::Run ();
+ *   if (g_variant != Checkpoint::PARENT)
+ *     {
+ *       // print the results of the variant
+ *     }
+ *   Simulator::Destroy ();
+ * \endcode
+ *
+ * The variants share the files opened before the fork: they should open
+ * their own output files, e.g., the pcap traces, once forked.
+ *
+ * This works only with the DefaultSimulatorImpl, in a process with a
+ * single thread.
+ */
+class Checkpoint
+{
+public:
+  /** The value returned by Fork in the parent process. */
+  static const uint32_t PARENT = 0xffffffff;
+
+  /**
+   * Fork the simulation into \p variants processes, and wait for them.
+   *
+   * This is meant to be called from an event. In the parent process,
+   * the simulation stops at the end of this event.
+   *
+   * \param [in] variants The number of variants.
+   * \param [in] parallel The maximum number of variants running at
+   *             once, or 0 to run them all at once.
+   * \returns The index of the variant, from 0 to \p variants - 1, in
+   *          the forked processes, or PARENT in the parent process,
+   *          once all the variants have exited.
+   */
+  static uint32_t Fork (uint32_t variants, uint32_t parallel = 0);
+  /**
+   * Get the number of variants of the last Fork which did not exit
+   * normally with a status of 0.
+   *
+   * \returns The number of failed variants.
+   */
+  static uint32_t GetFailures (void);
+
+private:
+  /** The number of failed variants of the last Fork. */
+  static uint32_t g_failures;
+};
+
+} // namespace ns3
+
+#endif /* CHECKPOINT_H */
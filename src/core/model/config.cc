@@ -25,7 +25,10 @@
 #include "names.h"
 #include "pointer.h"
 #include "log.h"
+#include "simulator.h"
 
+#include <algorithm>
+#include <map>
 #include <sstream>
 
 /**
@@ -166,7 +169,27 @@ public:
    * \returns \c true if the index matches the Config Path.
    */
   bool Matches (uint32_t i) const;
+  /**
+   * Get the matching indices of an array, if there are fewer of them
+   * than entries in the array.
+   *
+   * The indices of an ObjectMapValue are its keys, which may be larger
+   * than the number of entries: the entries are then tested one by one
+   * whenever an index at least \p n may match.
+   *
+   * \param [in] n The number of entries in the array.
+   * \param [out] indices The matching indices, all below \p n, in increasing order.
+   * \returns \c false if the entries of the array should rather be
+   *          tested one by one with Matches.
+   */
+  bool GetIndices (uint32_t n, std::vector<uint32_t> *indices) const;
 private:
+  /**
+   * Parse a Config path specification into ranges of indices.
+   *
+   * \param [in] element The Config path specification, or a part of it.
+   */
+  void Compile (std::string element);
   /**
    * Convert a string to an \c uint32_t.
    *
@@ -177,76 +200,113 @@ private:
   bool StringToUint32 (std::string str, uint32_t *value) const;
   /** The Config path element. */
   std::string m_element;
+  /** Whether every index matches. */
+  bool m_all;
+  /** The matching indices, as inclusive [min, max] ranges. */
+  std::vector<std::pair<uint32_t, uint32_t> > m_ranges;
 };
 
 
 ArrayMatcher::ArrayMatcher (std::string element)
-  : m_element (element)
+  : m_element (element),
+    m_all (false)
 {
   NS_LOG_FUNCTION (this << element);
+  Compile (element);
 }
-bool
-ArrayMatcher::Matches (uint32_t i) const
+void
+ArrayMatcher::Compile (std::string element)
 {
-  NS_LOG_FUNCTION (this << i);
-  if (m_element == "*")
+  NS_LOG_FUNCTION (this << element);
+  if (element == "*")
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches *");
-      return true;
+      m_all = true;
+      return;
     }
   std::string::size_type tmp;
-  tmp = m_element.find ("|");
+  tmp = element.find ("|");
   if (tmp != std::string::npos)
     {
-      std::string left = m_element.substr (0, tmp-0);
-      std::string right = m_element.substr (tmp+1, m_element.size () - (tmp + 1));
-      ArrayMatcher matcher = ArrayMatcher (left);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<left);
-          return true;
-        }
-      matcher = ArrayMatcher (right);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<right);
-          return true;
-        }
-      NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
-      return false;
+      Compile (element.substr (0, tmp-0));
+      Compile (element.substr (tmp+1, element.size () - (tmp + 1)));
+      return;
     }
-  std::string::size_type leftBracket = m_element.find ("[");
-  std::string::size_type rightBracket = m_element.find ("]");
-  std::string::size_type dash = m_element.find ("-");
-  if (leftBracket == 0 && rightBracket == m_element.size () - 1 &&
+  std::string::size_type leftBracket = element.find ("[");
+  std::string::size_type rightBracket = element.find ("]");
+  std::string::size_type dash = element.find ("-");
+  if (leftBracket == 0 && rightBracket == element.size () - 1 &&
       dash > leftBracket && dash < rightBracket)
     {
-      std::string lowerBound = m_element.substr (leftBracket + 1, dash - (leftBracket + 1));
-      std::string upperBound = m_element.substr (dash + 1, rightBracket - (dash + 1));
+      std::string lowerBound = element.substr (leftBracket + 1, dash - (leftBracket + 1));
+      std::string upperBound = element.substr (dash + 1, rightBracket - (dash + 1));
       uint32_t min;
       uint32_t max;
       if (StringToUint32 (lowerBound, &min) && 
           StringToUint32 (upperBound, &max) &&
-          i >= min && i <= max)
+          min <= max)
+        {
+          m_ranges.push_back (std::make_pair (min, max));
+        }
+      return;
+    }
+  uint32_t value;
+  if (StringToUint32 (element, &value))
+    {
+      m_ranges.push_back (std::make_pair (value, value));
+    }
+}
+bool
+ArrayMatcher::Matches (uint32_t i) const
+{
+  NS_LOG_FUNCTION (this << i);
+  if (m_all)
+    {
+      NS_LOG_DEBUG ("Array "<<i<<" matches *");
+      return true;
+    }
+  for (uint32_t j = 0; j < m_ranges.size (); j++)
+    {
+      if (i >= m_ranges[j].first && i <= m_ranges[j].second)
         {
           NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
           return true;
         }
-      else
+    }
+  NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
+  return false;
+}
+bool
+ArrayMatcher::GetIndices (uint32_t n, std::vector<uint32_t> *indices) const
+{
+  NS_LOG_FUNCTION (this << n << indices);
+  if (m_all)
+    {
+      return false;
+    }
+  uint64_t count = 0;
+  for (uint32_t j = 0; j < m_ranges.size (); j++)
+    {
+      if (m_ranges[j].second >= n)
         {
-          NS_LOG_DEBUG ("Array "<<i<<" does not "<<m_element);
           return false;
         }
+      count += m_ranges[j].second - m_ranges[j].first + 1;
     }
-  uint32_t value;
-  if (StringToUint32 (m_element, &value) &&
-      i == value)
+  if (count >= n)
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
-      return true;
+      return false;
     }
-  NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
-  return false;
+  indices->clear ();
+  for (uint32_t j = 0; j < m_ranges.size (); j++)
+    {
+      for (uint32_t i = m_ranges[j].first; i <= m_ranges[j].second; i++)
+        {
+          indices->push_back (i);
+        }
+    }
+  std::sort (indices->begin (), indices->end ());
+  indices->erase (std::unique (indices->begin (), indices->end ()), indices->end ());
+  return true;
 }
 
 bool
@@ -261,6 +321,12 @@ ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
 
 /**
  * Abstract class to parse Config paths into object references.
+ *
+ * The Config path is split once into its elements, and the attributes
+ * of the objects which may be followed by an element are looked up once
+ * per TypeId, so that the cost of resolving a path depends on the number
+ * of objects it goes through rather than on the length of the strings
+ * and the number of attributes.
  */
 class Resolver
 {
@@ -284,23 +350,77 @@ public:
   void Resolve (Ptr<Object> root);
   
 private:
+  /** An element of the Config path, between two '/'. */
+  struct Element
+  {
+    /**
+     * Constructor.
+     *
+     * \param [in] item The element of the Config path.
+     */
+    Element (std::string item);
+    std::string item;       //!< The element of the Config path
+    ArrayMatcher matcher;   //!< The element, used as an array index
+    bool hasTid;            //!< Whether the element is $ followed by a valid TypeId name
+    TypeId tid;             //!< The TypeId named by a $ element
+  };
+  /** An attribute through which a path can be followed. */
+  struct Attribute
+  {
+    std::string name;                                 //!< The attribute name
+    bool isPointer;                                   //!< Whether it holds a PointerValue
+    bool isContainer;                                 //!< Whether it holds an ObjectPtrContainerValue
+    Ptr<const AttributeAccessor> accessor;            //!< The accessor, null if not gettable
+  };
+  /** The attributes matching an element. */
+  typedef std::vector<Attribute> Attributes;
+  /** The attributes matching an element, by TypeId uid and element. */
+  typedef std::map<std::pair<uint16_t, std::string>, Attributes> AttributeIndex;
+
   /** Ensure the Config path starts and ends with a '/'. */
   void Canonicalize (void);
+  /** Split the Config path into its elements. */
+  void Compile (void);
+  /**
+   * Get the attributes of an object matching an element of the path.
+   *
+   * \param [in] tid The TypeId of the object.
+   * \param [in] item The element of the Config path.
+   * \returns The attributes holding objects named by \p item, or all of
+   *          them if \p item is "*".
+   */
+  static const Attributes & GetAttributes (TypeId tid, const std::string &item);
   /**
    * Parse the next element in the Config path.
    *
-   * \param [in] path The remaining portion of the Config path.
+   * \param [in] element The index of the next element of the Config path.
    * \param [in] root The object corresponding to the current positon
    *                  in the Config path.
    */
-  void DoResolve (std::string path, Ptr<Object> root);
+  void DoResolve (uint32_t element, Ptr<Object> root);
   /**
    * Parse an index on the Config path.
    *
-   * \param [in] path The remaining Config path.
+   * \param [in] element The index of the next element of the Config path.
+   * \param [in] root The object holding the container.
+   * \param [in] attribute The container attribute.
+   */
+  void DoArrayResolve (uint32_t element, Ptr<Object> root, const Attribute &attribute);
+  /**
+   * Parse an index on the Config path.
+   *
+   * \param [in] element The index of the next element of the Config path.
    * \param [in,out] vector The resulting list of matching objects.
    */
-  void DoArrayResolve (std::string path, const ObjectPtrContainerValue &vector);
+  void DoArrayResolve (uint32_t element, const ObjectPtrContainerValue &vector);
+  /**
+   * Follow an array entry on the Config path.
+   *
+   * \param [in] element The index of the next element of the Config path.
+   * \param [in] index The index of the entry.
+   * \param [in] object The entry.
+   */
+  void DoArrayResolveOne (uint32_t element, uint32_t index, Ptr<Object> object);
   /**
    * Handle one object found on the path.
    *
@@ -321,17 +441,32 @@ private:
    */
   virtual void DoOne (Ptr<Object> object, std::string path) = 0;
 
-  /** Current list of path tokens. */
-  std::vector<std::string> m_workStack;
+  /** The elements of the Config path. */
+  std::vector<Element> m_elements;
+  /** The part of the Config path resolved so far. */
+  std::string m_resolvedPath;
   /** The Config path. */
   std::string m_path;
 };
 
+Resolver::Element::Element (std::string item)
+  : item (item),
+    matcher (item),
+    hasTid (false)
+{
+  if (item.find ("$") == 0)
+    {
+      hasTid = TypeId::LookupByNameFailSafe (item.substr (1, item.size () - 1), &tid);
+    }
+}
+
 Resolver::Resolver (std::string path)
-  : m_path (path)
+  : m_resolvedPath ("/"),
+    m_path (path)
 {
   NS_LOG_FUNCTION (this << path);
   Canonicalize ();
+  Compile ();
 }
 Resolver::~Resolver ()
 {
@@ -356,26 +491,82 @@ Resolver::Canonicalize (void)
       m_path = m_path + "/";
     }
 }
+void
+Resolver::Compile (void)
+{
+  NS_LOG_FUNCTION (this);
+  std::string::size_type start = 1;
+  std::string::size_type next = m_path.find ("/", start);
+  while (next != std::string::npos)
+    {
+      m_elements.push_back (Element (m_path.substr (start, next - start)));
+      start = next + 1;
+      next = m_path.find ("/", start);
+    }
+}
+
+const Resolver::Attributes &
+Resolver::GetAttributes (TypeId tid, const std::string &item)
+{
+  NS_LOG_FUNCTION (tid << item);
+  static AttributeIndex index;
+  std::pair<uint16_t, std::string> key = std::make_pair (tid.GetUid (), item);
+  AttributeIndex::iterator it = index.find (key);
+  if (it != index.end ())
+    {
+      return it->second;
+    }
+  Attributes &attributes = index[key];
+  TypeId instanceTid = tid;
+  TypeId nextTid = tid;
+  do
+    {
+      tid = nextTid;
+      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
+        {
+          struct TypeId::AttributeInformation info;
+          info = tid.GetAttribute (i);
+          if (info.name != item && item != "*")
+            {
+              continue;
+            }
+          Attribute attribute;
+          attribute.name = info.name;
+          attribute.isPointer = dynamic_cast<const PointerChecker *> (PeekPointer (info.checker)) != 0;
+          attribute.isContainer = dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker)) != 0;
+          if (!attribute.isPointer && !attribute.isContainer)
+            {
+              // this could be anything else and we don't know what to do with it.
+              // So, we just ignore it.
+              continue;
+            }
+          // the object attribute of that name is the one of the most
+          // derived class, as in ObjectBase::GetAttribute
+          instanceTid.LookupAttributeByName (info.name, &info);
+          if ((info.flags & TypeId::ATTR_GET) && info.accessor->HasGetter ())
+            {
+              attribute.accessor = info.accessor;
+            }
+          attributes.push_back (attribute);
+        }
+      nextTid = tid.GetParent ();
+    } while (nextTid != tid);
+  return attributes;
+}
 
 void 
 Resolver::Resolve (Ptr<Object> root)
 {
   NS_LOG_FUNCTION (this << root);
 
-  DoResolve (m_path, root);
+  DoResolve (0, root);
 }
 
 std::string
 Resolver::GetResolvedPath (void) const
 {
   NS_LOG_FUNCTION (this);
-
-  std::string fullPath = "/";
-  for (std::vector<std::string>::const_iterator i = m_workStack.begin (); i != m_workStack.end (); i++)
-    {
-      fullPath += *i + "/";
-    }
-  return fullPath;
+  return m_resolvedPath;
 }
 
 void 
@@ -388,13 +579,11 @@ Resolver::DoResolveOne (Ptr<Object> object)
 }
 
 void
-Resolver::DoResolve (std::string path, Ptr<Object> root)
+Resolver::DoResolve (uint32_t element, Ptr<Object> root)
 {
-  NS_LOG_FUNCTION (this << path << root);
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
+  NS_LOG_FUNCTION (this << element << root);
 
-  if (next == std::string::npos)
+  if (element == m_elements.size ())
     {
       //
       // If root is zero, we're beginning to see if we can use the object name 
@@ -410,8 +599,8 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
         }
       return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
+  const std::string &item = m_elements[element].item;
+  std::string::size_type resolvedSize = m_resolvedPath.size ();
 
   //
   // If root is zero, we're beginning to see if we can use the object name 
@@ -422,12 +611,11 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   //
   if (root == 0)
     {
-      std::string::size_type offset = path.find ("/Names");
-      if (offset == 0)
+      if (item.compare (0, 5, "Names") == 0)
         {
-          m_workStack.push_back (item);
-          DoResolve (pathLeft, root);
-          m_workStack.pop_back ();
+          m_resolvedPath += item + "/";
+          DoResolve (element + 1, root);
+          m_resolvedPath.resize (resolvedSize);
           return;
         }
     }
@@ -442,9 +630,9 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   if (namedObject)
     {
       NS_LOG_DEBUG ("Name system resolved item = " << item << " to " << namedObject);
-      m_workStack.push_back (item);
-      DoResolve (pathLeft, namedObject);
-      m_workStack.pop_back ();
+      m_resolvedPath += item + "/";
+      DoResolve (element + 1, namedObject);
+      m_resolvedPath.resize (resolvedSize);
       return;
     }
 
@@ -465,77 +653,55 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
       // This is a call to GetObject
       std::string tidString = item.substr (1, item.size () - 1);
       NS_LOG_DEBUG ("GetObject="<<tidString<<" on path="<<GetResolvedPath ());
-      TypeId tid = TypeId::LookupByName (tidString);
+      TypeId tid = m_elements[element].hasTid ? m_elements[element].tid : TypeId::LookupByName (tidString);
       Ptr<Object> object = root->GetObject<Object> (tid);
       if (object == 0)
         {
           NS_LOG_DEBUG ("GetObject ("<<tidString<<") failed on path="<<GetResolvedPath ());
           return;
         }
-      m_workStack.push_back (item);
-      DoResolve (pathLeft, object);
-      m_workStack.pop_back ();
+      m_resolvedPath += item + "/";
+      DoResolve (element + 1, object);
+      m_resolvedPath.resize (resolvedSize);
     }
   else 
     {
       // this is a normal attribute.
-      TypeId tid;
-      TypeId nextTid = root->GetInstanceTypeId ();
-      bool foundMatch = false;
-      
-      do
+      const Attributes &attributes = GetAttributes (root->GetInstanceTypeId (), item);
+      for (uint32_t i = 0; i < attributes.size (); i++)
         {
-          tid = nextTid;
-          
-          for (uint32_t i = 0; i < tid.GetAttributeN(); i++)
+          const Attribute &attribute = attributes[i];
+          if (attribute.isPointer)
             {
-              struct TypeId::AttributeInformation info;
-              info = tid.GetAttribute(i);
-              if (info.name != item && item != "*")
+              NS_LOG_DEBUG ("GetAttribute(ptr)="<<attribute.name<<" on path="<<GetResolvedPath ());
+              PointerValue ptr;
+              if (attribute.accessor == 0 || !attribute.accessor->Get (PeekPointer (root), ptr))
                 {
-                  continue;
-                }
-              // attempt to cast to a pointer checker.
-              const PointerChecker *ptr = dynamic_cast<const PointerChecker *> (PeekPointer (info.checker));
-              if (ptr != 0)
-                {
-                  NS_LOG_DEBUG ("GetAttribute(ptr)="<<info.name<<" on path="<<GetResolvedPath ());
-                  PointerValue ptr;
-                  root->GetAttribute (info.name, ptr);
-                  Ptr<Object> object = ptr.Get<Object> ();
-                  if (object == 0)
-                    {
-                      NS_LOG_ERROR ("Requested object name=\""<<item<<
-                                    "\" exists on path=\""<<GetResolvedPath ()<<"\""
-                                    " but is null.");
-                      continue;
-                    }
-                  foundMatch = true;
-                  m_workStack.push_back (info.name);
-                  DoResolve (pathLeft, object);
-                  m_workStack.pop_back ();
+                  // let ObjectBase report the error
+                  root->GetAttribute (attribute.name, ptr);
                 }
-              // attempt to cast to an object vector.
-              const ObjectPtrContainerChecker *vectorChecker = 
-                dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker));
-              if (vectorChecker != 0)
+              Ptr<Object> object = ptr.Get<Object> ();
+              if (object == 0)
                 {
-                  NS_LOG_DEBUG ("GetAttribute(vector)="<<info.name<<" on path="<<GetResolvedPath () << pathLeft);
-                  foundMatch = true;
-                  ObjectPtrContainerValue vector;
-                  root->GetAttribute (info.name, vector);
-                  m_workStack.push_back (info.name);
-                  DoArrayResolve (pathLeft, vector);
-                  m_workStack.pop_back ();
+                  NS_LOG_ERROR ("Requested object name=\""<<item<<
+                                "\" exists on path=\""<<GetResolvedPath ()<<"\""
+                                " but is null.");
+                  continue;
                 }
-              // this could be anything else and we don't know what to do with it.
-              // So, we just ignore it.
+              m_resolvedPath += attribute.name + "/";
+              DoResolve (element + 1, object);
+              m_resolvedPath.resize (resolvedSize);
             }
-
-          nextTid = tid.GetParent ();
-        } while (nextTid != tid);
+          if (attribute.isContainer)
+            {
+              NS_LOG_DEBUG ("GetAttribute(vector)="<<attribute.name<<" on path="<<GetResolvedPath ());
+              m_resolvedPath += attribute.name + "/";
+              DoArrayResolve (element + 1, root, attribute);
+              m_resolvedPath.resize (resolvedSize);
+            }
+        }
       
-      if (!foundMatch)
+      if (attributes.empty ())
         {
           NS_LOG_DEBUG ("Requested item="<<item<<" does not exist on path="<<GetResolvedPath ());
           return;
@@ -543,39 +709,96 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     }
 }
 
-void 
-Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &container)
+void
+Resolver::DoArrayResolve (uint32_t element, Ptr<Object> root, const Attribute &attribute)
 {
-  NS_LOG_FUNCTION(this << path << &container);
-  NS_ASSERT (path != "");
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
-  if (next == std::string::npos)
+  NS_LOG_FUNCTION (this << element << root << attribute.name);
+  if (element == m_elements.size ())
+    {
+      return;
+    }
+
+  // walk the container through its accessor: unlike an
+  // ObjectPtrContainerValue, this does not copy every entry when only
+  // a few of them match
+  const ObjectPtrContainerAccessor *accessor =
+    dynamic_cast<const ObjectPtrContainerAccessor *> (PeekPointer (attribute.accessor));
+  uint32_t n;
+  if (accessor == 0 || !accessor->GetItemN (PeekPointer (root), &n))
     {
+      ObjectPtrContainerValue vector;
+      root->GetAttribute (attribute.name, vector);
+      DoArrayResolve (element, vector);
       return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
+  const ArrayMatcher &matcher = m_elements[element].matcher;
+  std::vector<uint32_t> indices;
+  bool candidates = matcher.GetIndices (n, &indices);
+  uint32_t nCandidates = candidates ? indices.size () : n;
+  std::vector<std::pair<uint32_t, Ptr<Object> > > matches;
+  for (uint32_t j = 0; j < nCandidates; j++)
+    {
+      uint32_t i = candidates ? indices[j] : j;
+      uint32_t index;
+      Ptr<Object> object = accessor->GetItem (PeekPointer (root), i, &index);
+      if (index != i)
+        {
+          // the entries are not stored at their index, like the keys of an
+          // ObjectMapValue: sort them by index
+          ObjectPtrContainerValue vector;
+          root->GetAttribute (attribute.name, vector);
+          DoArrayResolve (element, vector);
+          return;
+        }
+      if (candidates || matcher.Matches (index))
+        {
+          matches.push_back (std::make_pair (index, object));
+        }
+    }
+  for (uint32_t j = 0; j < matches.size (); j++)
+    {
+      DoArrayResolveOne (element, matches[j].first, matches[j].second);
+    }
+}
 
-  ArrayMatcher matcher = ArrayMatcher (item);
+void 
+Resolver::DoArrayResolve (uint32_t element, const ObjectPtrContainerValue &container)
+{
+  NS_LOG_FUNCTION(this << element << &container);
+  if (element == m_elements.size ())
+    {
+      return;
+    }
+  const ArrayMatcher &matcher = m_elements[element].matcher;
   ObjectPtrContainerValue::Iterator it;
   for (it = container.Begin (); it != container.End (); ++it)
     {
       if (matcher.Matches ((*it).first))
         {
-          std::ostringstream oss;
-          oss << (*it).first;
-          m_workStack.push_back (oss.str ());
-          DoResolve (pathLeft, (*it).second);
-          m_workStack.pop_back ();
+          DoArrayResolveOne (element, (*it).first, (*it).second);
         }
     }
 }
 
+void
+Resolver::DoArrayResolveOne (uint32_t element, uint32_t index, Ptr<Object> object)
+{
+  NS_LOG_FUNCTION (this << element << index << object);
+  std::string::size_type resolvedSize = m_resolvedPath.size ();
+  std::ostringstream oss;
+  oss << index << "/";
+  m_resolvedPath += oss.str ();
+  DoResolve (element + 1, object);
+  m_resolvedPath.resize (resolvedSize);
+}
+
 /** Config system implementation class. */
 class ConfigImpl : public Singleton<ConfigImpl>
 {
 public:
+  /** Constructor. */
+  ConfigImpl ();
+
   /** \copydoc Config::Set() */
   void Set (std::string path, const AttributeValue &value);
   /** \copydoc Config::ConnectWithoutContext() */
@@ -599,6 +822,11 @@ public:
   /** \copydoc Config::GetRootNamespaceObject() */
   Ptr<Object> GetRootNamespaceObject (uint32_t i) const;
 
+  /** \copydoc Config::EnableMatchCache() */
+  void EnableMatchCache (void);
+  /** \copydoc Config::DisableMatchCache() */
+  void DisableMatchCache (void);
+
 private:
   /**
    * Break a Config path into the leading path and the last leaf token.
@@ -614,8 +842,22 @@ private:
 
   /** The list of Config path roots. */
   Roots m_roots;
+
+  /** Container type to hold the cached matches, by Config path. */
+  typedef std::map<std::string, Config::MatchContainer> Matches;
+
+  /** Whether LookupMatches reuses the previous matches of a path. */
+  bool m_matchCacheEnabled;
+  /** The matches of the paths looked up while the cache is enabled. */
+  Matches m_matches;
 };
 
+ConfigImpl::ConfigImpl ()
+  : m_matchCacheEnabled (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
 void 
 ConfigImpl::ParsePath (std::string path, std::string *root, std::string *leaf) const
 {
@@ -637,6 +879,11 @@ ConfigImpl::Set (std::string path, const AttributeValue &value)
   ParsePath (path, &root, &leaf);
   Config::MatchContainer container = LookupMatches (root);
   container.Set (leaf, value);
+  if (m_matchCacheEnabled && dynamic_cast<const PointerValue *> (&value) != 0)
+    {
+      // the object graph may have changed
+      m_matches.clear ();
+    }
 }
 void 
 ConfigImpl::ConnectWithoutContext (std::string path, const CallbackBase &cb)
@@ -681,6 +928,15 @@ Config::MatchContainer
 ConfigImpl::LookupMatches (std::string path)
 {
   NS_LOG_FUNCTION (this << path);
+  if (m_matchCacheEnabled)
+    {
+      Matches::const_iterator it = m_matches.find (path);
+      if (it != m_matches.end ())
+        {
+          NS_LOG_DEBUG ("cached matches for path=" << path);
+          return it->second;
+        }
+    }
   class LookupMatchesResolver : public Resolver 
   {
   public:
@@ -706,7 +962,12 @@ ConfigImpl::LookupMatches (std::string path)
   //
   resolver.Resolve (0);
 
-  return Config::MatchContainer (resolver.m_objects, resolver.m_contexts, path);
+  Config::MatchContainer matches (resolver.m_objects, resolver.m_contexts, path);
+  if (m_matchCacheEnabled)
+    {
+      m_matches[path] = matches;
+    }
+  return matches;
 }
 
 void 
@@ -714,6 +975,7 @@ ConfigImpl::RegisterRootNamespaceObject (Ptr<Object> obj)
 {
   NS_LOG_FUNCTION (this << obj);
   m_roots.push_back (obj);
+  m_matches.clear ();
 }
 
 void 
@@ -726,6 +988,7 @@ ConfigImpl::UnregisterRootNamespaceObject (Ptr<Object> obj)
       if (*i == obj)
         {
           m_roots.erase (i);
+          m_matches.clear ();
           return;
         }
     }
@@ -744,6 +1007,27 @@ ConfigImpl::GetRootNamespaceObject (uint32_t i) const
   return m_roots[i];
 }
 
+void
+ConfigImpl::EnableMatchCache (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_matchCacheEnabled)
+    {
+      // do not keep the objects alive past the end of the simulation
+      Simulator::ScheduleDestroy (&Config::DisableMatchCache);
+    }
+  m_matchCacheEnabled = true;
+  m_matches.clear ();
+}
+
+void
+ConfigImpl::DisableMatchCache (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_matchCacheEnabled = false;
+  m_matches.clear ();
+}
+
 namespace Config {
 
 void Reset (void)
@@ -873,6 +1157,18 @@ Ptr<Object> GetRootNamespaceObject (uint32_t i)
   return ConfigImpl::Get ()->GetRootNamespaceObject (i);
 }
 
+void EnableMatchCache (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  ConfigImpl::Get ()->EnableMatchCache ();
+}
+
+void DisableMatchCache (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  ConfigImpl::Get ()->DisableMatchCache ();
+}
+
 } // namespace Config
 
 } // namespace ns3
@@ -287,6 +287,27 @@ uint32_t GetRootNamespaceObjectN (void);
  */
 Ptr<Object> GetRootNamespaceObject (uint32_t i);
 
+/**
+ * \ingroup config
+ * Reuse the objects matched by a path in the later lookups of the same
+ * path, by Config::Set, Config::Connect, Config::LookupMatches, etc.
+ * This avoids walking the object graph again when, for example, several
+ * trace sources of the same objects are connected with a wildcard path.
+ *
+ * The cached matches are not updated when the object graph changes,
+ * hence the cache should be enabled once the topology is built. It is
+ * cleared when a root namespace object is registered or unregistered,
+ * when Config::Set sets a PointerValue, when this function is called
+ * again, and it is disabled by Simulator::Destroy.
+ */
+void EnableMatchCache (void);
+/**
+ * \ingroup config
+ * This function undoes the work of Config::EnableMatchCache and clears
+ * the cached matches.
+ */
+void DisableMatchCache (void);
+
 } // namespace Config
 
 } // namespace ns3
@@ -25,10 +25,16 @@
 
 #include "ptr.h"
 #include "pointer.h"
+#include "double.h"
+#include "uinteger.h"
+#include "boolean.h"
+#include "string.h"
 #include "assert.h"
 #include "log.h"
 
 #include <cmath>
+#include <fstream>
+#include <iostream>
 
 
 /**
@@ -53,6 +59,32 @@ DefaultSimulatorImpl::GetTypeId (void)
     .SetParent<SimulatorImpl> ()
     .SetGroupName ("Core")
     .AddConstructor<DefaultSimulatorImpl> ()
+    .AddAttribute ("CompactionThreshold",
+                   "The fraction of the events in the event queue which "
+                   "must be cancelled for the cancelled events to be removed "
+                   "before their timestamp is reached.",
+                   DoubleValue (0.5),
+                   MakeDoubleAccessor (&DefaultSimulatorImpl::m_compactionThreshold),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("CompactionMinimum",
+                   "The smallest number of cancelled events in the event "
+                   "queue which are removed before their timestamp is reached.",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&DefaultSimulatorImpl::m_compactionMinimum),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("EventProfiling",
+                   "Record the number of events and their wall clock time, "
+                   "by event type and by context, and report them at "
+                   "Simulator::Destroy.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&DefaultSimulatorImpl::m_profiling),
+                   MakeBooleanChecker ())
+    .AddAttribute ("EventProfileOutput",
+                   "The file to which the event profile is written. "
+                   "If empty, it is written to the standard error.",
+                   StringValue (""),
+                   MakeStringAccessor (&DefaultSimulatorImpl::m_profileOutput),
+                   MakeStringChecker ())
   ;
   return tid;
 }
@@ -71,7 +103,11 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_currentTs = 0;
   m_currentContext = 0xffffffff;
   m_unscheduledEvents = 0;
-  m_eventsWithContextEmpty = true;
+  m_eventCount = 0;
+  m_cancelledEvents = 0;
+  m_compactedEvents = 0;
+  m_profiler = 0;
+  m_eventsWithContext = 0;
   m_main = SystemThread::Self();
 }
 
@@ -92,12 +128,26 @@ DefaultSimulatorImpl::DoDispose (void)
       next.impl->Unref ();
     }
   m_events = 0;
+  delete m_profiler;
+  m_profiler = 0;
   SimulatorImpl::DoDispose ();
 }
 void
 DefaultSimulatorImpl::Destroy ()
 {
   NS_LOG_FUNCTION (this);
+  if (m_profiler != 0)
+    {
+      if (m_profileOutput.empty ())
+        {
+          m_profiler->Report (std::clog);
+        }
+      else
+        {
+          std::ofstream os (m_profileOutput.c_str ());
+          m_profiler->Report (os);
+        }
+    }
   while (!m_destroyEvents.empty ()) 
     {
       Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
@@ -146,12 +196,47 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
-  next.impl->Invoke ();
+  if (next.impl->IsCancelled ())
+    {
+      m_cancelledEvents--;
+    }
+  else
+    {
+      m_eventCount++;
+      if (m_profiler != 0)
+        {
+          m_profiler->Start ();
+          next.impl->Invoke ();
+          m_profiler->Stop (next.impl, next.key.m_context);
+        }
+      else
+        {
+          next.impl->Invoke ();
+        }
+    }
   next.impl->Unref ();
 
   ProcessEventsWithContext ();
 }
 
+void
+DefaultSimulatorImpl::RemoveCancelled (void)
+{
+  NS_LOG_FUNCTION (this << m_cancelledEvents << m_unscheduledEvents);
+  std::vector<Scheduler::Event> cancelled;
+  cancelled.reserve (m_cancelledEvents);
+  m_events->RemoveCancelled (cancelled);
+  NS_ASSERT (cancelled.size () == m_cancelledEvents);
+  for (std::vector<Scheduler::Event>::const_iterator i = cancelled.begin (); i != cancelled.end (); ++i)
+    {
+      // whenever we remove an event from the event list, we have to unref it.
+      i->impl->Unref ();
+    }
+  m_unscheduledEvents -= cancelled.size ();
+  m_compactedEvents += cancelled.size ();
+  m_cancelledEvents = 0;
+}
+
 bool 
 DefaultSimulatorImpl::IsFinished (void) const
 {
@@ -161,30 +246,36 @@ DefaultSimulatorImpl::IsFinished (void) const
 void
 DefaultSimulatorImpl::ProcessEventsWithContext (void)
 {
-  if (m_eventsWithContextEmpty)
+  if (m_eventsWithContext == 0)
     {
       return;
     }
 
-  // swap queues
-  EventsWithContext eventsWithContext;
-  {
-    CriticalSection cs (m_eventsWithContextMutex);
-    m_eventsWithContext.swap(eventsWithContext);
-    m_eventsWithContextEmpty = true;
-  }
-  while (!eventsWithContext.empty ())
+  // take all the pending events at once
+  EventWithContext *event = __sync_lock_test_and_set (&m_eventsWithContext, (EventWithContext *) 0);
+
+  // restore the order in which the events were pushed
+  EventWithContext *eventsWithContext = 0;
+  while (event != 0)
+    {
+      EventWithContext *next = event->next;
+      event->next = eventsWithContext;
+      eventsWithContext = event;
+      event = next;
+    }
+  while (eventsWithContext != 0)
     {
-       EventWithContext event = eventsWithContext.front ();
-       eventsWithContext.pop_front ();
+       event = eventsWithContext;
+       eventsWithContext = event->next;
        Scheduler::Event ev;
-       ev.impl = event.event;
-       ev.key.m_ts = m_currentTs + event.timestamp;
-       ev.key.m_context = event.context;
+       ev.impl = event->event;
+       ev.key.m_ts = m_currentTs + event->timestamp;
+       ev.key.m_context = event->context;
        ev.key.m_uid = m_uid;
        m_uid++;
        m_unscheduledEvents++;
        m_events->Insert (ev);
+       delete event;
     }
 }
 
@@ -196,6 +287,10 @@ DefaultSimulatorImpl::Run (void)
   m_main = SystemThread::Self();
   ProcessEventsWithContext ();
   m_stop = false;
+  if (m_profiling && m_profiler == 0)
+    {
+      m_profiler = new EventProfiler ();
+    }
 
   while (!m_events->IsEmpty () && !m_stop) 
     {
@@ -264,16 +359,18 @@ DefaultSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
     }
   else
     {
-      EventWithContext ev;
-      ev.context = context;
+      EventWithContext *ev = new EventWithContext;
+      ev->context = context;
       // Current time added in ProcessEventsWithContext()
-      ev.timestamp = delay.GetTimeStep ();
-      ev.event = event;
-      {
-        CriticalSection cs (m_eventsWithContextMutex);
-        m_eventsWithContext.push_back(ev);
-        m_eventsWithContextEmpty = false;
-      }
+      ev->timestamp = delay.GetTimeStep ();
+      ev->event = event;
+      EventWithContext *head;
+      do
+        {
+          head = m_eventsWithContext;
+          ev->next = head;
+        }
+      while (!__sync_bool_compare_and_swap (&m_eventsWithContext, head, ev));
     }
 }
 
@@ -363,6 +460,19 @@ DefaultSimulatorImpl::Cancel (const EventId &id)
   if (!IsExpired (id))
     {
       id.PeekEventImpl ()->Cancel ();
+      if (id.GetUid () == 2)
+        {
+          // destroy events are not in the event queue
+          return;
+        }
+      // the cancelled events stay in the event queue until they are
+      // removed all at once, when they are a large part of it
+      m_cancelledEvents++;
+      if (m_cancelledEvents >= m_compactionMinimum
+          && m_cancelledEvents > m_compactionThreshold * m_unscheduledEvents)
+        {
+          RemoveCancelled ();
+        }
     }
 }
 
@@ -414,4 +524,28 @@ DefaultSimulatorImpl::GetContext (void) const
   return m_currentContext;
 }
 
+uint64_t
+DefaultSimulatorImpl::GetEventCount (void) const
+{
+  return m_eventCount;
+}
+
+uint32_t
+DefaultSimulatorImpl::GetPendingEventCount (void) const
+{
+  return m_unscheduledEvents;
+}
+
+uint32_t
+DefaultSimulatorImpl::GetCancelledEventCount (void) const
+{
+  return m_cancelledEvents;
+}
+
+uint64_t
+DefaultSimulatorImpl::GetCompactedEventCount (void) const
+{
+  return m_compactedEvents;
+}
+
 } // namespace ns3
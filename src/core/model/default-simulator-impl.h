@@ -25,11 +25,12 @@
 #include "scheduler.h"
 #include "event-impl.h"
 #include "system-thread.h"
-#include "ns3/system-mutex.h"
 
 #include "ptr.h"
+#include "event-profiler.h"
 
 #include <list>
+#include <string>
 
 /**
  * \file
@@ -77,12 +78,18 @@ public:
   virtual void SetScheduler (ObjectFactory schedulerFactory);
   virtual uint32_t GetSystemId (void) const; 
   virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
+  virtual uint32_t GetPendingEventCount (void) const;
+  virtual uint32_t GetCancelledEventCount (void) const;
+  virtual uint64_t GetCompactedEventCount (void) const;
 
 private:
   virtual void DoDispose (void);
 
   /** Process the next event. */
   void ProcessOneEvent (void);
+  /** Remove the cancelled events from the event queue. */
+  void RemoveCancelled (void);
   /** Move events from a different context into the main event queue. */
   void ProcessEventsWithContext (void);
  
@@ -94,18 +101,17 @@ private:
     uint64_t timestamp;
     /** The event implementation. */
     EventImpl *event;
+    /** The event pushed before this one. */
+    struct EventWithContext *next;
   };
-  /** Container type for the events from a different context. */
-  typedef std::list<struct EventWithContext> EventsWithContext;
-  /** The container of events from a different context. */
-  EventsWithContext m_eventsWithContext;
   /**
-   * Flag \c true if all events with context have been moved to the
-   * primary event queue.
+   * The events from a different context, most recent first.
+   *
+   * This is a lock-free multiple producer, single consumer list: the
+   * other threads push their events with a compare-and-swap, and the
+   * main thread takes the whole list at once with an atomic exchange.
    */
-  bool m_eventsWithContextEmpty;
-  /** Mutex to control access to the list of events with context. */
-  SystemMutex m_eventsWithContextMutex;
+  struct EventWithContext * volatile m_eventsWithContext;
 
   /** Container type for the events to run at Simulator::Destroy() */
   typedef std::list<EventId> DestroyEvents;
@@ -130,6 +136,24 @@ private:
    */
   int m_unscheduledEvents;
 
+  /** Number of events executed, not counting the cancelled events. */
+  uint64_t m_eventCount;
+  /** Number of cancelled events in the event queue. */
+  uint32_t m_cancelledEvents;
+  /** Number of cancelled events removed before their timestamp. */
+  uint64_t m_compactedEvents;
+  /** Fraction of cancelled events above which they are removed. */
+  double m_compactionThreshold;
+  /** Smallest number of cancelled events which are removed. */
+  uint32_t m_compactionMinimum;
+
+  /** Record the wall clock time of the events. */
+  bool m_profiling;
+  /** The file to which the profile is written, or empty for std::clog. */
+  std::string m_profileOutput;
+  /** The profile of the events, if profiling is enabled. */
+  EventProfiler *m_profiler;
+
   /** Main execution thread. */
   SystemThread::ThreadId m_main;
 };
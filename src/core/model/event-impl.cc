@@ -20,6 +20,11 @@
 
 #include "event-impl.h"
 #include "log.h"
+#include "ns3/core-config.h"
+#include <new>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
 
 /**
  * \file
@@ -31,6 +36,142 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
+namespace {
+
+/** Size of the blocks of the first class, and difference between classes. */
+const std::size_t POOL_GRANULARITY = 16;
+/** Number of size classes: larger events are not pooled. */
+const std::size_t POOL_CLASSES = 16;
+/**
+ * Largest number of blocks kept in each free list. Events scheduled by
+ * other threads are released to the free lists of the main thread, which
+ * must not grow without bound.
+ */
+const uint32_t POOL_MAX_BLOCKS = 65536;
+
+/** A block in a free list. */
+struct FreeBlock
+{
+  FreeBlock *next;  //!< Next block in the free list
+};
+
+/** The free lists of one thread. */
+struct EventPool
+{
+  FreeBlock *free[POOL_CLASSES];     //!< One free list per size class
+  uint32_t nFree[POOL_CLASSES];      //!< Number of blocks in each free list
+  EventImpl::PoolStats stats;        //!< Allocation statistics
+  bool registered;                   //!< Has the thread exit handler been registered
+};
+
+/** The free lists of the calling thread, zero-initialized. */
+__thread EventPool g_eventPool;
+/** Whether the free lists are used. */
+bool g_eventPoolEnabled = true;
+
+#ifdef HAVE_PTHREAD_H
+/** Key used to release the free lists of a thread when it exits. */
+pthread_key_t g_eventPoolKey;
+/** Ensure g_eventPoolKey is created once. */
+pthread_once_t g_eventPoolKeyOnce = PTHREAD_ONCE_INIT;
+
+/**
+ * Release all the blocks of the free lists of an exiting thread.
+ *
+ * \param [in] p The EventPool of the thread.
+ */
+void
+ReleaseEventPool (void *p)
+{
+  EventPool *pool = static_cast<EventPool *> (p);
+  for (std::size_t i = 0; i < POOL_CLASSES; i++)
+    {
+      while (pool->free[i] != 0)
+        {
+          FreeBlock *block = pool->free[i];
+          pool->free[i] = block->next;
+          ::operator delete (block);
+        }
+      pool->nFree[i] = 0;
+    }
+}
+
+/** Create g_eventPoolKey. */
+void
+CreateEventPoolKey (void)
+{
+  pthread_key_create (&g_eventPoolKey, &ReleaseEventPool);
+}
+#endif /* HAVE_PTHREAD_H */
+
+} // anonymous namespace
+
+void *
+EventImpl::operator new (std::size_t size)
+{
+  std::size_t c = (size - 1) / POOL_GRANULARITY;
+  if (c >= POOL_CLASSES)
+    {
+      return ::operator new (size);
+    }
+  EventPool &pool = g_eventPool;
+  FreeBlock *block = pool.free[c];
+  if (block != 0 && g_eventPoolEnabled)
+    {
+      pool.free[c] = block->next;
+      pool.nFree[c]--;
+      pool.stats.hits++;
+      return block;
+    }
+  pool.stats.misses++;
+  // allocate the full block, so that it can be recycled whatever the state
+  // of the free lists when it is released
+  return ::operator new ((c + 1) * POOL_GRANULARITY);
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  if (p == 0)
+    {
+      return;
+    }
+  std::size_t c = (size - 1) / POOL_GRANULARITY;
+  EventPool &pool = g_eventPool;
+  if (c >= POOL_CLASSES || !g_eventPoolEnabled || pool.nFree[c] >= POOL_MAX_BLOCKS)
+    {
+      pool.stats.released++;
+      ::operator delete (p);
+      return;
+    }
+#ifdef HAVE_PTHREAD_H
+  if (!pool.registered)
+    {
+      pthread_once (&g_eventPoolKeyOnce, &CreateEventPoolKey);
+      pthread_setspecific (g_eventPoolKey, &pool);
+      pool.registered = true;
+    }
+#endif /* HAVE_PTHREAD_H */
+  FreeBlock *block = static_cast<FreeBlock *> (p);
+  block->next = pool.free[c];
+  pool.free[c] = block;
+  pool.nFree[c]++;
+  pool.stats.recycled++;
+}
+
+struct EventImpl::PoolStats
+EventImpl::GetPoolStats (void)
+{
+  return g_eventPool.stats;
+}
+
+void
+EventImpl::SetPoolEnabled (bool enabled)
+{
+  NS_LOG_FUNCTION (enabled);
+  g_eventPoolEnabled = enabled;
+}
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
@@ -21,6 +21,7 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
 #include "simple-ref-count.h"
 
 /**
@@ -40,6 +41,10 @@ namespace ns3 {
  * when it reaches the time associated to this event. Most subclasses
  * are usually created by one of the many Simulator::Schedule
  * methods.
+ *
+ * The events are allocated from per-thread free lists of blocks of
+ * a few size classes, instead of going through the system allocator
+ * for each event: this is transparent to the subclasses.
  */
 class EventImpl : public SimpleRefCount<EventImpl>
 {
@@ -66,6 +71,45 @@ public:
    */
   bool IsCancelled (void);
 
+  /** Statistics of the event allocator of one thread. */
+  struct PoolStats
+  {
+    uint64_t hits;      //!< Events allocated from a free list
+    uint64_t misses;    //!< Events allocated from the system allocator
+    uint64_t recycled;  //!< Events released to a free list
+    uint64_t released;  //!< Events released to the system allocator
+  };
+
+  /**
+   * Allocate an event from the free list of the calling thread.
+   *
+   * \param [in] size The size of the event.
+   * \returns The memory of the event.
+   */
+  static void *operator new (std::size_t size);
+  /**
+   * Release an event to the free list of the calling thread.
+   *
+   * \param [in] p The memory of the event.
+   * \param [in] size The size of the event.
+   */
+  static void operator delete (void *p, std::size_t size);
+  /**
+   * Get the statistics of the event allocator of the calling thread.
+   *
+   * \returns The statistics.
+   */
+  static struct PoolStats GetPoolStats (void);
+  /**
+   * Enable or disable the free lists, e.g., to measure their benefit.
+   *
+   * When the free lists are disabled, all the events are allocated from
+   * and released to the system allocator.
+   *
+   * \param [in] enabled \c true to use the free lists.
+   */
+  static void SetPoolEnabled (bool enabled);
+
 protected:
   /**
    * Implementation for Invoke().
@@ -0,0 +1,228 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-profiler.h"
+#include "event-impl.h"
+#include "log.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <cstdlib>
+#include <time.h>
+
+#if (__GNUC__ >= 3)
+#include <cxxabi.h>
+#endif
+
+/**
+ * \file
+ * \ingroup events
+ * ns3::EventProfiler implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EventProfiler");
+
+namespace {
+
+/**
+ * \ingroup events
+ * Sort the lines of the report by decreasing time.
+ *
+ * \tparam T \deduced The identifier of the line.
+ * \param [in] a The first line.
+ * \param [in] b The second line.
+ * \returns \c true if \c a took more time than \c b.
+ */
+template <typename T>
+bool
+MoreTime (const std::pair<uint64_t, T> &a, const std::pair<uint64_t, T> &b)
+{
+  return a.first > b.first;
+}
+
+} // unnamed namespace
+
+EventProfiler::Record::Record ()
+  : count (0),
+    time (0)
+{
+}
+
+EventProfiler::EventProfiler ()
+  : m_start (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint64_t
+EventProfiler::GetTime (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+void
+EventProfiler::Start (void)
+{
+  m_start = GetTime ();
+}
+
+void
+EventProfiler::Stop (const EventImpl *event, uint32_t context)
+{
+  uint64_t time = GetTime () - m_start;
+  Record &type = m_types[&typeid (*event)];
+  type.count++;
+  type.time += time;
+  Record *record = &m_noContext;
+  if (context != 0xffffffff)
+    {
+      if (context >= m_contexts.size ())
+        {
+          m_contexts.resize (context + 1);
+        }
+      record = &m_contexts[context];
+    }
+  record->count++;
+  record->time += time;
+}
+
+std::string
+EventProfiler::GetName (const std::type_info *type)
+{
+  std::string name = type->name ();
+#if (__GNUC__ >= 3)
+  int status;
+  char *demangled = abi::__cxa_demangle (name.c_str (), NULL, NULL, &status);
+  if (status == 0)
+    {
+      name = demangled;
+    }
+  std::free (demangled);
+#endif
+  // the events created by MakeEvent are local classes of
+  // MakeEvent<...> (MEM mem_ptr, OBJ obj, ...) or MakeEvent<...> (void (*f)(...), ...):
+  // keep the types of the arguments, which are the signature of the
+  // bound method or function, followed by the type of the object
+  std::string::size_type i = name.find ("MakeEvent");
+  if (i == std::string::npos)
+    {
+      return name;
+    }
+  i += 9;
+  std::string::size_type start = std::string::npos;
+  int depth = 0;
+  for (; i < name.size (); i++)
+    {
+      char c = name[i];
+      if (depth == 0 && c == '(' && start == std::string::npos)
+        {
+          start = i + 1;
+        }
+      else if (depth == 1 && c == ')' && start != std::string::npos)
+        {
+          return name.substr (start, i - start);
+        }
+      if (c == '<' || c == '(')
+        {
+          depth++;
+        }
+      else if (c == '>' || c == ')')
+        {
+          depth--;
+        }
+    }
+  return name;
+}
+
+void
+EventProfiler::Print (std::ostream &os, const Record &record, uint64_t total, const std::string &name)
+{
+  os << std::setw (12) << record.count
+     << std::setw (12) << std::fixed << std::setprecision (3) << record.time / 1e9
+     << std::setw (12) << std::setprecision (3) << (record.count > 0 ? record.time / 1e3 / record.count : 0)
+     << std::setw (8) << std::setprecision (1) << (total > 0 ? 100.0 * record.time / total : 0)
+     << "  " << name << std::endl;
+}
+
+void
+EventProfiler::Report (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this);
+  std::ios::fmtflags flags = os.flags ();
+  std::streamsize precision = os.precision ();
+
+  // several event classes may have the same name, e.g., when they bind
+  // the same method with different arguments
+  std::map<std::string, Record> names;
+  uint64_t total = 0;
+  uint64_t count = 0;
+  for (Types::const_iterator i = m_types.begin (); i != m_types.end (); ++i)
+    {
+      Record &record = names[GetName (i->first)];
+      record.count += i->second.count;
+      record.time += i->second.time;
+      total += i->second.time;
+      count += i->second.count;
+    }
+  std::vector<std::pair<uint64_t, std::map<std::string, Record>::const_iterator> > types;
+  for (std::map<std::string, Record>::const_iterator i = names.begin (); i != names.end (); ++i)
+    {
+      types.push_back (std::make_pair (i->second.time, i));
+    }
+  std::stable_sort (types.begin (), types.end (), MoreTime<std::map<std::string, Record>::const_iterator>);
+
+  os << "Event profile: " << count << " events, "
+     << std::fixed << std::setprecision (3) << total / 1e9 << " s" << std::endl;
+  os << std::setw (12) << "events" << std::setw (12) << "time (s)"
+     << std::setw (12) << "mean (us)" << std::setw (8) << "%" << "  event type" << std::endl;
+  for (uint32_t i = 0; i < types.size (); i++)
+    {
+      Print (os, types[i].second->second, total, types[i].second->first);
+    }
+
+  std::vector<std::pair<uint64_t, uint32_t> > contexts;
+  for (uint32_t i = 0; i < m_contexts.size (); i++)
+    {
+      if (m_contexts[i].count > 0)
+        {
+          contexts.push_back (std::make_pair (m_contexts[i].time, i));
+        }
+    }
+  std::stable_sort (contexts.begin (), contexts.end (), MoreTime<uint32_t>);
+
+  os << std::setw (12) << "events" << std::setw (12) << "time (s)"
+     << std::setw (12) << "mean (us)" << std::setw (8) << "%" << "  context" << std::endl;
+  if (m_noContext.count > 0)
+    {
+      Print (os, m_noContext, total, "none");
+    }
+  for (uint32_t i = 0; i < contexts.size (); i++)
+    {
+      std::ostringstream oss;
+      oss << contexts[i].second;
+      Print (os, m_contexts[contexts[i].second], total, oss.str ());
+    }
+
+  os.flags (flags);
+  os.precision (precision);
+}
+
+} // namespace ns3
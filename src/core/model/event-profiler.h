@@ -0,0 +1,134 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include <stdint.h>
+#include <map>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup events
+ * ns3::EventProfiler declaration.
+ */
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup events
+ * \brief Attribute the wall clock time spent in the events to their
+ * type and to their context.
+ *
+ * The simulator calls Start before invoking an event and Stop after it.
+ * The type of an event is the C++ type of its EventImpl: for the events
+ * created by MakeEvent, the report shows the signature of the method or
+ * function bound to the event, including its class, followed by the
+ * type of the object and of the arguments. The context of an event is
+ * normally the id of the node running it.
+ *
+ * The time is measured with a monotonic clock, which costs a few tens of
+ * nanoseconds per event.
+ */
+class EventProfiler
+{
+public:
+  /** Constructor. */
+  EventProfiler ();
+
+  /** Record the start of an event. */
+  void Start (void);
+  /**
+   * Record the end of an event.
+   *
+   * \param [in] event The event which was invoked.
+   * \param [in] context The context of the event.
+   */
+  void Stop (const EventImpl *event, uint32_t context);
+
+  /**
+   * Print the number of events and their wall clock time, by type and
+   * by context, sorted by decreasing time.
+   *
+   * \param [in,out] os The output stream.
+   */
+  void Report (std::ostream &os) const;
+
+private:
+  /** The statistics of a set of events. */
+  struct Record
+  {
+    Record ();
+    uint64_t count;   //!< Number of events
+    uint64_t time;    //!< Cumulative wall clock time, in nanoseconds
+  };
+
+  /** Compare the std::type_info of the events. */
+  struct TypeLess
+  {
+    /**
+     * \param [in] a The first type.
+     * \param [in] b The second type.
+     * \returns \c true if \c a is before \c b.
+     */
+    bool operator () (const std::type_info *a, const std::type_info *b) const
+    {
+      return a->before (*b);
+    }
+  };
+
+  /**
+   * Get the wall clock time.
+   *
+   * \returns The time in nanoseconds.
+   */
+  static uint64_t GetTime (void);
+  /**
+   * Get the readable name of the type of an event.
+   *
+   * \param [in] type The type of the event.
+   * \returns The signature of the function bound to the event and the
+   *          type of its arguments, or the name of the event class.
+   */
+  static std::string GetName (const std::type_info *type);
+  /**
+   * Print a line of the report.
+   *
+   * \param [in,out] os The output stream.
+   * \param [in] record The statistics.
+   * \param [in] total The total time of the events.
+   * \param [in] name The name of the events.
+   */
+  static void Print (std::ostream &os, const Record &record, uint64_t total, const std::string &name);
+
+  /** The statistics by event type. */
+  typedef std::map<const std::type_info *, Record, TypeLess> Types;
+
+  uint64_t m_start;                  //!< Start time of the current event
+  Types m_types;                     //!< The statistics by event type
+  std::vector<Record> m_contexts;    //!< The statistics by context
+  Record m_noContext;                //!< The statistics of the events without context
+};
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
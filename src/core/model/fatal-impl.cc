@@ -147,6 +147,7 @@ void
 FlushStreams (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
+  LogBinaryFlush ();
   std::list<std::ostream*> **pl = PeekStreamList ();
   if (*pl == 0)
     {
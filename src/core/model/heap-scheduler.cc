@@ -237,11 +237,44 @@ HeapScheduler::Remove (const Event &ev)
           Exch (i, Last ());
           m_heap.pop_back ();
           TopDown (i);
+          // the last item may also be smaller than the parent of the
+          // removed one, if they were in different subtrees
+          while (i < m_heap.size () && !IsRoot (i)
+                 && IsLessStrictly (i, Parent (i)))
+            {
+              Exch (i, Parent (i));
+              i = Parent (i);
+            }
           return;
         }
     }
   NS_ASSERT (false);
 }
 
+void
+HeapScheduler::RemoveCancelled (std::vector<Event> &cancelled)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t last = Root ();
+  for (uint32_t i = Root (); i < m_heap.size (); i++)
+    {
+      if (m_heap[i].impl->IsCancelled ())
+        {
+          cancelled.push_back (m_heap[i]);
+        }
+      else
+        {
+          m_heap[last] = m_heap[i];
+          last++;
+        }
+    }
+  m_heap.resize (last);
+  // rebuild the heap from the bottom
+  for (uint32_t i = Parent (Last ()); i >= Root (); i--)
+    {
+      TopDown (i);
+    }
+}
+
 } // namespace ns3
 
@@ -70,6 +70,7 @@ public:
   virtual Scheduler::Event PeekNext (void) const;
   virtual Scheduler::Event RemoveNext (void);
   virtual void Remove (const Scheduler::Event &ev);
+  virtual void RemoveCancelled (std::vector<Scheduler::Event> &cancelled);
 
 private:
   /** Event list type:  vector of Events, managed as a heap. */
@@ -0,0 +1,352 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "log.h"
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::LadderScheduler class.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LadderScheduler> ()
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topMin (0),
+    m_topMax (0),
+    m_topStart (0),
+    m_rungs (MAX_RUNGS),
+    m_nRungs (0),
+    m_bottomHead (0),
+    m_count (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint64_t
+LadderScheduler::GetCurrentStart (const Rung &rung) const
+{
+  return rung.start + rung.current * rung.width;
+}
+
+uint32_t
+LadderScheduler::FindRung (uint64_t ts) const
+{
+  // each rung covers the part of the bucket of the previous rung which
+  // is being consumed
+  for (uint32_t i = 0; i < m_nRungs; i++)
+    {
+      if (ts >= GetCurrentStart (m_rungs[i]))
+        {
+          return i;
+        }
+    }
+  return m_nRungs;
+}
+
+void
+LadderScheduler::SpawnRung (uint64_t start, uint64_t span, Bucket &events)
+{
+  NS_LOG_FUNCTION (this << start << span << events.size ());
+  NS_ASSERT (m_nRungs < MAX_RUNGS);
+  uint32_t n = events.size ();
+  Rung &rung = m_rungs[m_nRungs];
+  rung.start = start;
+  rung.width = span / n + (span % n != 0 ? 1 : 0);
+  rung.nBuckets = n;
+  rung.current = 0;
+  rung.count = n;
+  if (rung.buckets.size () < n)
+    {
+      rung.buckets.resize (n);
+    }
+  for (Bucket::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      uint64_t bucket = (i->key.m_ts - start) / rung.width;
+      NS_ASSERT (bucket < n);
+      rung.buckets[bucket].push_back (*i);
+    }
+  events.clear ();
+  m_nRungs++;
+}
+
+void
+LadderScheduler::Refill (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_bottomHead < m_bottom.size ())
+    {
+      return;
+    }
+  m_bottom.clear ();
+  m_bottomHead = 0;
+  while (m_bottom.empty () && m_count > 0)
+    {
+      if (m_nRungs == 0)
+        {
+          // all the remaining events are in the top
+          NS_ASSERT (!m_top.empty ());
+          uint64_t topMax = m_topMax;
+          SpawnRung (m_topMin, topMax - m_topMin + 1, m_top);
+          m_topStart = topMax + 1;
+          continue;
+        }
+      Rung &rung = m_rungs[m_nRungs - 1];
+      if (rung.count == 0)
+        {
+          m_nRungs--;
+          continue;
+        }
+      while (rung.buckets[rung.current].empty ())
+        {
+          rung.current++;
+          NS_ASSERT (rung.current < rung.nBuckets);
+        }
+      Bucket &bucket = rung.buckets[rung.current];
+      uint64_t start = GetCurrentStart (rung);
+      rung.current++;
+      rung.count -= bucket.size ();
+      if (bucket.size () > THRESHOLD && rung.width > 1 && m_nRungs < MAX_RUNGS)
+        {
+          SpawnRung (start, rung.width, bucket);
+        }
+      else
+        {
+          m_bottom.swap (bucket);
+          std::sort (m_bottom.begin (), m_bottom.end ());
+        }
+    }
+}
+
+void
+LadderScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  m_count++;
+  uint64_t ts = ev.key.m_ts;
+  if (ts >= m_topStart)
+    {
+      if (m_top.empty ())
+        {
+          m_topMin = ts;
+          m_topMax = ts;
+        }
+      m_topMin = std::min (m_topMin, ts);
+      m_topMax = std::max (m_topMax, ts);
+      m_top.push_back (ev);
+    }
+  else
+    {
+      uint32_t i = FindRung (ts);
+      if (i < m_nRungs)
+        {
+          Rung &rung = m_rungs[i];
+          rung.buckets[(ts - rung.start) / rung.width].push_back (ev);
+          rung.count++;
+        }
+      else
+        {
+          Bucket::iterator first = m_bottom.begin () + m_bottomHead;
+          Bucket::iterator it = std::lower_bound (first, m_bottom.end (), ev);
+          if (it == first && m_bottomHead > 0)
+            {
+              // reuse the room left by the events already removed
+              m_bottomHead--;
+              m_bottom[m_bottomHead] = ev;
+            }
+          else
+            {
+              m_bottom.insert (it, ev);
+            }
+          uint64_t bottomMin = m_bottom[m_bottomHead].key.m_ts;
+          uint64_t bottomMax = m_bottom.back ().key.m_ts;
+          if (m_bottom.size () - m_bottomHead > THRESHOLD && m_nRungs < MAX_RUNGS
+              && bottomMax > bottomMin)
+            {
+              // too many events are inserted in the bottom: move them to a
+              // new rung covering the events until the last rung
+              uint64_t end = m_nRungs > 0 ? GetCurrentStart (m_rungs[m_nRungs - 1]) : bottomMax + 1;
+              m_bottom.erase (m_bottom.begin (), m_bottom.begin () + m_bottomHead);
+              m_bottomHead = 0;
+              SpawnRung (bottomMin, end - bottomMin, m_bottom);
+            }
+        }
+    }
+  Refill ();
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  return m_count == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  return m_bottom[m_bottomHead];
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  Scheduler::Event ev = m_bottom[m_bottomHead];
+  m_bottomHead++;
+  m_count--;
+  if (m_count == 0)
+    {
+      m_nRungs = 0;
+      m_topStart = 0;
+    }
+  Refill ();
+  return ev;
+}
+
+void
+LadderScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  NS_ASSERT (!IsEmpty ());
+  uint64_t ts = ev.key.m_ts;
+  Bucket *bucket;
+  if (ts >= m_topStart)
+    {
+      bucket = &m_top;
+    }
+  else
+    {
+      uint32_t i = FindRung (ts);
+      if (i < m_nRungs)
+        {
+          Rung &rung = m_rungs[i];
+          bucket = &rung.buckets[(ts - rung.start) / rung.width];
+          rung.count--;
+        }
+      else
+        {
+          Bucket::iterator it = std::lower_bound (m_bottom.begin () + m_bottomHead, m_bottom.end (), ev);
+          NS_ASSERT (it != m_bottom.end () && it->key.m_uid == ev.key.m_uid);
+          m_bottom.erase (it);
+          bucket = 0;
+        }
+    }
+  if (bucket != 0)
+    {
+      // the top and the buckets are not sorted
+      Bucket::iterator it = bucket->begin ();
+      while (it->key.m_uid != ev.key.m_uid)
+        {
+          ++it;
+          NS_ASSERT (it != bucket->end ());
+        }
+      NS_ASSERT (ev.impl == it->impl);
+      *it = bucket->back ();
+      bucket->pop_back ();
+    }
+  m_count--;
+  if (m_count == 0)
+    {
+      m_nRungs = 0;
+      m_topStart = 0;
+    }
+  Refill ();
+}
+
+void
+LadderScheduler::RemoveCancelled (std::vector<Event> &cancelled)
+{
+  NS_LOG_FUNCTION (this);
+  m_count -= RemoveCancelled (m_top, 0, cancelled);
+  if (!m_top.empty ())
+    {
+      m_topMin = m_top.front ().key.m_ts;
+      m_topMax = m_topMin;
+      for (Bucket::const_iterator i = m_top.begin (); i != m_top.end (); ++i)
+        {
+          m_topMin = std::min (m_topMin, i->key.m_ts);
+          m_topMax = std::max (m_topMax, i->key.m_ts);
+        }
+    }
+  for (uint32_t i = 0; i < m_nRungs; i++)
+    {
+      Rung &rung = m_rungs[i];
+      for (uint32_t j = rung.current; j < rung.nBuckets; j++)
+        {
+          uint32_t removed = RemoveCancelled (rung.buckets[j], 0, cancelled);
+          rung.count -= removed;
+          m_count -= removed;
+        }
+    }
+  m_count -= RemoveCancelled (m_bottom, m_bottomHead, cancelled);
+  if (m_count == 0)
+    {
+      m_nRungs = 0;
+      m_topStart = 0;
+    }
+  Refill ();
+}
+
+uint32_t
+LadderScheduler::RemoveCancelled (Bucket &bucket, uint32_t start, std::vector<Event> &cancelled)
+{
+  // the order of the events which are kept is preserved
+  uint32_t last = start;
+  for (uint32_t i = start; i < bucket.size (); i++)
+    {
+      if (bucket[i].impl->IsCancelled ())
+        {
+          cancelled.push_back (bucket[i]);
+        }
+      else
+        {
+          bucket[last] = bucket[i];
+          last++;
+        }
+    }
+  uint32_t removed = bucket.size () - last;
+  bucket.resize (last);
+  return removed;
+}
+
+} // namespace ns3
@@ -0,0 +1,155 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Declaration of ns3::LadderScheduler class.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the ladder queue published in 2005 in
+ * "Ladder Queue: An O(1) Priority Queue Structure for Large-Scale Discrete
+ * Event Simulation" by Wai Teng Tang, Rick Siow Mong Goh and Ian Li-Jin
+ * Thng. The events are kept in three tiers:
+ *  - the top, an unsorted vector of the events far in the future;
+ *  - the ladder, made of up to MAX_RUNGS rungs of buckets. When the events
+ *    of the top are needed, they are spread in the buckets of a first rung,
+ *    and the buckets holding more than THRESHOLD events are spread in turn
+ *    in the buckets of a finer rung, when their events are needed;
+ *  - the bottom, a vector of the next events sorted in increasing order,
+ *    which is refilled with the first non-empty bucket of the ladder.
+ *
+ * Each event is thus moved a bounded number of times, and the sorting is
+ * restricted to a small number of events, which makes insertion and removal
+ * amortized O(1) whatever the distribution of the timestamps. The buckets
+ * are vectors which are reused across rungs, hence the events are stored
+ * contiguously and are not allocated one by one.
+ *
+ * Removing an arbitrary event (a cancelled event) requires a linear search
+ * in the top, in one bucket or in the bottom.
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  LadderScheduler ();
+  /** Destructor. */
+  virtual ~LadderScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+  virtual void RemoveCancelled (std::vector<Scheduler::Event> &cancelled);
+
+private:
+  /** Bucket type: unsorted vector of events. */
+  typedef std::vector<Scheduler::Event> Bucket;
+
+  /** A rung of the ladder. */
+  struct Rung
+  {
+    uint64_t start;               //!< Timestamp of the start of the first bucket
+    uint64_t width;               //!< Width of the buckets
+    uint32_t nBuckets;            //!< Number of buckets in use
+    uint32_t current;             //!< Index of the first bucket not yet consumed
+    uint32_t count;               //!< Number of events in the rung
+    std::vector<Bucket> buckets;  //!< The buckets, some of them unused
+  };
+
+  /** Largest number of rungs. */
+  static const uint32_t MAX_RUNGS = 8;
+  /** Number of events in a bucket above which a new rung is spawned. */
+  static const uint32_t THRESHOLD = 50;
+
+  /**
+   * Get the timestamp of the start of the first bucket not yet consumed.
+   *
+   * \param [in] rung The rung.
+   * \returns The smallest timestamp of the events which can be stored in the rung.
+   */
+  inline uint64_t GetCurrentStart (const Rung &rung) const;
+  /**
+   * Find the rung in which an event must be stored.
+   *
+   * \param [in] ts The timestamp of the event.
+   * \returns The index of the rung, or m_nRungs if the event belongs to the bottom.
+   */
+  uint32_t FindRung (uint64_t ts) const;
+  /**
+   * Spread events in the buckets of a new rung.
+   *
+   * \param [in] start The smallest timestamp covered by the rung.
+   * \param [in] span The number of timestamps covered by the rung.
+   * \param [in,out] events The events, which are removed from the vector.
+   */
+  void SpawnRung (uint64_t start, uint64_t span, Bucket &events);
+  /** Move the next events to the bottom, if it is empty. */
+  void Refill (void);
+  /**
+   * Remove the cancelled events of a bucket.
+   *
+   * \param [in,out] bucket The bucket.
+   * \param [in] start The index of the first event of the bucket.
+   * \param [out] cancelled The removed events are appended to this vector.
+   * \returns The number of events removed.
+   */
+  uint32_t RemoveCancelled (Bucket &bucket, uint32_t start, std::vector<Scheduler::Event> &cancelled);
+
+  /** The events far in the future. */
+  Bucket m_top;
+  /** Smallest timestamp of the events in the top. */
+  uint64_t m_topMin;
+  /** Largest timestamp of the events in the top. */
+  uint64_t m_topMax;
+  /** Smallest timestamp of the events to be stored in the top. */
+  uint64_t m_topStart;
+  /** The rungs of the ladder, m_nRungs of them in use. */
+  std::vector<Rung> m_rungs;
+  /** Number of rungs in use. */
+  uint32_t m_nRungs;
+  /** The next events, sorted in increasing order from m_bottomHead. */
+  Bucket m_bottom;
+  /** Index of the next event in the bottom. */
+  uint32_t m_bottomHead;
+  /** Number of events in the scheduler. */
+  uint32_t m_count;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
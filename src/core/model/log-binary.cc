@@ -0,0 +1,699 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "log-binary.h"
+#include "simulator.h"
+#include "nstime.h"
+#include "ns3/core-config.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <streambuf>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+/**
+ * \file
+ * \ingroup logbinary
+ * Binary logging backend implementation.
+ *
+ * This file must not log: the logging macros would call it back.
+ */
+
+namespace ns3 {
+
+namespace {
+
+/** The first bytes of a binary log file. */
+const char MAGIC[8] = { 'N', 'S', '3', 'B', 'L', 'O', 'G', '1' };
+
+/** The kinds of record. */
+enum RecordKind
+{
+  RECORD_MESSAGE = 0,    //!< A message of NS_LOG
+  RECORD_FUNCTION = 1    //!< The arguments of NS_LOG_FUNCTION
+};
+
+/**
+ * \ingroup logbinary
+ * The header of a record of the binary log, followed by the names of
+ * the component and of the function, and by the message.
+ */
+struct RecordHeader
+{
+  uint32_t size;            //!< Size of the record, header included
+  uint32_t level;           //!< LogLevel of the message
+  uint32_t prefix;          //!< Prefixes to print
+  uint32_t context;         //!< Simulation context
+  int64_t time;             //!< Simulation time, in units of the resolution
+  uint8_t resolution;       //!< Time::Unit of the time
+  uint8_t kind;             //!< RecordKind
+  uint16_t componentSize;   //!< Size of the component name
+  uint16_t functionSize;    //!< Size of the function name
+  uint16_t reserved;        //!< Padding
+};
+
+/**
+ * \ingroup logbinary
+ * A stream buffer appending to a growable array, on which the messages
+ * are formatted.
+ */
+class LogBinaryStreamBuf : public std::streambuf
+{
+public:
+  /** Constructor. */
+  LogBinaryStreamBuf ()
+    : m_buffer (256)
+  {
+    Reset ();
+  }
+  /** Empty the buffer. */
+  void Reset (void)
+  {
+    setp (&m_buffer[0], &m_buffer[0] + m_buffer.size ());
+  }
+  /** \returns The formatted bytes. */
+  const char * GetData (void) const
+  {
+    return pbase ();
+  }
+  /** \returns The number of formatted bytes. */
+  uint32_t GetSize (void) const
+  {
+    return pptr () - pbase ();
+  }
+
+private:
+  /**
+   * Grow the buffer.
+   *
+   * \param [in] c The character which did not fit.
+   * \returns Something else than EOF.
+   */
+  virtual int_type overflow (int_type c)
+  {
+    int size = GetSize ();
+    m_buffer.resize (m_buffer.size () * 2);
+    setp (&m_buffer[0], &m_buffer[0] + m_buffer.size ());
+    pbump (size);
+    if (!traits_type::eq_int_type (c, traits_type::eof ()))
+      {
+        *pptr () = traits_type::to_char_type (c);
+        pbump (1);
+      }
+    return traits_type::not_eof (c);
+  }
+
+  std::vector<char> m_buffer;  //!< The storage
+};
+
+/**
+ * \ingroup logbinary
+ * The records of a thread, written by that thread and read by the
+ * writer. The positions only increase, and a record becomes visible to
+ * the writer once it is completely copied.
+ */
+class LogBinaryRing
+{
+public:
+  /** Size of the ring, a power of two. */
+  static const uint32_t SIZE = 1 << 20;
+
+  /** Constructor. */
+  LogBinaryRing ()
+    : m_data (new char[SIZE]),
+      m_head (0),
+      m_tail (0)
+  {
+  }
+  /** Destructor. */
+  ~LogBinaryRing ()
+  {
+    delete [] m_data;
+  }
+  /**
+   * \param [in] size The size of a record.
+   * \returns \c true if the record fits in the free space.
+   */
+  bool HasRoom (uint32_t size) const
+  {
+    return m_head - m_tail + size <= SIZE;
+  }
+  /**
+   * Copy a part of a record which is not visible yet.
+   *
+   * \param [in] offset The offset in the record.
+   * \param [in] data The bytes.
+   * \param [in] size The number of bytes.
+   */
+  void Copy (uint32_t offset, const void *data, uint32_t size)
+  {
+    uint32_t start = (m_head + offset) & (SIZE - 1);
+    uint32_t first = std::min (size, SIZE - start);
+    std::memcpy (m_data + start, data, first);
+    std::memcpy (m_data, static_cast<const char *> (data) + first, size - first);
+  }
+  /**
+   * Make a record visible to the writer.
+   *
+   * \param [in] size The size of the record.
+   */
+  void Commit (uint32_t size)
+  {
+    __sync_synchronize ();
+    m_head = m_head + size;
+  }
+  /**
+   * Write the visible records to a file.
+   *
+   * \param [in] file The file.
+   * \returns \c true if there were records to write.
+   */
+  bool Drain (std::FILE *file)
+  {
+    uint64_t head = m_head;
+    uint64_t tail = m_tail;
+    if (head == tail)
+      {
+        return false;
+      }
+    __sync_synchronize ();
+    uint32_t start = tail & (SIZE - 1);
+    uint32_t size = head - tail;
+    uint32_t first = std::min (size, SIZE - start);
+    std::fwrite (m_data + start, 1, first, file);
+    std::fwrite (m_data, 1, size - first, file);
+    __sync_synchronize ();
+    m_tail = head;
+    return true;
+  }
+
+private:
+  char *m_data;                //!< The bytes
+  volatile uint64_t m_head;    //!< Position after the last visible record
+  volatile uint64_t m_tail;    //!< Position of the first record not written
+};
+
+/**
+ * \ingroup logbinary
+ * Owner of the rings of the threads and of the binary log file.
+ *
+ * When threads are available, a background thread writes the rings
+ * to the file; a thread which finds its ring full waits for it.
+ * Otherwise, and once the program exits, the threads write their own
+ * ring.
+ *
+ * A process forked by the program writes its records to its own file,
+ * named after the file of its parent followed by a dot and its pid.
+ */
+class LogBinaryWriter
+{
+public:
+  /** \returns The writer, created on the first call. */
+  static LogBinaryWriter * Get (void);
+  /** \returns The writer, or zero if nothing was logged yet. */
+  static LogBinaryWriter * Peek (void);
+  /** \returns The ring of the calling thread. */
+  LogBinaryRing * GetRing (void);
+  /**
+   * Wait until a record fits in a ring.
+   *
+   * \param [in] ring The ring of the calling thread.
+   * \param [in] size The size of the record.
+   */
+  void Reserve (LogBinaryRing *ring, uint32_t size);
+  /**
+   * Write the records just committed, unless the background thread
+   * does it.
+   */
+  void Committed (void);
+  /** Write the records of all the rings. */
+  void Flush (void);
+
+private:
+  /** Constructor. */
+  LogBinaryWriter ();
+  /** Stop the background thread and write the remaining records. */
+  static void Stop (void);
+  /**
+   * Write the records of all the rings.
+   * \returns \c true if there were records to write.
+   */
+  bool DrainAll (void);
+#ifdef HAVE_PTHREAD_H
+  /**
+   * Body of the background thread.
+   * \param [in] writer The writer.
+   * \returns 0.
+   */
+  static void * Run (void *writer);
+  /** Write the records of all the rings and lock them before a fork. */
+  static void ForkPrepare (void);
+  /** Unlock the rings after a fork, in the parent process. */
+  static void ForkParent (void);
+  /**
+   * Unlock the rings after a fork, open the file of the child process
+   * and start its background thread.
+   */
+  static void ForkChild (void);
+  /** Open m_file and write the magic. */
+  void Open (void);
+
+  pthread_mutex_t m_mutex;          //!< Protects the rings and the file
+  pthread_t m_thread;               //!< The background thread
+#endif
+  volatile bool m_running;          //!< Whether the background thread runs
+  std::FILE *m_file;                //!< The binary log file
+  std::string m_name;               //!< The name of the binary log file
+  std::vector<LogBinaryRing *> m_rings;  //!< The rings of the threads
+};
+
+/** The writer, once created. */
+LogBinaryWriter *g_writer = 0;
+/** The ring of the current thread. */
+__thread LogBinaryRing *g_ring = 0;
+/**
+ * The number of nested messages a thread can format at once: the
+ * arguments of a message may log while they are formatted.
+ */
+const uint32_t LOG_BINARY_DEPTH = 4;
+/** The buffers on which the current thread formats its messages. */
+__thread LogBinaryStreamBuf *g_streamBuf[LOG_BINARY_DEPTH];
+/** The streams on which the current thread formats its messages. */
+__thread std::ostream *g_stream[LOG_BINARY_DEPTH];
+/** The number of messages the current thread is formatting. */
+__thread uint32_t g_depth = 0;
+
+LogBinaryWriter *
+LogBinaryWriter::Get (void)
+{
+  // never deleted: the destructors of the static objects may still log
+  static LogBinaryWriter *writer = new LogBinaryWriter ();
+  return writer;
+}
+
+LogBinaryWriter *
+LogBinaryWriter::Peek (void)
+{
+  return g_writer;
+}
+
+LogBinaryWriter::LogBinaryWriter ()
+  : m_running (false),
+    m_file (0)
+{
+  const char *name = std::getenv ("NS_LOG_BINARY_FILE");
+  m_name = name != 0 ? name : "ns3-log.bin";
+  Open ();
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_init (&m_mutex, 0);
+  m_running = pthread_create (&m_thread, 0, &LogBinaryWriter::Run, this) == 0;
+  pthread_atfork (&LogBinaryWriter::ForkPrepare, &LogBinaryWriter::ForkParent,
+                  &LogBinaryWriter::ForkChild);
+#endif
+  std::atexit (&LogBinaryWriter::Stop);
+  g_writer = this;
+}
+
+void
+LogBinaryWriter::Open (void)
+{
+  m_file = std::fopen (m_name.c_str (), "wb");
+  if (m_file == 0)
+    {
+      std::perror ("could not open the binary log file");
+      std::abort ();
+    }
+  std::fwrite (MAGIC, 1, sizeof (MAGIC), m_file);
+}
+
+LogBinaryRing *
+LogBinaryWriter::GetRing (void)
+{
+  LogBinaryRing *ring = new LogBinaryRing ();
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_lock (&m_mutex);
+#endif
+  m_rings.push_back (ring);
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_unlock (&m_mutex);
+#endif
+  return ring;
+}
+
+void
+LogBinaryWriter::Reserve (LogBinaryRing *ring, uint32_t size)
+{
+  while (!ring->HasRoom (size))
+    {
+#ifdef HAVE_PTHREAD_H
+      if (m_running)
+        {
+          sched_yield ();
+          continue;
+        }
+#endif
+      Flush ();
+    }
+}
+
+void
+LogBinaryWriter::Committed (void)
+{
+  if (!m_running)
+    {
+      Flush ();
+    }
+}
+
+bool
+LogBinaryWriter::DrainAll (void)
+{
+  bool drained = false;
+  for (uint32_t i = 0; i < m_rings.size (); i++)
+    {
+      drained |= m_rings[i]->Drain (m_file);
+    }
+  return drained;
+}
+
+void
+LogBinaryWriter::Flush (void)
+{
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_lock (&m_mutex);
+#endif
+  DrainAll ();
+  std::fflush (m_file);
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_unlock (&m_mutex);
+#endif
+}
+
+void
+LogBinaryWriter::Stop (void)
+{
+  LogBinaryWriter *writer = Peek ();
+#ifdef HAVE_PTHREAD_H
+  if (writer->m_running)
+    {
+      writer->m_running = false;
+      pthread_join (writer->m_thread, 0);
+    }
+#endif
+  writer->Flush ();
+}
+
+#ifdef HAVE_PTHREAD_H
+void *
+LogBinaryWriter::Run (void *arg)
+{
+  LogBinaryWriter *writer = static_cast<LogBinaryWriter *> (arg);
+  while (writer->m_running)
+    {
+      pthread_mutex_lock (&writer->m_mutex);
+      bool drained = writer->DrainAll ();
+      pthread_mutex_unlock (&writer->m_mutex);
+      if (!drained)
+        {
+          struct timespec delay = { 0, 1000000 };
+          nanosleep (&delay, 0);
+        }
+    }
+  return 0;
+}
+
+void
+LogBinaryWriter::ForkPrepare (void)
+{
+  LogBinaryWriter *writer = Peek ();
+  pthread_mutex_lock (&writer->m_mutex);
+  writer->DrainAll ();
+  std::fflush (writer->m_file);
+}
+
+void
+LogBinaryWriter::ForkParent (void)
+{
+  pthread_mutex_unlock (&Peek ()->m_mutex);
+}
+
+void
+LogBinaryWriter::ForkChild (void)
+{
+  LogBinaryWriter *writer = Peek ();
+  pthread_mutex_unlock (&writer->m_mutex);
+  // the rings of the other threads are empty, and stay so
+  std::fclose (writer->m_file);
+  std::ostringstream name;
+  name << writer->m_name << "." << getpid ();
+  writer->m_name = name.str ();
+  writer->Open ();
+  if (writer->m_running)
+    {
+      writer->m_running = pthread_create (&writer->m_thread, 0, &LogBinaryWriter::Run, writer) == 0;
+    }
+}
+#endif
+
+/**
+ * \ingroup logbinary
+ * Append a record to the ring of the calling thread.
+ *
+ * \param [in] component The log component.
+ * \param [in] level The level of the message.
+ * \param [in] kind The RecordKind.
+ * \param [in] function The name of the logging function.
+ */
+void
+LogBinaryAppend (const LogComponent &component, enum LogLevel level,
+                 enum RecordKind kind, const char *function)
+{
+  LogBinaryStreamBuf *streamBuf = g_streamBuf[std::min (g_depth, LOG_BINARY_DEPTH) - 1];
+  g_depth--;
+  LogBinaryWriter *writer = LogBinaryWriter::Get ();
+  if (g_ring == 0)
+    {
+      g_ring = writer->GetRing ();
+    }
+  RecordHeader header;
+  header.level = level;
+  header.prefix = 0;
+  header.context = 0xffffffff;
+  header.time = 0;
+  header.resolution = 0;
+  header.kind = kind;
+  header.reserved = 0;
+  enum LogLevel prefixes[] = { LOG_PREFIX_FUNC, LOG_PREFIX_TIME, LOG_PREFIX_NODE, LOG_PREFIX_LEVEL };
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      if (component.IsEnabled (prefixes[i]))
+        {
+          header.prefix |= prefixes[i];
+        }
+    }
+  // the printers are set while a simulator exists; before, the
+  // resolution may not be initialized yet
+  if ((header.prefix & LOG_PREFIX_TIME) && LogGetTimePrinter () != 0)
+    {
+      header.time = Simulator::Now ().GetTimeStep ();
+      header.resolution = Time::GetResolution ();
+    }
+  else
+    {
+      header.prefix &= ~LOG_PREFIX_TIME;
+    }
+  if ((header.prefix & LOG_PREFIX_NODE) && LogGetNodePrinter () != 0)
+    {
+      header.context = Simulator::GetContext ();
+    }
+  else
+    {
+      header.prefix &= ~LOG_PREFIX_NODE;
+    }
+  const char *name = component.Name ();
+  header.componentSize = std::min<std::size_t> (std::strlen (name), 0xffff);
+  header.functionSize = std::min<std::size_t> (std::strlen (function), 0xffff);
+  uint32_t messageSize = streamBuf->GetSize ();
+  uint32_t size = sizeof (header) + header.componentSize + header.functionSize;
+  messageSize = std::min (messageSize, LogBinaryRing::SIZE - size);
+  size += messageSize;
+  header.size = size;
+
+  writer->Reserve (g_ring, size);
+  g_ring->Copy (0, &header, sizeof (header));
+  g_ring->Copy (sizeof (header), name, header.componentSize);
+  g_ring->Copy (sizeof (header) + header.componentSize, function, header.functionSize);
+  g_ring->Copy (size - messageSize, streamBuf->GetData (), messageSize);
+  g_ring->Commit (size);
+  writer->Committed ();
+}
+
+/**
+ * \ingroup logbinary
+ * Get the number of seconds in a unit of time.
+ *
+ * \param [in] time The time, in units of \p resolution.
+ * \param [in] resolution The Time::Unit.
+ * \returns The time in seconds.
+ */
+double
+LogBinaryGetSeconds (int64_t time, uint8_t resolution)
+{
+  switch (resolution)
+    {
+    case Time::Y:
+      return time * 365.0 * 24 * 3600;
+    case Time::D:
+      return time * 24.0 * 3600;
+    case Time::H:
+      return time * 3600.0;
+    case Time::MIN:
+      return time * 60.0;
+    case Time::S:
+      return time;
+    case Time::MS:
+      return time / 1e3;
+    case Time::US:
+      return time / 1e6;
+    case Time::NS:
+      return time / 1e9;
+    case Time::PS:
+      return time / 1e12;
+    case Time::FS:
+      return time / 1e15;
+    default:
+      return 0;
+    }
+}
+
+} // unnamed namespace
+
+std::ostream &
+LogBinaryBegin (void)
+{
+  // deeper messages share the last stream and garble each other
+  uint32_t i = std::min (g_depth, LOG_BINARY_DEPTH - 1);
+  g_depth++;
+  if (g_stream[i] == 0)
+    {
+      g_streamBuf[i] = new LogBinaryStreamBuf ();
+      g_stream[i] = new std::ostream (g_streamBuf[i]);
+    }
+  g_streamBuf[i]->Reset ();
+  // do not inherit the format of the previous message
+  std::ostream *stream = g_stream[i];
+  stream->clear ();
+  stream->flags (std::ios::dec | std::ios::skipws);
+  stream->precision (6);
+  stream->width (0);
+  stream->fill (' ');
+  return *stream;
+}
+
+void
+LogBinaryEnd (const LogComponent &component, enum LogLevel level, const char *function)
+{
+  LogBinaryAppend (component, level, RECORD_MESSAGE, function);
+}
+
+void
+LogBinaryEndFunction (const LogComponent &component, const char *function)
+{
+  LogBinaryAppend (component, LOG_FUNCTION, RECORD_FUNCTION, function);
+}
+
+void
+LogBinaryFlush (void)
+{
+  LogBinaryWriter *writer = LogBinaryWriter::Peek ();
+  if (writer != 0)
+    {
+      writer->Flush ();
+    }
+}
+
+bool
+LogBinaryPrint (std::istream &is, std::ostream &os)
+{
+  char magic[sizeof (MAGIC)];
+  is.read (magic, sizeof (magic));
+  if (!is || std::memcmp (magic, MAGIC, sizeof (MAGIC)) != 0)
+    {
+      return false;
+    }
+  std::vector<char> data;
+  RecordHeader header;
+  while (is.read (reinterpret_cast<char *> (&header), sizeof (header)))
+    {
+      if (header.size < sizeof (header) + header.componentSize + header.functionSize)
+        {
+          return false;
+        }
+      data.resize (header.size - sizeof (header) + 1);
+      if (!is.read (&data[0], header.size - sizeof (header)))
+        {
+          return false;
+        }
+      std::string component (&data[0], header.componentSize);
+      std::string function (&data[header.componentSize], header.functionSize);
+      uint32_t messageOffset = header.componentSize + header.functionSize;
+      std::string message (&data[messageOffset], header.size - sizeof (header) - messageOffset);
+
+      if (header.prefix & LOG_PREFIX_TIME)
+        {
+          os << LogBinaryGetSeconds (header.time, header.resolution) << "s ";
+        }
+      if (header.prefix & LOG_PREFIX_NODE)
+        {
+          if (header.context == 0xffffffff)
+            {
+              os << "-1 ";
+            }
+          else
+            {
+              os << header.context << " ";
+            }
+        }
+      if (header.kind == RECORD_FUNCTION)
+        {
+          os << component << ":" << function << "(" << message << ")" << std::endl;
+          continue;
+        }
+      if (header.prefix & LOG_PREFIX_FUNC)
+        {
+          os << component << ":" << function << "(): ";
+        }
+      if (header.prefix & LOG_PREFIX_LEVEL)
+        {
+          os << "[" << LogComponent::GetLevelLabel (static_cast<enum LogLevel> (header.level)) << "] ";
+        }
+      os << message << std::endl;
+    }
+  return is.eof ();
+}
+
+} // namespace ns3
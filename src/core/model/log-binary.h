@@ -0,0 +1,111 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_LOG_BINARY_H
+#define NS3_LOG_BINARY_H
+
+#include "log.h"
+#include <iostream>
+
+/**
+ * \file
+ * \ingroup logging
+ * Binary logging backend.
+ */
+
+/**
+ * \ingroup logging
+ * \defgroup logbinary Binary logging
+ *
+ * When ns-3 is configured with \c --enable-binary-logs, the logging
+ * macros do not print on \c std::clog. Each message is formatted in a
+ * buffer of the calling thread and appended, along with the raw
+ * simulation time, the context and the names of the component and of
+ * the function, to a ring buffer owned by that thread. A background
+ * thread writes the ring buffers to the file named by the
+ * \c NS_LOG_BINARY_FILE environment variable (\c ns3-log.bin by
+ * default). The prefixes are formatted when the file is converted to
+ * text by LogBinaryPrint, for example with the \c print-binary-log
+ * program:
+ * \code
+ *   $ ./waf --run "print-binary-log --input=ns3-log.bin"
+ * \endcode
+ *
+ * The time and node prefixes come from Simulator::Now and
+ * Simulator::GetContext, rather than from the LogTimePrinter and
+ * LogNodePrinter functions. NS_LOG_APPEND_CONTEXT is not used.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup logbinary
+ * Get the stream on which the message of a binary log record is
+ * formatted.
+ *
+ * \internal
+ * Logging implementation function; should not be called directly.
+ *
+ * \returns The stream of the calling thread, emptied.
+ */
+std::ostream & LogBinaryBegin (void);
+/**
+ * \ingroup logbinary
+ * Append a record holding the message formatted on the stream returned
+ * by LogBinaryBegin to the ring buffer of the calling thread.
+ *
+ * \internal
+ * Logging implementation function; should not be called directly.
+ *
+ * \param [in] component The log component.
+ * \param [in] level The level of the message.
+ * \param [in] function The name of the logging function.
+ */
+void LogBinaryEnd (const LogComponent &component, enum LogLevel level, const char *function);
+/**
+ * \ingroup logbinary
+ * Append a record holding the arguments of a function, formatted on
+ * the stream returned by LogBinaryBegin, to the ring buffer of the
+ * calling thread.
+ *
+ * \internal
+ * Logging implementation function; should not be called directly.
+ *
+ * \param [in] component The log component.
+ * \param [in] function The name of the function.
+ */
+void LogBinaryEndFunction (const LogComponent &component, const char *function);
+/**
+ * \ingroup logbinary
+ * Write the records of all the threads to the binary log file.
+ *
+ * This is called when the program exits and by NS_FATAL_ERROR.
+ */
+void LogBinaryFlush (void);
+/**
+ * \ingroup logbinary
+ * Convert a binary log to text, formatted as the logging macros print
+ * it without the binary backend.
+ *
+ * \param [in,out] is The binary log.
+ * \param [in,out] os The output stream.
+ * \returns \c false if \p is is not a complete binary log.
+ */
+bool LogBinaryPrint (std::istream &is, std::ostream &os);
+
+} // namespace ns3
+
+#endif /* NS3_LOG_BINARY_H */
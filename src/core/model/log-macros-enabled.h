@@ -130,6 +130,53 @@
 #define NS_LOG_CONDITION
 #endif
 
+#ifdef NS3_LOG_BINARY
+
+/*
+ * The binary backend formats the message on a buffer of the thread,
+ * and leaves the prefixes to the conversion of the log to text.
+ * See log-binary.h.
+ */
+
+#define NS_LOG(level, msg)                                      \
+  NS_LOG_CONDITION                                              \
+  do                                                            \
+    {                                                           \
+      if (g_log.IsEnabled (level))                              \
+        {                                                       \
+          ns3::LogBinaryBegin () << msg;                        \
+          ns3::LogBinaryEnd (g_log, level, __FUNCTION__);       \
+        }                                                       \
+    }                                                           \
+  while (false)
+
+#define NS_LOG_FUNCTION_NOARGS()                                \
+  NS_LOG_CONDITION                                              \
+  do                                                            \
+    {                                                           \
+      if (g_log.IsEnabled (ns3::LOG_FUNCTION))                  \
+        {                                                       \
+          ns3::LogBinaryBegin ();                               \
+          ns3::LogBinaryEndFunction (g_log, __FUNCTION__);      \
+        }                                                       \
+    }                                                           \
+  while (false)
+
+#define NS_LOG_FUNCTION(parameters)                             \
+  NS_LOG_CONDITION                                              \
+  do                                                            \
+    {                                                           \
+      if (g_log.IsEnabled (ns3::LOG_FUNCTION))                  \
+        {                                                       \
+          ns3::ParameterLogger (ns3::LogBinaryBegin ())         \
+            << parameters;                                      \
+          ns3::LogBinaryEndFunction (g_log, __FUNCTION__);      \
+        }                                                       \
+    }                                                           \
+  while (false)
+
+#else /* NS3_LOG_BINARY */
+
 /**
  * \ingroup logging
  *
@@ -228,6 +275,9 @@
   while (false)
 
 
+#endif /* NS3_LOG_BINARY */
+
+
 /**
  * \ingroup logging
  *
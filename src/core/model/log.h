@@ -325,16 +325,19 @@ public:
   /**
    * Check if this LogComponent is enabled for \c level
    *
+   * This is inlined, so that the check of a disabled level costs
+   * a single load.
+   *
    * \param [in] level The level to check for.
    * \return \c true if we are enabled at \c level.
    */
-  bool IsEnabled (const enum LogLevel level) const;
+  inline bool IsEnabled (const enum LogLevel level) const;
   /**
    * Check if all levels are disabled.
    *
    * \return \c true if all levels are disabled.
    */
-  bool IsNoneEnabled (void) const;
+  inline bool IsNoneEnabled (void) const;
   /**
    * Enable this LogComponent at \c level
    *
@@ -409,6 +412,19 @@ private:
 
 };  // class LogComponent
 
+inline bool
+LogComponent::IsEnabled (const enum LogLevel level) const
+{
+  //  LogComponentEnableEnvVar ();
+  return (level & m_levels) ? 1 : 0;
+}
+
+inline bool
+LogComponent::IsNoneEnabled (void) const
+{
+  return m_levels == 0;
+}
+
   
 /**
  * Insert `, ` when streaming function arguments.
@@ -452,4 +468,6 @@ public:
 
 /**@}*/  // \ingroup logging
 
+#include "log-binary.h"
+
 #endif /* NS3_LOG_H */
@@ -33,8 +33,13 @@
 #include "log.h"
 #include "rng-stream.h"
 #include "rng-seed-manager.h"
+#include "ns3/core-config.h"
 #include <cmath>
 #include <iostream>
+#include <set>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
 
 /**
  * \file
@@ -71,17 +76,80 @@ RandomVariableStream::GetTypeId (void)
   return tid;
 }
 
+namespace {
+
+/**
+ * \ingroup randomvariable
+ * The existing RandomVariableStream instances.
+ *
+ * \returns The set, never deleted: the RandomVariableStream instances
+ * may be destroyed by other static destructors.
+ */
+std::set<RandomVariableStream *> *
+GetInstances (void)
+{
+  static std::set<RandomVariableStream *> *instances = new std::set<RandomVariableStream *> ();
+  return instances;
+}
+
+#ifdef HAVE_PTHREAD_H
+/** Protect the instances, which may be created by several threads. */
+pthread_mutex_t g_instancesMutex = PTHREAD_MUTEX_INITIALIZER;
+#endif /* HAVE_PTHREAD_H */
+
+/** Lock g_instancesMutex in a scope. */
+class InstancesLock
+{
+public:
+  InstancesLock ()
+  {
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_lock (&g_instancesMutex);
+#endif /* HAVE_PTHREAD_H */
+  }
+  ~InstancesLock ()
+  {
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_unlock (&g_instancesMutex);
+#endif /* HAVE_PTHREAD_H */
+  }
+};
+
+} // unnamed namespace
+
 RandomVariableStream::RandomVariableStream()
   : m_rng (0)
 {
   NS_LOG_FUNCTION (this);
+  InstancesLock lock;
+  GetInstances ()->insert (this);
 }
 RandomVariableStream::~RandomVariableStream()
 {
   NS_LOG_FUNCTION (this);
+  {
+    InstancesLock lock;
+    GetInstances ()->erase (this);
+  }
   delete m_rng;
 }
 
+void
+RandomVariableStream::AdvanceAllSubstreams (uint64_t n)
+{
+  NS_LOG_FUNCTION (n);
+  InstancesLock lock;
+  std::set<RandomVariableStream *> *instances = GetInstances ();
+  for (std::set<RandomVariableStream *>::iterator i = instances->begin ();
+       i != instances->end (); ++i)
+    {
+      if ((*i)->m_rng != 0)
+        {
+          (*i)->m_rng->AdvanceSubstreams (n);
+        }
+    }
+}
+
 void
 RandomVariableStream::SetAntithetic(bool isAntithetic)
 {
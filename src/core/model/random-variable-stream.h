@@ -149,6 +149,18 @@ public:
    */
   virtual uint32_t GetInteger (void) = 0;
 
+  /**
+   * \brief Jump the RNG streams of all the existing RandomVariableStream
+   * instances ahead by \p n substreams.
+   *
+   * This gives independent random numbers to the copies of a process
+   * forked by Checkpoint::Fork, as different runs do, without
+   * changing the other state of the simulation.
+   *
+   * \param [in] n The number of substreams.
+   */
+  static void AdvanceAllSubstreams (uint64_t n);
+
 protected:
   /**
    * \brief Get the pointer to the underlying RNG stream.
@@ -70,6 +70,16 @@ public:
    * \returns The next random.
    */
   double RandU01 (void);
+  /**
+   * Jump ahead by \p n substreams, i.e., by \p n times 2<sup>76</sup>
+   * numbers.
+   *
+   * Two copies of a stream advanced by different \p n generate
+   * independent numbers, as two runs do.
+   *
+   * \param [in] n The number of substreams.
+   */
+  void AdvanceSubstreams (uint64_t n);
 
 private:
   /**
@@ -19,6 +19,7 @@
  */
 
 #include "scheduler.h"
+#include "event-impl.h"
 #include "assert.h"
 #include "log.h"
 
@@ -49,4 +50,27 @@ Scheduler::GetTypeId (void)
   return tid;
 }
 
+void
+Scheduler::RemoveCancelled (std::vector<Event> &cancelled)
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<Event> events;
+  while (!IsEmpty ())
+    {
+      Event ev = RemoveNext ();
+      if (ev.impl->IsCancelled ())
+        {
+          cancelled.push_back (ev);
+        }
+      else
+        {
+          events.push_back (ev);
+        }
+    }
+  for (std::vector<Event>::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      Insert (*i);
+    }
+}
+
 } // namespace ns3
@@ -22,6 +22,7 @@
 #define SCHEDULER_H
 
 #include <stdint.h>
+#include <vector>
 #include "object.h"
 
 /**
@@ -135,6 +136,17 @@ public:
    * \param [in] ev The event to remove
    */
   virtual void Remove (const Event &ev) = 0;
+  /**
+   * Remove all the cancelled events from the event list.
+   *
+   * The cancelled events otherwise stay in the event list until they
+   * reach the head of the list. The default implementation removes
+   * all the events and inserts back those which are not cancelled.
+   *
+   * \param [out] cancelled The removed events are appended to this
+   *        vector: the caller must unref them.
+   */
+  virtual void RemoveCancelled (std::vector<Event> &cancelled);
 };
 
 /**
@@ -42,4 +42,28 @@ SimulatorImpl::GetTypeId (void)
   return tid;
 }
 
+uint64_t
+SimulatorImpl::GetEventCount (void) const
+{
+  return 0;
+}
+
+uint32_t
+SimulatorImpl::GetPendingEventCount (void) const
+{
+  return 0;
+}
+
+uint32_t
+SimulatorImpl::GetCancelledEventCount (void) const
+{
+  return 0;
+}
+
+uint64_t
+SimulatorImpl::GetCompactedEventCount (void) const
+{
+  return 0;
+}
+
 } // namespace ns3
@@ -360,6 +360,66 @@ Simulator::GetSystemId (void)
     }
 }
 
+uint64_t
+Simulator::GetEventCount (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  if (*PeekImpl () != 0)
+    {
+      return GetImpl ()->GetEventCount ();
+    }
+  else
+    {
+      return 0;
+    }
+}
+
+uint32_t
+Simulator::GetPendingEventCount (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  if (*PeekImpl () != 0)
+    {
+      return GetImpl ()->GetPendingEventCount ();
+    }
+  else
+    {
+      return 0;
+    }
+}
+
+uint32_t
+Simulator::GetCancelledEventCount (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  if (*PeekImpl () != 0)
+    {
+      return GetImpl ()->GetCancelledEventCount ();
+    }
+  else
+    {
+      return 0;
+    }
+}
+
+uint64_t
+Simulator::GetCompactedEventCount (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  if (*PeekImpl () != 0)
+    {
+      return GetImpl ()->GetCompactedEventCount ();
+    }
+  else
+    {
+      return 0;
+    }
+}
+
 void
 Simulator::SetImplementation (Ptr<SimulatorImpl> impl)
 {
@@ -1160,6 +1160,41 @@ public:
    * @return The system id for this simulator.
    */
   static uint32_t GetSystemId (void);
+
+  /**
+   * Get the number of events executed so far, not counting the
+   * cancelled events.
+   *
+   * @return The number of events executed.
+   */
+  static uint64_t GetEventCount (void);
+
+  /**
+   * Get the number of events in the event list, including the
+   * cancelled events which have not been removed yet.
+   *
+   * @return The number of pending events.
+   */
+  static uint32_t GetPendingEventCount (void);
+
+  /**
+   * Get the number of cancelled events still in the event list.
+   *
+   * Cancelling an event only marks it: it stays in the event list until
+   * its timestamp is reached, or until the cancelled events are removed
+   * all at once, when they make up a large fraction of the event list.
+   *
+   * @return The number of cancelled events in the event list.
+   */
+  static uint32_t GetCancelledEventCount (void);
+
+  /**
+   * Get the number of cancelled events removed from the event list
+   * before their timestamp was reached.
+   *
+   * @return The number of cancelled events removed.
+   */
+  static uint64_t GetCompactedEventCount (void);
   
 private:
   /** Default constructor. */
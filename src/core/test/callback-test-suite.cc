@@ -557,6 +557,100 @@ NullifyCallbackTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (target1.IsNull (), true, "Nullified Callback reports not IsNull()");
 }
 
+// ===========================================================================
+// Test the callbacks stored inline, without a heap allocation
+// ===========================================================================
+class InlineCallbackTestCase : public TestCase
+{
+public:
+  InlineCallbackTestCase ();
+  virtual ~InlineCallbackTestCase () {}
+
+  int Target1 (int a) { return a + 1; }
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \param [in] cb The callback.
+   * \returns \c true if the implementation is stored inside \p cb.
+   */
+  static bool IsInline (const CallbackBase &cb);
+};
+
+class InlineCallbackTarget : public SimpleRefCount<InlineCallbackTarget>
+{
+public:
+  int Target (int a) { return a + 2; }
+};
+
+static int
+InlineCallbackTarget2 (double a, int b)
+{
+  return static_cast<int> (a) + b;
+}
+
+InlineCallbackTestCase::InlineCallbackTestCase ()
+  : TestCase ("Check the callbacks stored inline")
+{
+}
+
+bool
+InlineCallbackTestCase::IsInline (const CallbackBase &cb)
+{
+  const char *impl = reinterpret_cast<const char *> (cb.PeekImpl ());
+  const char *base = reinterpret_cast<const char *> (&cb);
+  return impl >= base && impl < base + sizeof (cb);
+}
+
+void
+InlineCallbackTestCase::DoRun (void)
+{
+  Callback<int, int> target1 = MakeCallback (&InlineCallbackTestCase::Target1, this);
+  NS_TEST_ASSERT_MSG_EQ (IsInline (target1), true, "Member function of a raw pointer not inline");
+  NS_TEST_ASSERT_MSG_EQ (target1 (1), 2, "Inline callback did not fire");
+
+  Callback<int, int> copy = target1;
+  NS_TEST_ASSERT_MSG_EQ (IsInline (copy), true, "Copy not inline");
+  NS_TEST_ASSERT_MSG_EQ (copy (2), 3, "Copy did not fire");
+  NS_TEST_ASSERT_MSG_EQ (copy.IsEqual (target1), true, "Copy not equal");
+
+  // the heap copy returned by GetImpl is equal, and usable
+  typedef CallbackImpl<int, int, empty, empty, empty, empty, empty, empty, empty, empty> Impl;
+  Callback<int, int> heap (DynamicCast<Impl> (target1.GetImpl ()));
+  NS_TEST_ASSERT_MSG_EQ (IsInline (heap), false, "Callback built from a Ptr is inline");
+  NS_TEST_ASSERT_MSG_EQ (heap.IsEqual (target1), true, "Heap copy not equal");
+  NS_TEST_ASSERT_MSG_EQ (target1.IsEqual (heap), true, "Heap copy not equal");
+  NS_TEST_ASSERT_MSG_EQ (heap (3), 4, "Heap copy did not fire");
+
+  // the objects held by a Ptr are not trivial
+  Ptr<InlineCallbackTarget> object = Create<InlineCallbackTarget> ();
+  Callback<int, int> target2 = MakeCallback (&InlineCallbackTarget::Target, object);
+  NS_TEST_ASSERT_MSG_EQ (IsInline (target2), false, "Member function of a Ptr inline");
+  NS_TEST_ASSERT_MSG_EQ (object->GetReferenceCount (), 2, "Ptr not held by the callback");
+  NS_TEST_ASSERT_MSG_EQ (target2 (1), 3, "Heap callback did not fire");
+  NS_TEST_ASSERT_MSG_EQ (target2.IsEqual (target1), false, "Different callbacks equal");
+
+  // Assign from a CallbackBase keeps the implementation inline
+  const CallbackBase &base = target1;
+  Callback<int, int> assigned;
+  NS_TEST_ASSERT_MSG_EQ (assigned.Assign (base), true, "Assign failed");
+  NS_TEST_ASSERT_MSG_EQ (IsInline (assigned), true, "Assigned callback not inline");
+  NS_TEST_ASSERT_MSG_EQ (assigned (4), 5, "Assigned callback did not fire");
+  assigned = target2;
+  NS_TEST_ASSERT_MSG_EQ (IsInline (assigned), false, "Assigned callback inline");
+  NS_TEST_ASSERT_MSG_EQ (assigned (4), 6, "Assigned callback did not fire");
+  assigned.Nullify ();
+  NS_TEST_ASSERT_MSG_EQ (assigned.IsNull (), true, "Nullified callback not null");
+
+  Callback<int> bound = MakeBoundCallback (&InlineCallbackTarget2, 1.5, 2);
+  NS_TEST_ASSERT_MSG_EQ (IsInline (bound), true, "Bound arithmetic arguments not inline");
+  NS_TEST_ASSERT_MSG_EQ (bound (), 3, "Bound callback did not fire");
+  Callback<int, int> bound1 = MakeBoundCallback (&InlineCallbackTarget2, 1.5);
+  NS_TEST_ASSERT_MSG_EQ (IsInline (bound1), true, "Bound argument not inline");
+  NS_TEST_ASSERT_MSG_EQ (bound1 (5), 6, "Bound callback did not fire");
+}
+
 // ===========================================================================
 // Make sure that various MakeCallback template functions compile and execute.
 // Doesn't check an results of the execution.
@@ -704,6 +798,7 @@ CallbackTestSuite::CallbackTestSuite ()
   AddTestCase (new MakeCallbackTestCase, TestCase::QUICK);
   AddTestCase (new MakeBoundCallbackTestCase, TestCase::QUICK);
   AddTestCase (new NullifyCallbackTestCase, TestCase::QUICK);
+  AddTestCase (new InlineCallbackTestCase, TestCase::QUICK);
   AddTestCase (new MakeCallbackTemplatesTestCase, TestCase::QUICK);
 }
 
@@ -0,0 +1,108 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/checkpoint.h"
+#include "ns3/simulator.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-stream.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/test.h"
+#include <unistd.h>
+
+using namespace ns3;
+
+/*
+ * The variants cannot report through the test framework of the
+ * parent: each one checks its state, and exits with a non-zero
+ * status if it is wrong, which the parent counts.
+ */
+class CheckpointTestCase : public TestCase
+{
+public:
+  CheckpointTestCase ();
+  virtual void DoRun (void);
+  /** Event counting the events before and after the fork. */
+  void Count (void);
+  /** Event forking the variants. */
+  void StartVariants (void);
+  uint32_t m_variant;    //!< The variant, or Checkpoint::PARENT
+  uint32_t m_count;      //!< The number of Count events
+  double m_value;        //!< The first value drawn after the fork
+  Ptr<UniformRandomVariable> m_random;  //!< The random variable
+};
+
+CheckpointTestCase::CheckpointTestCase ()
+  : TestCase ("Check that the variants continue the simulation")
+{
+}
+
+void
+CheckpointTestCase::Count (void)
+{
+  m_count++;
+}
+
+void
+CheckpointTestCase::StartVariants (void)
+{
+  m_variant = Checkpoint::Fork (4, 2);
+  if (m_variant != Checkpoint::PARENT)
+    {
+      RandomVariableStream::AdvanceAllSubstreams (m_variant);
+      m_value = m_random->GetValue ();
+    }
+}
+
+void
+CheckpointTestCase::DoRun (void)
+{
+  m_variant = Checkpoint::PARENT;
+  m_count = 0;
+  m_value = -1;
+  m_random = CreateObject<UniformRandomVariable> ();
+  m_random->SetStream (12);
+  Simulator::Schedule (Seconds (1), &CheckpointTestCase::Count, this);
+  Simulator::Schedule (Seconds (2), &CheckpointTestCase::StartVariants, this);
+  Simulator::Schedule (Seconds (3), &CheckpointTestCase::Count, this);
+  Simulator::Run ();
+
+  if (m_variant != Checkpoint::PARENT)
+    {
+      RngStream expected (RngSeedManager::GetSeed (), (1ULL << 63) + 12, RngSeedManager::GetRun ());
+      expected.AdvanceSubstreams (m_variant);
+      bool ok = m_count == 2
+        && Simulator::Now () == Seconds (3)
+        && m_value == expected.RandU01 ();
+      // the last variant fails on purpose
+      _exit (ok && m_variant != 3 ? 0 : 1);
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (m_count, 1, "The parent did not stop at the fork");
+  NS_TEST_ASSERT_MSG_EQ (Simulator::Now (), Seconds (2), "The parent did not stop at the fork");
+  NS_TEST_ASSERT_MSG_EQ (Checkpoint::GetFailures (), 1, "A variant did not continue the simulation");
+  Simulator::Destroy ();
+  m_random = 0;
+}
+
+static class CheckpointTestSuite : public TestSuite
+{
+public:
+  CheckpointTestSuite ()
+    : TestSuite ("checkpoint", UNIT)
+  {
+    AddTestCase (new CheckpointTestCase (), TestCase::QUICK);
+  }
+} g_checkpointTestSuite;
@@ -27,9 +27,11 @@
 #include "ns3/singleton.h"
 #include "ns3/object.h"
 #include "ns3/object-vector.h"
+#include "ns3/object-map.h"
 #include "ns3/names.h"
 #include "ns3/pointer.h"
 #include "ns3/log.h"
+#include "ns3/simulator.h"
 
 
 #include <sstream>
@@ -46,6 +48,7 @@ public:
 
   void AddNodeA (Ptr<ConfigTestObject> a);
   void AddNodeB (Ptr<ConfigTestObject> b);
+  void AddMapA (uint32_t key, Ptr<ConfigTestObject> a);
 
   void SetNodeA (Ptr<ConfigTestObject> a);
   void SetNodeB (Ptr<ConfigTestObject> b);
@@ -56,6 +59,7 @@ public:
 private:
   std::vector<Ptr<ConfigTestObject> > m_nodesA;
   std::vector<Ptr<ConfigTestObject> > m_nodesB;
+  std::map<uint32_t, Ptr<ConfigTestObject> > m_mapA;
   Ptr<ConfigTestObject> m_nodeA;
   Ptr<ConfigTestObject> m_nodeB;
   int8_t m_a;
@@ -76,6 +80,10 @@ ConfigTestObject::GetTypeId (void)
                    ObjectVectorValue (),
                    MakeObjectVectorAccessor (&ConfigTestObject::m_nodesB),
                    MakeObjectVectorChecker<ConfigTestObject> ())
+    .AddAttribute ("MapA", "",
+                   ObjectMapValue (),
+                   MakeObjectMapAccessor (&ConfigTestObject::m_mapA),
+                   MakeObjectMapChecker<ConfigTestObject> ())
     .AddAttribute ("NodeA", "",
                    PointerValue (),
                    MakePointerAccessor (&ConfigTestObject::m_nodeA),
@@ -127,6 +135,12 @@ ConfigTestObject::AddNodeB (Ptr<ConfigTestObject> b)
   m_nodesB.push_back (b);
 }
 
+void
+ConfigTestObject::AddMapA (uint32_t key, Ptr<ConfigTestObject> a)
+{
+  m_mapA[key] = a;
+}
+
 int8_t 
 ConfigTestObject::GetA (void) const
 {
@@ -721,6 +735,143 @@ SearchAttributesOfParentObjectsTestCase::DoRun (void)
 
 }
 
+// ===========================================================================
+// Test the lookup of the entries of a vector and the cache of the matches.
+// ===========================================================================
+class MatchCacheConfigTestCase : public TestCase
+{
+public:
+  MatchCacheConfigTestCase ();
+  virtual ~MatchCacheConfigTestCase () {}
+
+private:
+  virtual void DoRun (void);
+};
+
+MatchCacheConfigTestCase::MatchCacheConfigTestCase ()
+  : TestCase ("Check the lookup of vector entries and the cache of the matches")
+{
+}
+
+void
+MatchCacheConfigTestCase::DoRun (void)
+{
+  Ptr<ConfigTestObject> root = CreateObject<ConfigTestObject> ();
+  Config::RegisterRootNamespaceObject (root);
+  Ptr<ConfigTestObject> a = CreateObject<ConfigTestObject> ();
+  root->SetNodeB (a);
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      a->AddNodeA (CreateObject<ConfigTestObject> ());
+    }
+
+  //
+  // A few entries of the vector are looked up one by one, in increasing
+  // order and only once.
+  //
+  Config::MatchContainer matches = Config::LookupMatches ("/NodeB/NodesA/7|[2-4]|3");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 4, "Unexpected number of matches");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetMatchedPath (0), "/NodeB/NodesA/2/", "Unexpected match");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetMatchedPath (1), "/NodeB/NodesA/3/", "Unexpected match");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetMatchedPath (2), "/NodeB/NodesA/4/", "Unexpected match");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetMatchedPath (3), "/NodeB/NodesA/7/", "Unexpected match");
+  matches = Config::LookupMatches ("/NodeB/NodesA/[8-20]|12");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 2, "Unexpected number of matches");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetMatchedPath (1), "/NodeB/NodesA/9/", "Unexpected match");
+
+  //
+  // While the cache is enabled, the matches of a path are not updated...
+  //
+  Config::EnableMatchCache ();
+  matches = Config::LookupMatches ("/NodeB/NodesA/*");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 10, "Unexpected number of matches");
+  Ptr<ConfigTestObject> added = CreateObject<ConfigTestObject> ();
+  a->AddNodeA (added);
+  matches = Config::LookupMatches ("/NodeB/NodesA/*");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 10, "Matches not cached");
+  Config::Set ("/NodeB/NodesA/*/A", IntegerValue (3));
+  IntegerValue iv;
+  added->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), 10, "Object Attribute \"A\" unexpectedly set");
+
+  //
+  // ... until it is cleared.
+  //
+  Config::EnableMatchCache ();
+  matches = Config::LookupMatches ("/NodeB/NodesA/*");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 11, "Matches not updated");
+  Config::DisableMatchCache ();
+  a->AddNodeA (CreateObject<ConfigTestObject> ());
+  matches = Config::LookupMatches ("/NodeB/NodesA/*");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 12, "Matches unexpectedly cached");
+
+  Config::UnregisterRootNamespaceObject (root);
+  Simulator::Destroy ();
+}
+
+// ===========================================================================
+// Test the lookup of the entries of a map, whose keys are not the
+// positions of the entries.
+// ===========================================================================
+class ObjectMapConfigTestCase : public TestCase
+{
+public:
+  ObjectMapConfigTestCase ();
+  virtual ~ObjectMapConfigTestCase () {}
+
+private:
+  virtual void DoRun (void);
+};
+
+ObjectMapConfigTestCase::ObjectMapConfigTestCase ()
+  : TestCase ("Check the lookup of map entries with sparse keys")
+{
+}
+
+void
+ObjectMapConfigTestCase::DoRun (void)
+{
+  Ptr<ConfigTestObject> root = CreateObject<ConfigTestObject> ();
+  Config::RegisterRootNamespaceObject (root);
+  Ptr<ConfigTestObject> a = CreateObject<ConfigTestObject> ();
+  root->SetNodeB (a);
+  Ptr<ConfigTestObject> entry = CreateObject<ConfigTestObject> ();
+  a->AddMapA (1, CreateObject<ConfigTestObject> ());
+  a->AddMapA (5, CreateObject<ConfigTestObject> ());
+  a->AddMapA (20, entry);
+
+  //
+  // The keys 5 and 20 are larger than the number of entries, the key 1 is
+  // not at position 1.
+  //
+  Config::MatchContainer matches = Config::LookupMatches ("/NodeB/MapA/20");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 1, "Unexpected number of matches");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetMatchedPath (0), "/NodeB/MapA/20/", "Unexpected match");
+  NS_TEST_ASSERT_MSG_EQ (matches.Get (0), entry, "Unexpected object");
+  matches = Config::LookupMatches ("/NodeB/MapA/5");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 1, "Unexpected number of matches");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetMatchedPath (0), "/NodeB/MapA/5/", "Unexpected match");
+  matches = Config::LookupMatches ("/NodeB/MapA/1");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 1, "Unexpected number of matches");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetMatchedPath (0), "/NodeB/MapA/1/", "Unexpected match");
+  matches = Config::LookupMatches ("/NodeB/MapA/0|2");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 0, "Unexpected number of matches");
+  matches = Config::LookupMatches ("/NodeB/MapA/[2-20]");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 2, "Unexpected number of matches");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetMatchedPath (0), "/NodeB/MapA/5/", "Unexpected match");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetMatchedPath (1), "/NodeB/MapA/20/", "Unexpected match");
+  matches = Config::LookupMatches ("/NodeB/MapA/*");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 3, "Unexpected number of matches");
+
+  Config::Set ("/NodeB/MapA/20/A", IntegerValue (3));
+  IntegerValue iv;
+  entry->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), 3, "Object Attribute \"A\" not set through the map");
+
+  Config::UnregisterRootNamespaceObject (root);
+  Simulator::Destroy ();
+}
+
 // ===========================================================================
 // The Test Suite that glues all of the Test Cases together.
 // ===========================================================================
@@ -737,6 +888,8 @@ ConfigTestSuite::ConfigTestSuite ()
   AddTestCase (new UnderRootNamespaceConfigTestCase, TestCase::QUICK);
   AddTestCase (new ObjectVectorConfigTestCase, TestCase::QUICK);
   AddTestCase (new SearchAttributesOfParentObjectsTestCase, TestCase::QUICK);
+  AddTestCase (new MatchCacheConfigTestCase, TestCase::QUICK);
+  AddTestCase (new ObjectMapConfigTestCase, TestCase::QUICK);
 }
 
 static ConfigTestSuite configTestSuite;
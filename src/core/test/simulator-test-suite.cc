@@ -23,6 +23,17 @@
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/config.h"
+#include "ns3/boolean.h"
+#include "ns3/string.h"
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <set>
+#include <vector>
 
 using namespace ns3;
 
@@ -459,6 +470,270 @@ SimulatorTemplateTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class SchedulerOrderTestCase : public TestCase
+{
+public:
+  SchedulerOrderTestCase (ObjectFactory schedulerFactory, std::string distribution);
+  virtual void DoRun (void);
+private:
+  uint64_t GetDelay (void);
+  ObjectFactory m_schedulerFactory;
+  std::string m_distribution;
+  Ptr<UniformRandomVariable> m_uv;
+};
+
+SchedulerOrderTestCase::SchedulerOrderTestCase (ObjectFactory schedulerFactory, std::string distribution)
+  : TestCase ("Check the order of " + distribution + " events in " +
+              schedulerFactory.GetTypeId ().GetName () + " against ns3::MapScheduler"),
+    m_schedulerFactory (schedulerFactory),
+    m_distribution (distribution)
+{
+}
+
+uint64_t
+SchedulerOrderTestCase::GetDelay (void)
+{
+  if (m_distribution == "exponential")
+    {
+      return (uint64_t) (-100 * std::log (1 - m_uv->GetValue ()));
+    }
+  else if (m_distribution == "uniform")
+    {
+      return m_uv->GetInteger (0, 200);
+    }
+  else if (m_distribution == "bimodal")
+    {
+      return m_uv->GetValue () < 0.9 ? m_uv->GetInteger (0, 20) : m_uv->GetInteger (100000, 200000);
+    }
+  // many events with the same timestamp
+  return m_uv->GetInteger (0, 1) * 1000;
+}
+
+void
+SchedulerOrderTestCase::DoRun (void)
+{
+  m_uv = CreateObject<UniformRandomVariable> ();
+  m_uv->SetStream (1);
+  Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler> ();
+  Ptr<Scheduler> reference = CreateObject<MapScheduler> ();
+  std::vector<Scheduler::Event> inserted;
+  std::set<uint32_t> pending;
+  uint64_t now = 0;
+  uint32_t uid = 0;
+  bool ok = true;
+
+  for (uint32_t i = 0; i < 60000 && ok; i++)
+    {
+      // grow the population during the first half, then keep it steady
+      uint32_t nInsert = i < 20000 ? 2 : 1;
+      for (uint32_t j = 0; j < nInsert; j++)
+        {
+          Scheduler::Event ev;
+          ev.impl = 0;
+          ev.key.m_ts = now + GetDelay ();
+          ev.key.m_uid = uid++;
+          ev.key.m_context = 0;
+          scheduler->Insert (ev);
+          reference->Insert (ev);
+          inserted.push_back (ev);
+          pending.insert (ev.key.m_uid);
+        }
+      if (m_uv->GetValue () < 0.1)
+        {
+          // cancel a random pending event
+          Scheduler::Event ev = inserted[m_uv->GetInteger (0, inserted.size () - 1)];
+          if (pending.erase (ev.key.m_uid) == 1)
+            {
+              scheduler->Remove (ev);
+              reference->Remove (ev);
+            }
+        }
+      Scheduler::Event next = scheduler->RemoveNext ();
+      Scheduler::Event expected = reference->RemoveNext ();
+      ok = next.key.m_uid == expected.key.m_uid && next.key.m_ts == expected.key.m_ts;
+      pending.erase (next.key.m_uid);
+      now = next.key.m_ts;
+    }
+  NS_TEST_EXPECT_MSG_EQ (ok, true, "Events removed out of order");
+  while (ok && !reference->IsEmpty ())
+    {
+      NS_TEST_ASSERT_MSG_EQ (scheduler->IsEmpty (), false, "Events have been lost");
+      ok = scheduler->RemoveNext ().key.m_uid == reference->RemoveNext ().key.m_uid;
+    }
+  NS_TEST_EXPECT_MSG_EQ (ok, true, "Events removed out of order while emptying the scheduler");
+  NS_TEST_EXPECT_MSG_EQ (scheduler->IsEmpty (), true, "The scheduler should be empty");
+}
+
+class SimulatorEventPoolTestCase : public TestCase
+{
+public:
+  SimulatorEventPoolTestCase ();
+  virtual void DoRun (void);
+private:
+  void Event (uint32_t i);
+  void Run (uint32_t n);
+  uint32_t m_count;
+};
+
+SimulatorEventPoolTestCase::SimulatorEventPoolTestCase ()
+  : TestCase ("Check that the events are recycled by the event allocator")
+{
+}
+
+void
+SimulatorEventPoolTestCase::Event (uint32_t i)
+{
+  m_count++;
+}
+
+void
+SimulatorEventPoolTestCase::Run (uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Simulator::Schedule (MicroSeconds (i), &SimulatorEventPoolTestCase::Event, this, i);
+    }
+  Simulator::Run ();
+}
+
+void
+SimulatorEventPoolTestCase::DoRun (void)
+{
+  m_count = 0;
+  Run (1000);
+  EventImpl::PoolStats before = EventImpl::GetPoolStats ();
+  Run (1000);
+  EventImpl::PoolStats after = EventImpl::GetPoolStats ();
+  NS_TEST_EXPECT_MSG_EQ (m_count, 2000, "Events have been lost");
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (after.hits - before.hits, 1000, "The events of the second run should reuse the released ones");
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (after.recycled - before.recycled, 1000, "The events should be released to the free lists");
+
+  EventImpl::SetPoolEnabled (false);
+  Run (1000);
+  EventImpl::PoolStats disabled = EventImpl::GetPoolStats ();
+  EventImpl::SetPoolEnabled (true);
+  NS_TEST_EXPECT_MSG_EQ (m_count, 3000, "Events have been lost");
+  NS_TEST_EXPECT_MSG_EQ (disabled.hits, after.hits, "The free lists should not be used when disabled");
+  NS_TEST_EXPECT_MSG_EQ (disabled.recycled, after.recycled, "The free lists should not be used when disabled");
+  Simulator::Destroy ();
+}
+
+class SimulatorCancelledEventsTestCase : public TestCase
+{
+public:
+  SimulatorCancelledEventsTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+private:
+  void Event (uint32_t i);
+  ObjectFactory m_schedulerFactory;
+  uint32_t m_count;
+  bool m_ok;
+  Time m_last;
+};
+
+SimulatorCancelledEventsTestCase::SimulatorCancelledEventsTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check that the cancelled events are removed from " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+
+void
+SimulatorCancelledEventsTestCase::Event (uint32_t i)
+{
+  m_count++;
+  m_ok = m_ok && i % 3 == 0 && Simulator::Now () >= m_last;
+  m_last = Simulator::Now ();
+}
+
+void
+SimulatorCancelledEventsTestCase::DoRun (void)
+{
+  const uint32_t n = 3000;
+  m_count = 0;
+  m_ok = true;
+  m_last = Seconds (0);
+  Simulator::SetScheduler (m_schedulerFactory);
+  std::vector<EventId> events;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      events.push_back (Simulator::Schedule (MicroSeconds ((i * 7) % n), &SimulatorCancelledEventsTestCase::Event, this, i));
+    }
+  for (uint32_t i = 0; i < n; i++)
+    {
+      if (i % 3 != 0)
+        {
+          events[i].Cancel ();
+        }
+    }
+  uint64_t compacted = Simulator::GetCompactedEventCount ();
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (compacted, 1024, "The cancelled events should have been removed");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetCancelledEventCount (), 2000 - compacted, "Wrong number of cancelled events");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetPendingEventCount (), n - compacted, "Wrong number of pending events");
+  NS_TEST_EXPECT_MSG_EQ (events[1].IsExpired (), true, "A cancelled event should be expired");
+
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_ok, true, "Cancelled event executed or events out of order");
+  NS_TEST_EXPECT_MSG_EQ (m_count, 1000, "Events have been lost");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetEventCount (), 1000, "Wrong number of events executed");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetCancelledEventCount (), 0, "Cancelled events left");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetPendingEventCount (), 0, "Events left");
+  Simulator::Destroy ();
+}
+
+class SimulatorEventProfilerTestCase : public TestCase
+{
+public:
+  SimulatorEventProfilerTestCase ();
+  virtual void DoRun (void);
+private:
+  void Event (uint32_t i);
+  void OtherEvent (void);
+};
+
+SimulatorEventProfilerTestCase::SimulatorEventProfilerTestCase ()
+  : TestCase ("Check that the event profile is reported at Simulator::Destroy")
+{
+}
+
+void
+SimulatorEventProfilerTestCase::Event (uint32_t i)
+{
+}
+
+void
+SimulatorEventProfilerTestCase::OtherEvent (void)
+{
+}
+
+void
+SimulatorEventProfilerTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("event-profile.txt");
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::EventProfiling", BooleanValue (true));
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::EventProfileOutput", StringValue (filename));
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      Simulator::ScheduleWithContext (i % 2, MicroSeconds (i), &SimulatorEventProfilerTestCase::Event, this, i);
+    }
+  Simulator::Schedule (MicroSeconds (20), &SimulatorEventProfilerTestCase::OtherEvent, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::EventProfiling", BooleanValue (false));
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::EventProfileOutput", StringValue (""));
+
+  std::ifstream is (filename.c_str ());
+  std::ostringstream report;
+  report << is.rdbuf ();
+  std::string profile = report.str ();
+  NS_TEST_EXPECT_MSG_NE (profile.find ("Event profile: 11 events"), std::string::npos, "Wrong number of events in " << profile);
+  NS_TEST_EXPECT_MSG_NE (profile.find ("void (SimulatorEventProfilerTestCase::*)(unsigned int), SimulatorEventProfilerTestCase*, unsigned int"), std::string::npos,
+                         "Event type not found in " << profile);
+  NS_TEST_EXPECT_MSG_NE (profile.find ("void (SimulatorEventProfilerTestCase::*)(), SimulatorEventProfilerTestCase*"), std::string::npos,
+                         "Event type not found in " << profile);
+  NS_TEST_EXPECT_MSG_NE (profile.find ("  none\n"), std::string::npos, "Events without context not found in " << profile);
+}
+
 class SimulatorTestSuite : public TestSuite
 {
 public:
@@ -475,5 +750,30 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+
+    AddTestCase (new SimulatorEventPoolTestCase (), TestCase::QUICK);
+    AddTestCase (new SimulatorEventProfilerTestCase (), TestCase::QUICK);
+
+    factory.SetTypeId (ListScheduler::GetTypeId ());
+    AddTestCase (new SimulatorCancelledEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (MapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorCancelledEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (HeapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorCancelledEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (CalendarScheduler::GetTypeId ());
+    AddTestCase (new SimulatorCancelledEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorCancelledEventsTestCase (factory), TestCase::QUICK);
+
+    std::string distributions[] = { "exponential", "uniform", "bimodal", "simultaneous" };
+    for (unsigned int i = 0; i < (sizeof (distributions) / sizeof (distributions[0])); ++i)
+      {
+        factory.SetTypeId (HeapScheduler::GetTypeId ());
+        AddTestCase (new SchedulerOrderTestCase (factory, distributions[i]), TestCase::QUICK);
+        factory.SetTypeId (LadderScheduler::GetTypeId ());
+        AddTestCase (new SchedulerOrderTestCase (factory, distributions[i]), TestCase::QUICK);
+      }
   }
 } g_simulatorTestSuite;
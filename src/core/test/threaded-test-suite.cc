@@ -23,6 +23,7 @@
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/ladder-scheduler.h"
 #include "ns3/config.h"
 #include "ns3/string.h"
 #include "ns3/system-thread.h"
@@ -225,6 +226,94 @@ ThreadedSimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_a, m_d, "Bad scheduling");
 }
 
+class ThreadedSimulatorOrderTestCase : public TestCase
+{
+public:
+  ThreadedSimulatorOrderTestCase (unsigned int threads, unsigned int events);
+  static void SchedulingThread (std::pair<ThreadedSimulatorOrderTestCase *, unsigned int> context);
+  void Receive (unsigned int threadno, unsigned int seq);
+  void Poll (void);
+  unsigned int m_threads;
+  unsigned int m_events;
+  unsigned int m_next[MAXTHREADS];
+  uint64_t m_received;
+  std::string m_error;
+
+private:
+  virtual void DoRun (void);
+};
+
+ThreadedSimulatorOrderTestCase::ThreadedSimulatorOrderTestCase (unsigned int threads, unsigned int events)
+  : TestCase ("Check that the events scheduled by other threads are neither lost nor reordered"),
+    m_threads (threads),
+    m_events (events),
+    m_received (0)
+{
+}
+
+void
+ThreadedSimulatorOrderTestCase::SchedulingThread (std::pair<ThreadedSimulatorOrderTestCase *, unsigned int> context)
+{
+  ThreadedSimulatorOrderTestCase *me = context.first;
+  unsigned int threadno = context.second;
+
+  for (unsigned int i = 0; i < me->m_events; ++i)
+    {
+      Simulator::ScheduleWithContext (threadno, Seconds (0),
+                                      &ThreadedSimulatorOrderTestCase::Receive, me, threadno, i);
+    }
+}
+
+void
+ThreadedSimulatorOrderTestCase::Receive (unsigned int threadno, unsigned int seq)
+{
+  if (seq != m_next[threadno] || Simulator::GetContext () != threadno)
+    {
+      m_error = "Bad event order";
+    }
+  m_next[threadno] = seq + 1;
+  ++m_received;
+}
+
+void
+ThreadedSimulatorOrderTestCase::Poll (void)
+{
+  // keep the simulation alive until all the events have been received
+  if (m_received < uint64_t (m_threads) * m_events)
+    {
+      Simulator::Schedule (MicroSeconds (1), &ThreadedSimulatorOrderTestCase::Poll, this);
+    }
+}
+
+void
+ThreadedSimulatorOrderTestCase::DoRun (void)
+{
+  std::list<Ptr<SystemThread> > threadlist;
+  for (unsigned int i = 0; i < m_threads; ++i)
+    {
+      m_next[i] = 0;
+      threadlist.push_back (
+        Create<SystemThread> (MakeBoundCallback (
+            &ThreadedSimulatorOrderTestCase::SchedulingThread,
+                std::pair<ThreadedSimulatorOrderTestCase *, unsigned int>(this,i) )) );
+    }
+
+  Simulator::Schedule (MicroSeconds (1), &ThreadedSimulatorOrderTestCase::Poll, this);
+  for (std::list<Ptr<SystemThread> >::iterator it = threadlist.begin (); it != threadlist.end (); ++it)
+    {
+      (*it)->Start ();
+    }
+  Simulator::Run ();
+  for (std::list<Ptr<SystemThread> >::iterator it = threadlist.begin (); it != threadlist.end (); ++it)
+    {
+      (*it)->Join ();
+    }
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_error.empty (), true, m_error.c_str ());
+  NS_TEST_EXPECT_MSG_EQ (m_received, uint64_t (m_threads) * m_events, "Events have been lost");
+}
+
 class ThreadedSimulatorTestSuite : public TestSuite
 {
 public:
@@ -241,7 +330,8 @@ public:
       "ns3::ListScheduler",
       "ns3::HeapScheduler",
       "ns3::MapScheduler",
-      "ns3::CalendarScheduler"
+      "ns3::CalendarScheduler",
+      "ns3::LadderScheduler"
     };
     unsigned int threadcounts[] = {
       0,
@@ -262,5 +352,6 @@ public:
               }
           }
       }
+    AddTestCase (new ThreadedSimulatorOrderTestCase (8, 10000), TestCase::QUICK);
   }
 } g_threadedSimulatorTestSuite;
@@ -62,6 +62,7 @@ BasicTracedCallbackTestCase::DoRun (void)
   // these methods do is to set corresponding member variables m_one and m_two.
   //
   TracedCallback<uint8_t, double> trace;
+  NS_TEST_ASSERT_MSG_EQ (trace.IsEmpty (), true, "No callback connected yet");
 
   //
   // Connect both callbacks to their respective test methods.  If we hit the 
@@ -70,6 +71,7 @@ BasicTracedCallbackTestCase::DoRun (void)
   //
   trace.ConnectWithoutContext (MakeCallback (&BasicTracedCallbackTestCase::CbOne, this));
   trace.ConnectWithoutContext (MakeCallback (&BasicTracedCallbackTestCase::CbTwo, this));
+  NS_TEST_ASSERT_MSG_EQ (trace.IsEmpty (), false, "Callbacks connected");
   m_one = false;
   m_two = false;
   trace (1, 2);
@@ -95,6 +97,7 @@ BasicTracedCallbackTestCase::DoRun (void)
   trace (1, 2);
   NS_TEST_ASSERT_MSG_EQ (m_one, false, "Callback CbOne unexpectedly called");
   NS_TEST_ASSERT_MSG_EQ (m_two, false, "Callback CbTwo unexpectedly called");
+  NS_TEST_ASSERT_MSG_EQ (trace.IsEmpty (), true, "All callbacks disconnected");
 
   //
   // If we connect them back up, then both callbacks should be called.
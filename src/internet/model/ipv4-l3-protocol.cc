@@ -567,7 +567,10 @@ Ipv4L3Protocol::Receive ( Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t p
 
   if (ipv4Interface->IsUp ())
     {
-      m_rxTrace (packet, m_node->GetObject<Ipv4> (), interface);
+      if (!m_rxTrace.IsEmpty ())
+        {
+          m_rxTrace (packet, m_node->GetObject<Ipv4> (), interface);
+        }
     }
   else
     {
@@ -684,11 +687,15 @@ Ipv4L3Protocol::SendWithHeader (Ptr<Packet> packet,
 
 void
 Ipv4L3Protocol::CallTxTrace (const Ipv4Header & ipHeader, Ptr<Packet> packet,
-                                    Ptr<Ipv4> ipv4, uint32_t interface)
+                             uint32_t interface)
 {
+  if (m_txTrace.IsEmpty ())
+    {
+      return;
+    }
   Ptr<Packet> packetCopy = packet->Copy ();
   packetCopy->AddHeader (ipHeader);
-  m_txTrace (packetCopy, ipv4, interface);
+  m_txTrace (packetCopy, m_node->GetObject<Ipv4> (), interface);
 }
 
 void 
@@ -754,7 +761,7 @@ Ipv4L3Protocol::Send (Ptr<Packet> packet,
               NS_ASSERT (packetCopy->GetSize () <= outInterface->GetDevice ()->GetMtu ());
 
               m_sendOutgoingTrace (ipHeader, packetCopy, ifaceIndex);
-              CallTxTrace (ipHeader, packetCopy, m_node->GetObject<Ipv4> (), ifaceIndex);
+              CallTxTrace (ipHeader, packetCopy, ifaceIndex);
               outInterface->Send (packetCopy, ipHeader, destination);
             }
         }
@@ -778,7 +785,7 @@ Ipv4L3Protocol::Send (Ptr<Packet> packet,
               ipHeader = BuildHeader (source, destination, protocol, packet->GetSize (), ttl, tos, mayFragment);
               Ptr<Packet> packetCopy = packet->Copy ();
               m_sendOutgoingTrace (ipHeader, packetCopy, ifaceIndex);
-              CallTxTrace (ipHeader, packetCopy, m_node->GetObject<Ipv4> (), ifaceIndex);
+              CallTxTrace (ipHeader, packetCopy, ifaceIndex);
               outInterface->Send (packetCopy, ipHeader, destination);
               return;
             }
@@ -911,13 +918,13 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
               DoFragmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments);
               for ( std::list<Ipv4PayloadHeaderPair>::iterator it = listFragments.begin (); it != listFragments.end (); it++ )
                 {
-                  CallTxTrace (it->second, it->first, m_node->GetObject<Ipv4> (), interface);
+                  CallTxTrace (it->second, it->first, interface);
                   outInterface->Send (it->first, it->second, route->GetGateway ());
                 }
             }
           else
             {
-              CallTxTrace (ipHeader, packet, m_node->GetObject<Ipv4> (), interface);
+              CallTxTrace (ipHeader, packet, interface);
               outInterface->Send (packet, ipHeader, route->GetGateway ());
             }
         }
@@ -939,13 +946,13 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
               for ( std::list<Ipv4PayloadHeaderPair>::iterator it = listFragments.begin (); it != listFragments.end (); it++ )
                 {
                   NS_LOG_LOGIC ("Sending fragment " << *(it->first) );
-                  CallTxTrace (it->second, it->first, m_node->GetObject<Ipv4> (), interface);
+                  CallTxTrace (it->second, it->first, interface);
                   outInterface->Send (it->first, it->second, ipHeader.GetDestination ());
                 }
             }
           else
             {
-              CallTxTrace (ipHeader, packet, m_node->GetObject<Ipv4> (), interface);
+              CallTxTrace (ipHeader, packet, interface);
               outInterface->Send (packet, ipHeader, ipHeader.GetDestination ());
             }
         }
@@ -22,8 +22,10 @@
 
 #include "ns3/log.h"
 #include "ns3/enum.h"
+#include "ns3/hash.h"
 #include "ipv4-queue-disc-item.h"
 #include "ipv4-packet-filter.h"
+#include <cstring>
 
 namespace ns3 {
 
@@ -190,4 +192,60 @@ PfifoFastIpv4PacketFilter::DscpToBand (Ipv4Header::DscpType dscpType) const
   return band;
 }
 
+// ------------------------------------------------------------------------- //
+
+NS_OBJECT_ENSURE_REGISTERED (SfbIpv4PacketFilter);
+
+TypeId 
+SfbIpv4PacketFilter::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::SfbIpv4PacketFilter")
+    .SetParent<Ipv4PacketFilter> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<SfbIpv4PacketFilter> ()
+  ;
+  return tid;
+}
+
+SfbIpv4PacketFilter::SfbIpv4PacketFilter ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+SfbIpv4PacketFilter::~SfbIpv4PacketFilter()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+int32_t
+SfbIpv4PacketFilter::DoClassify (Ptr<QueueDiscItem> item) const
+{
+  NS_LOG_FUNCTION (this << item);
+  Ptr<Ipv4QueueDiscItem> ipv4Item = DynamicCast<Ipv4QueueDiscItem> (item);
+
+  NS_ASSERT (ipv4Item != 0);
+
+  const Ipv4Header &hdr = ipv4Item->GetHeader ();
+  uint8_t protocol = hdr.GetProtocol ();
+
+  /* source address, destination address, ports and protocol */
+  uint8_t buf[13];
+  hdr.GetSource ().Serialize (buf);
+  hdr.GetDestination ().Serialize (buf + 4);
+  std::memset (buf + 8, 0, 4);
+  buf[12] = protocol;
+
+  /* TCP and UDP headers start with the source and destination ports */
+  if ((protocol == 6 || protocol == 17) && hdr.GetFragmentOffset () == 0
+      && ipv4Item->GetPacket ()->GetSize () >= 4)
+    {
+      ipv4Item->GetPacket ()->CopyData (buf + 8, 4);
+    }
+
+  uint32_t hash = Hash32 (reinterpret_cast<char *> (buf), sizeof (buf));
+  NS_LOG_DEBUG ("Found Ipv4 packet; hash " << hash);
+
+  return hash & 0x7fffffff;
+}
+
 } // namespace ns3
@@ -154,6 +154,31 @@ private:
   Ipv4TrafficClassMode m_trafficClassMode; //!< traffic class mode
 };
 
+
+/**
+ * \ingroup internet
+ *
+ * SfbIpv4PacketFilter is the filter to be added to the SfbQueueDisc to
+ * identify the flows. Packets are classified based on the hash of the
+ * source and destination addresses, the protocol and, for TCP and UDP
+ * packets that are not fragments, the source and destination ports.
+ * The value returned is not negative.
+ */
+class SfbIpv4PacketFilter: public Ipv4PacketFilter {
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  SfbIpv4PacketFilter ();
+  virtual ~SfbIpv4PacketFilter ();
+
+private:
+  virtual int32_t DoClassify (Ptr<QueueDiscItem> item) const;
+};
+
 } // namespace ns3
 
 #endif /* IPV4_PACKET_FILTER */
@@ -22,8 +22,11 @@
 
 #include "ns3/log.h"
 #include "ns3/enum.h"
+#include "ns3/hash.h"
 #include "ipv6-queue-disc-item.h"
 #include "ipv6-packet-filter.h"
+#include <cstring>
+#include <algorithm>
 
 namespace ns3 {
 
@@ -140,4 +143,99 @@ PfifoFastIpv6PacketFilter::DscpToBand (Ipv6Header::DscpType dscpType) const
   return band;
 }
 
+// ------------------------------------------------------------------------- //
+
+NS_OBJECT_ENSURE_REGISTERED (SfbIpv6PacketFilter);
+
+TypeId 
+SfbIpv6PacketFilter::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::SfbIpv6PacketFilter")
+    .SetParent<Ipv6PacketFilter> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<SfbIpv6PacketFilter> ()
+  ;
+  return tid;
+}
+
+SfbIpv6PacketFilter::SfbIpv6PacketFilter ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+SfbIpv6PacketFilter::~SfbIpv6PacketFilter()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+int32_t
+SfbIpv6PacketFilter::DoClassify (Ptr<QueueDiscItem> item) const
+{
+  NS_LOG_FUNCTION (this << item);
+  Ptr<Ipv6QueueDiscItem> ipv6Item = DynamicCast<Ipv6QueueDiscItem> (item);
+
+  NS_ASSERT (ipv6Item != 0);
+
+  const Ipv6Header &hdr = ipv6Item->GetHeader ();
+  uint8_t protocol = hdr.GetNextHeader ();
+
+  /* source address, destination address, ports and upper-layer protocol */
+  uint8_t buf[37];
+  hdr.GetSourceAddress ().Serialize (buf);
+  hdr.GetDestinationAddress ().Serialize (buf + 16);
+  std::memset (buf + 32, 0, 4);
+
+  /* TCP and UDP headers start with the source and destination ports. They
+     may follow extension headers, which are skipped if they fit in the
+     first bytes of the payload */
+  uint8_t data[64];
+  uint32_t size = 0;
+  uint32_t offset = 0;
+  if (protocol != Ipv6Header::IPV6_TCP && protocol != Ipv6Header::IPV6_UDP)
+    {
+      size = std::min<uint32_t> (ipv6Item->GetPacket ()->GetSize (), sizeof (data));
+      ipv6Item->GetPacket ()->CopyData (data, size);
+    }
+  while (protocol == Ipv6Header::IPV6_EXT_HOP_BY_HOP
+         || protocol == Ipv6Header::IPV6_EXT_ROUTING
+         || protocol == Ipv6Header::IPV6_EXT_DESTINATION
+         || protocol == Ipv6Header::IPV6_EXT_FRAGMENTATION)
+    {
+      if (offset + 8 > size)
+        {
+          break;
+        }
+      uint32_t length = (data[offset + 1] + 1) * 8;
+      if (protocol == Ipv6Header::IPV6_EXT_FRAGMENTATION)
+        {
+          length = 8;
+          if (((data[offset + 2] << 8) | (data[offset + 3] & 0xf8)) != 0)
+            {
+              /* only the first fragment holds the ports */
+              break;
+            }
+        }
+      protocol = data[offset];
+      offset += length;
+    }
+  buf[36] = protocol;
+
+  if (protocol == Ipv6Header::IPV6_TCP || protocol == Ipv6Header::IPV6_UDP)
+    {
+      if (offset == 0 && ipv6Item->GetPacket ()->GetSize () >= 4)
+        {
+          ipv6Item->GetPacket ()->CopyData (buf + 32, 4);
+        }
+      else if (offset > 0 && offset + 4 <= size)
+        {
+          std::memcpy (buf + 32, data + offset, 4);
+        }
+    }
+
+  uint32_t hash = Hash32 (reinterpret_cast<char *> (buf), sizeof (buf));
+  NS_LOG_DEBUG ("Found Ipv6 packet; hash " << hash);
+
+  return hash & 0x7fffffff;
+}
+
 } // namespace ns3
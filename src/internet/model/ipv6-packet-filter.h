@@ -102,6 +102,34 @@ private:
   uint32_t DscpToBand (Ipv6Header::DscpType dscpType) const;
 };
 
+
+/**
+ * \ingroup internet
+ *
+ * SfbIpv6PacketFilter is the filter to be added to the SfbQueueDisc to
+ * identify the flows. Packets are classified based on the hash of the
+ * source and destination addresses, the upper-layer protocol and, for
+ * TCP and UDP packets, the source and destination ports. The hop-by-hop,
+ * routing, fragment and destination options headers are skipped if they
+ * fit in the first 64 bytes of the payload; the ports of other packets,
+ * and of the fragments other than the first, are ignored.
+ * The value returned is not negative.
+ */
+class SfbIpv6PacketFilter: public Ipv6PacketFilter {
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  SfbIpv6PacketFilter ();
+  virtual ~SfbIpv6PacketFilter ();
+
+private:
+  virtual int32_t DoClassify (Ptr<QueueDiscItem> item) const;
+};
+
 } // namespace ns3
 
 #endif /* IPV6_PACKET_FILTER */
@@ -63,6 +63,13 @@ public:
    */
   virtual void AddHeader (void);
 
+  /**
+   * \brief Set the ECN Congestion Experienced codepoint in the header, if
+   * the packet is ECN-capable
+   * \return true if the packet has been marked, false otherwise.
+   */
+  virtual bool Mark (void);
+
   /**
    * \brief Print the item contents.
    * \param os output stream in which the data should be printed.
@@ -0,0 +1,693 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "multithreaded-simulator-impl.h"
+
+#include "ns3/simulator.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/system-thread.h"
+#include "ns3/channel.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/net-device.h"
+#include "ns3/ptr.h"
+#include "ns3/assert.h"
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <sched.h>
+
+namespace ns3 {
+
+// Note:  Logging in this file is largely avoided due to the
+// number of calls that are made to these functions and the possibility
+// of causing recursions leading to stack overflow
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (MultithreadedSimulatorImpl);
+
+/** Timestamp of the events which never occur. */
+static const uint64_t NEVER = 0x7fffffffffffffffULL;
+
+__thread MultithreadedSimulatorImpl::Partition *MultithreadedSimulatorImpl::m_partition = 0;
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .SetGroupName ("Mpi")
+    .AddConstructor<MultithreadedSimulatorImpl> ()
+    .AddAttribute ("MaximumLookAhead",
+                   "Upper bound of the lookahead: the smallest delay of the "
+                   "events scheduled for the nodes of another partition, "
+                   "if it is smaller than the delays of the point-to-point "
+                   "channels between partitions.",
+                   TimeValue (TimeStep (NEVER)),
+                   MakeTimeAccessor (&MultithreadedSimulatorImpl::m_maximumLookAhead),
+                   MakeTimeChecker (TimeStep (1)))
+  ;
+  return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl ()
+  : m_uidStep (1),
+    m_stopTs (NEVER),
+    m_lookAhead (NEVER),
+    m_running (false),
+    m_barrierCount (0),
+    m_barrierGeneration (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_partitions.push_back (CreatePartition (0));
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::CreatePartition (uint32_t id) const
+{
+  NS_LOG_FUNCTION (this << id);
+  Partition *partition = new Partition ();
+  partition->id = id;
+  // uids are allocated from 4.
+  // uid 0 is "invalid" events
+  // uid 1 is "now" events
+  // uid 2 is "destroy" events
+  partition->uid = 4;
+  // before ::Run is entered, the currentUid will be zero
+  partition->currentUid = 0;
+  partition->currentTs = 0;
+  partition->currentContext = 0xffffffff;
+  partition->unscheduledEvents = 0;
+  partition->stopTs = NEVER;
+  partition->windowEnd = 0;
+  partition->publishedNextTs = NEVER;
+  partition->publishedStopTs = NEVER;
+  if (m_schedulerFactory.GetTypeId () != TypeId ())
+    {
+      partition->events = m_schedulerFactory.Create<Scheduler> ();
+    }
+  return partition;
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      Partition *partition = *i;
+      while (partition->events != 0 && !partition->events->IsEmpty ())
+        {
+          Scheduler::Event next = partition->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      delete partition;
+    }
+  m_partitions.clear ();
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  while (!m_destroyEvents.empty ())
+    {
+      Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
+      m_destroyEvents.pop_front ();
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  NS_ASSERT_MSG (!m_running, "The scheduler can not be changed during the simulation");
+  m_schedulerFactory = schedulerFactory;
+  Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
+
+  Partition *partition = m_partitions[0];
+  if (partition->events != 0)
+    {
+      while (!partition->events->IsEmpty ())
+        {
+          Scheduler::Event next = partition->events->RemoveNext ();
+          scheduler->Insert (next);
+        }
+    }
+  partition->events = scheduler;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId (void) const
+{
+  return m_partition != 0 ? m_partition->id : 0;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetPartition (uint32_t context) const
+{
+  if (context < m_contextPartition.size ())
+    {
+      return m_contextPartition[context];
+    }
+  return 0;
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::GetCurrentPartition (void) const
+{
+  if (m_partition != 0)
+    {
+      return m_partition;
+    }
+  NS_ASSERT_MSG (!m_running, "The simulator can not be called during the simulation "
+                 "by a thread which does not run a partition");
+  return m_partitions[0];
+}
+
+uint32_t
+MultithreadedSimulatorImpl::Insert (Partition *partition, uint64_t ts, uint32_t context, EventImpl *event)
+{
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = ts;
+  ev.key.m_context = context;
+  ev.key.m_uid = partition->uid;
+  partition->uid += m_uidStep;
+  partition->unscheduledEvents++;
+  partition->events->Insert (ev);
+  return ev.key.m_uid;
+}
+
+void
+MultithreadedSimulatorImpl::CalculateLookAhead (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_lookAhead = m_maximumLookAhead.GetTimeStep ();
+  for (NodeList::Iterator iter = NodeList::Begin (); iter != NodeList::End (); ++iter)
+    {
+      for (uint32_t i = 0; i < (*iter)->GetNDevices (); ++i)
+        {
+          Ptr<NetDevice> localNetDevice = (*iter)->GetDevice (i);
+          // only works for p2p links currently
+          if (!localNetDevice->IsPointToPoint ())
+            {
+              continue;
+            }
+          Ptr<Channel> channel = localNetDevice->GetChannel ();
+          if (channel == 0 || channel->GetNDevices () != 2)
+            {
+              continue;
+            }
+
+          // grab the adjacent node
+          Ptr<Node> remoteNode;
+          if (channel->GetDevice (0) == localNetDevice)
+            {
+              remoteNode = (channel->GetDevice (1))->GetNode ();
+            }
+          else
+            {
+              remoteNode = (channel->GetDevice (0))->GetNode ();
+            }
+
+          // if it's not remote, don't consider it
+          if (remoteNode == 0 || remoteNode->GetSystemId () == (*iter)->GetSystemId ())
+            {
+              continue;
+            }
+
+          TimeValue delay;
+          channel->GetAttribute ("Delay", delay);
+          NS_ABORT_MSG_IF (delay.Get ().IsZero (), "The channel between nodes " << (*iter)->GetId ()
+                           << " and " << remoteNode->GetId () << " of different partitions has no delay");
+          m_lookAhead = std::min<uint64_t> (m_lookAhead, delay.Get ().GetTimeStep ());
+        }
+    }
+  NS_LOG_LOGIC ("lookahead " << m_lookAhead);
+}
+
+void
+MultithreadedSimulatorImpl::Distribute (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t nPartitions = 1;
+  m_contextPartition.assign (NodeList::GetNNodes (), 0);
+  for (NodeList::Iterator iter = NodeList::Begin (); iter != NodeList::End (); ++iter)
+    {
+      uint32_t systemId = (*iter)->GetSystemId ();
+      m_contextPartition[(*iter)->GetId ()] = systemId;
+      nPartitions = std::max (nPartitions, systemId + 1);
+    }
+
+  Partition *first = m_partitions[0];
+  for (uint32_t i = 1; i < nPartitions; i++)
+    {
+      Partition *partition = CreatePartition (i);
+      partition->currentTs = first->currentTs;
+      partition->currentUid = first->currentUid;
+      m_partitions.push_back (partition);
+    }
+
+  // the partitions allocate interleaved uids
+  uint32_t uid = first->uid;
+  for (uint32_t i = 0; i < nPartitions; i++)
+    {
+      Partition *partition = m_partitions[i];
+      partition->uid = uid + i;
+      partition->stopTs = m_stopTs;
+      partition->outbox.assign (nPartitions, Inbox ());
+    }
+  m_uidStep = nPartitions;
+
+  // the uid of the events is kept, so that the EventIds remain valid
+  std::vector<Scheduler::Event> events;
+  while (!first->events->IsEmpty ())
+    {
+      events.push_back (first->events->RemoveNext ());
+    }
+  for (std::vector<Scheduler::Event>::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      Partition *partition = m_partitions[GetPartition (i->key.m_context)];
+      partition->events->Insert (*i);
+      partition->unscheduledEvents++;
+    }
+  first->unscheduledEvents -= events.size ();
+}
+
+void
+MultithreadedSimulatorImpl::Merge (void)
+{
+  NS_LOG_FUNCTION (this);
+  Partition *first = m_partitions[0];
+
+  // the stop time is that of the partition which stopped first
+  uint64_t stopTs = NEVER;
+  uint64_t currentTs = 0;
+  uint32_t uid = 0;
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      stopTs = std::min (stopTs, (*i)->publishedStopTs);
+      currentTs = std::max (currentTs, (*i)->currentTs);
+      uid = std::max (uid, (*i)->uid);
+    }
+  if (stopTs != NEVER)
+    {
+      first->currentTs = stopTs;
+      first->currentUid = 0;
+    }
+  else
+    {
+      first->currentTs = currentTs;
+    }
+  first->currentContext = 0xffffffff;
+  first->uid = uid;
+  first->stopTs = NEVER;
+  first->outbox.clear ();
+  m_stopTs = NEVER;
+  m_uidStep = 1;
+
+  for (uint32_t i = 1; i < m_partitions.size (); i++)
+    {
+      Partition *partition = m_partitions[i];
+      while (!partition->events->IsEmpty ())
+        {
+          first->events->Insert (partition->events->RemoveNext ());
+        }
+      first->unscheduledEvents += partition->unscheduledEvents;
+      delete partition;
+    }
+  m_partitions.resize (1);
+  m_contextPartition.clear ();
+}
+
+void
+MultithreadedSimulatorImpl::Synchronize (void)
+{
+  if (m_partitions.size () == 1)
+    {
+      return;
+    }
+  uint32_t generation = m_barrierGeneration;
+  if (__sync_add_and_fetch (&m_barrierCount, 1) == m_partitions.size ())
+    {
+      m_barrierCount = 0;
+      __sync_synchronize ();
+      m_barrierGeneration = generation + 1;
+    }
+  else
+    {
+      uint32_t spins = 0;
+      while (m_barrierGeneration == generation)
+        {
+          // give way to the other threads if there are more threads than cores
+          if (++spins > 1000)
+            {
+              sched_yield ();
+            }
+        }
+    }
+  __sync_synchronize ();
+}
+
+void
+MultithreadedSimulatorImpl::ProcessOneEvent (Partition *partition)
+{
+  Scheduler::Event next = partition->events->RemoveNext ();
+
+  NS_ASSERT (next.key.m_ts >= partition->currentTs);
+  partition->unscheduledEvents--;
+
+  NS_LOG_LOGIC ("handle " << next.key.m_ts);
+  partition->currentTs = next.key.m_ts;
+  partition->currentContext = next.key.m_context;
+  partition->currentUid = next.key.m_uid;
+  next.impl->Invoke ();
+  next.impl->Unref ();
+}
+
+void
+MultithreadedSimulatorImpl::RunPartition (Partition *partition)
+{
+  NS_LOG_FUNCTION (this << partition->id);
+  m_partition = partition;
+  while (true)
+    {
+      // the other partitions have finished the previous window: receive
+      // the events they have sent, in the order of the partitions so that
+      // the uids do not depend on the timing of the threads
+      Synchronize ();
+      for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+        {
+          Inbox &inbox = (*i)->outbox[partition->id];
+          for (Inbox::const_iterator j = inbox.begin (); j != inbox.end (); ++j)
+            {
+              Insert (partition, j->timestamp, j->context, j->event);
+            }
+          inbox.clear ();
+        }
+      partition->publishedNextTs = partition->events->IsEmpty () ? NEVER : partition->events->PeekNext ().key.m_ts;
+      partition->publishedStopTs = partition->stopTs;
+      Synchronize ();
+
+      // all the threads compute the same window
+      uint64_t nextTs = NEVER;
+      uint64_t stopTs = NEVER;
+      for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+        {
+          nextTs = std::min (nextTs, (*i)->publishedNextTs);
+          stopTs = std::min (stopTs, (*i)->publishedStopTs);
+        }
+      if (nextTs >= stopTs)
+        {
+          break;
+        }
+      partition->windowEnd = nextTs < NEVER - m_lookAhead ? nextTs + m_lookAhead : NEVER;
+      partition->windowEnd = std::min (partition->windowEnd, stopTs);
+      while (!partition->events->IsEmpty ()
+             && partition->events->PeekNext ().key.m_ts < std::min (partition->windowEnd, partition->stopTs))
+        {
+          ProcessOneEvent (partition);
+        }
+    }
+  m_partition = 0;
+}
+
+bool
+MultithreadedSimulatorImpl::IsPartitionThread (void)
+{
+  return m_partition != 0;
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished (void) const
+{
+  Partition *partition = GetCurrentPartition ();
+  return partition->events->IsEmpty () || partition->stopTs <= partition->currentTs;
+}
+
+void
+MultithreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  Distribute ();
+  CalculateLookAhead ();
+  m_running = true;
+
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 1; i < m_partitions.size (); i++)
+    {
+      Callback<void, Partition *> run = MakeCallback (&MultithreadedSimulatorImpl::RunPartition, this);
+      threads.push_back (Create<SystemThread> (run.Bind (m_partitions[i])));
+      threads.back ()->Start ();
+    }
+  RunPartition (m_partitions[0]);
+  for (std::vector<Ptr<SystemThread> >::iterator i = threads.begin (); i != threads.end (); ++i)
+    {
+      (*i)->Join ();
+    }
+
+  m_running = false;
+  Merge ();
+
+  // If the simulator stopped naturally by lack of events, make a
+  // consistency test to check that we didn't lose any events along the way.
+  NS_ASSERT (!m_partitions[0]->events->IsEmpty () || m_partitions[0]->unscheduledEvents == 0);
+}
+
+void
+MultithreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_partition != 0)
+    {
+      m_partition->stopTs = m_partition->currentTs;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Stop (Time const &delay)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep ());
+  Partition *partition = GetCurrentPartition ();
+  uint64_t stopTs = partition->currentTs + delay.GetTimeStep ();
+  if (m_partition != 0)
+    {
+      partition->stopTs = std::min (partition->stopTs, stopTs);
+    }
+  else
+    {
+      m_stopTs = std::min (m_stopTs, stopTs);
+    }
+}
+
+//
+// Schedule an event for a _relative_ time in the future.
+//
+EventId
+MultithreadedSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep () << event);
+  Partition *partition = GetCurrentPartition ();
+
+  Time tAbsolute = delay + TimeStep (partition->currentTs);
+
+  NS_ASSERT (tAbsolute.IsPositive ());
+  NS_ASSERT (tAbsolute >= TimeStep (partition->currentTs));
+  uint64_t ts = (uint64_t) tAbsolute.GetTimeStep ();
+  uint32_t uid = Insert (partition, ts, partition->currentContext, event);
+  return EventId (event, ts, partition->currentContext, uid);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << context << delay.GetTimeStep () << event);
+  Partition *partition = GetCurrentPartition ();
+
+  Time tAbsolute = delay + TimeStep (partition->currentTs);
+  uint64_t ts = (uint64_t) tAbsolute.GetTimeStep ();
+  if (!m_running || GetPartition (context) == partition->id)
+    {
+      Insert (partition, ts, context, event);
+      return;
+    }
+
+  // the other partition may already have run the events up to the end of
+  // the window, it gets the event at the next synchronization
+  if (ts < partition->windowEnd)
+    {
+      NS_FATAL_ERROR ("Event scheduled by node " << partition->currentContext
+                      << " for node " << context << " of another partition with a delay of "
+                      << delay << ", shorter than the lookahead " << TimeStep (m_lookAhead));
+    }
+  EventWithContext ev;
+  ev.timestamp = ts;
+  ev.context = context;
+  ev.event = event;
+  partition->outbox[GetPartition (context)].push_back (ev);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  Partition *partition = GetCurrentPartition ();
+  uint32_t uid = Insert (partition, partition->currentTs, partition->currentContext, event);
+  return EventId (event, partition->currentTs, partition->currentContext, uid);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  CriticalSection cs (m_destroyMutex);
+  EventId id (Ptr<EventImpl> (event, false), GetCurrentPartition ()->currentTs, 0xffffffff, 2);
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now (void) const
+{
+  // Do not add function logging here, to avoid stack overflow
+  return TimeStep (GetCurrentPartition ()->currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs () - GetCurrentPartition ()->currentTs);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      CriticalSection cs (m_destroyMutex);
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  Partition *partition = GetCurrentPartition ();
+  NS_ASSERT_MSG (!m_running || GetPartition (id.GetContext ()) == partition->id,
+                 "Event of node " << id.GetContext () << " removed by another partition");
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  partition->events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+
+  partition->unscheduledEvents--;
+}
+
+void
+MultithreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired (const EventId &id) const
+{
+  if (id.GetUid () == 2)
+    {
+      if (id.PeekEventImpl () == 0 ||
+          id.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      CriticalSection cs (m_destroyMutex);
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  // the event is compared with the current event of its partition
+  Partition *partition = GetCurrentPartition ();
+  if (m_running)
+    {
+      partition = m_partitions[GetPartition (id.GetContext ())];
+    }
+  if (id.PeekEventImpl () == 0 ||
+      id.GetTs () < partition->currentTs ||
+      (id.GetTs () == partition->currentTs &&
+       id.GetUid () <= partition->currentUid) ||
+      id.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (0x7fffffffffffffffLL);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext (void) const
+{
+  return GetCurrentPartition ()->currentContext;
+}
+
+} // namespace ns3
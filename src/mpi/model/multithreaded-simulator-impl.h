@@ -0,0 +1,228 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_MULTITHREADED_SIMULATOR_IMPL_H
+#define NS3_MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "ns3/simulator-impl.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/system-mutex.h"
+
+#include <list>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ * \ingroup mpi
+ *
+ * \brief Parallel simulator implementation running the partitions
+ * of a simulation in the threads of a shared-memory machine
+ *
+ * The nodes are partitioned by system id, as with the
+ * DistributedSimulatorImpl, but all the partitions are run by the
+ * threads of a single process: partition 0 is run by the thread calling
+ * Simulator::Run, and one thread is started for each other partition.
+ * MPI is not needed, the nodes are created by a single instance of the
+ * simulation script and the PointToPointHelper creates normal
+ * PointToPointChannels between the nodes of different partitions.
+ *
+ * The synchronization is conservative: the threads repeatedly agree on
+ * the timestamp T of the earliest event of all the partitions, then run
+ * their events up to T + lookahead independently. The lookahead is the
+ * smallest delay of the point-to-point channels between partitions, as
+ * computed by the DistributedSimulatorImpl, bounded by the
+ * MaximumLookAhead attribute. The PointToPointChannel hands a deep copy
+ * of the packets over to the receiving partition, instead of serializing
+ * them.
+ *
+ * The events are executed in the same order as with the
+ * DefaultSimulatorImpl within each partition, hence the results do not
+ * depend on the number of threads or on their timing, with the
+ * following restrictions:
+ *  - an event may only schedule events for the nodes of another
+ *    partition with a delay at least equal to the lookahead: the nodes of
+ *    different partitions must only be connected by point-to-point
+ *    channels, and a fatal error is raised otherwise;
+ *  - the events without a node context run in partition 0 and must not
+ *    access the nodes of the other partitions;
+ *  - Simulator::Stop stops the simulation before the events at the stop
+ *    time. When it is called during the simulation, the other partitions
+ *    stop at the end of the current time window;
+ *  - the objects shared by several partitions (e.g., trace sinks) must be
+ *    thread-safe, and the events can not be scheduled by threads which
+ *    do not run a partition.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  MultithreadedSimulatorImpl ();
+  /** Destructor. */
+  ~MultithreadedSimulatorImpl ();
+
+  // Inherited
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (Time const &delay);
+  virtual EventId Schedule (Time const &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+
+  /**
+   * Check if the calling thread runs a partition of a
+   * MultithreadedSimulatorImpl, hence if the nodes of different system
+   * ids may be run by different threads.
+   *
+   * This method neither creates nor references the simulator
+   * implementation, and may be called by any thread.
+   *
+   * eturns true if the calling thread runs a partition.
+   */
+  static bool IsPartitionThread (void);
+
+private:
+  virtual void DoDispose (void);
+
+  /** An event sent to another partition, which gets its uid when it is received. */
+  struct EventWithContext
+  {
+    uint64_t timestamp;   //!< Absolute timestamp of the event
+    uint32_t context;     //!< Context of the event
+    EventImpl *event;     //!< The event
+  };
+  /** The events sent to a partition during a time window. */
+  typedef std::vector<EventWithContext> Inbox;
+
+  /** The state of a partition, only accessed by the thread running it. */
+  struct Partition
+  {
+    uint32_t id;                 //!< The system id of the nodes of the partition
+    Ptr<Scheduler> events;       //!< The events of the partition
+    uint32_t uid;                //!< The uid of the next event scheduled
+    uint32_t currentUid;         //!< The uid of the current event
+    uint64_t currentTs;          //!< The timestamp of the current event
+    uint32_t currentContext;     //!< The context of the current event
+    int unscheduledEvents;       //!< Number of events inserted but not yet run
+    uint64_t stopTs;             //!< Timestamp at which the partition stops
+    uint64_t windowEnd;          //!< End of the current time window
+    std::vector<Inbox> outbox;   //!< The events sent to each partition during the window
+    /**
+     * The timestamp of the next event and the stop timestamp, published
+     * to the other partitions between two synchronizations.
+     */
+    uint64_t publishedNextTs;
+    uint64_t publishedStopTs;    //!< See publishedNextTs
+  };
+
+  /**
+   * Create a partition.
+   *
+   * \param [in] id The id of the partition.
+   * \returns The new partition.
+   */
+  Partition *CreatePartition (uint32_t id) const;
+  /**
+   * Get the partition running the nodes of a context.
+   *
+   * \param [in] context The context.
+   * \returns The id of the partition.
+   */
+  uint32_t GetPartition (uint32_t context) const;
+  /**
+   * Get the partition of the calling thread.
+   *
+   * Outside of Run, all the events are kept in partition 0.
+   *
+   * \returns The partition.
+   */
+  Partition *GetCurrentPartition (void) const;
+  /**
+   * Insert an event in a partition.
+   *
+   * \param [in] partition The partition.
+   * \param [in] ts The absolute timestamp of the event.
+   * \param [in] context The context of the event.
+   * \param [in] event The event.
+   * \returns The uid of the event.
+   */
+  uint32_t Insert (Partition *partition, uint64_t ts, uint32_t context, EventImpl *event);
+  /** Assign the nodes to the partitions and move the events to their partition. */
+  void Distribute (void);
+  /** Move all the events back to partition 0. */
+  void Merge (void);
+  /** Compute the lookahead from the delays of the channels between partitions. */
+  void CalculateLookAhead (void);
+  /**
+   * Run the events of a partition until the end of the simulation.
+   *
+   * \param [in] partition The partition.
+   */
+  void RunPartition (Partition *partition);
+  /**
+   * Run the next event of a partition.
+   *
+   * \param [in] partition The partition.
+   */
+  void ProcessOneEvent (Partition *partition);
+  /** Wait until all the threads have called this method. */
+  void Synchronize (void);
+
+  /** Container type for the events to run at Simulator::Destroy() */
+  typedef std::list<EventId> DestroyEvents;
+
+  DestroyEvents m_destroyEvents;          //!< The events to run at Simulator::Destroy()
+  mutable SystemMutex m_destroyMutex;     //!< Protect m_destroyEvents
+  ObjectFactory m_schedulerFactory;       //!< Create the event queue of the partitions
+  std::vector<Partition *> m_partitions;  //!< The partitions, only partition 0 outside of Run
+  std::vector<uint32_t> m_contextPartition; //!< The partition of each node
+  uint32_t m_uidStep;                     //!< Difference between the uids of a partition
+  uint64_t m_stopTs;                      //!< Stop timestamp set outside of Run
+  uint64_t m_lookAhead;                   //!< The lookahead of the current Run
+  Time m_maximumLookAhead;                //!< Upper bound of the lookahead
+  bool m_running;                         //!< Are the partitions running
+  volatile uint32_t m_barrierCount;       //!< Number of threads waiting in Synchronize
+  volatile uint32_t m_barrierGeneration;  //!< Number of completed synchronizations
+
+  /** The partition run by the calling thread, 0 outside of Run. */
+  static __thread Partition *m_partition;
+};
+
+} // namespace ns3
+
+#endif /* NS3_MULTITHREADED_SIMULATOR_IMPL_H */
@@ -50,48 +50,18 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("Buffer");
 
 
-uint32_t Buffer::g_recommendedStart = 0;
+__thread uint32_t Buffer::g_recommendedStart = 0;
 #ifdef BUFFER_FREE_LIST
-/* The following macros are pretty evil but they are needed to allow us to
- * keep track of 3 possible states for the g_freeList variable:
- *  - uninitialized means that no one has created a buffer yet
- *    so no one has created the associated free list (it is created
- *    on-demand when the first buffer is created)
- *  - initialized means that the free list exists and is valid
- *  - destroyed means that the static destructors of this compilation unit
- *    have run so, the free list has been cleared from its content
- * The key is that in destroyed state, we are careful not re-create it
- * which is a typical weakness of lazy evaluation schemes which use 
- * '0' as a special value to indicate both un-initialized and destroyed.
- * Note that it is important to use '0' as the marker for un-initialized state
- * because the variable holding this state information is initialized to zero
- * which the compiler assigns to zero-memory which is initialized to _zero_
- * before the constructors run so this ensures perfect handling of crazy 
- * constructor orderings.
+/* Each thread has its own pool, so that packets can be handled by
+ * several threads at the same time (see ns3::MultithreadedSimulatorImpl).
+ * The pool is a POD, zero-initialized before any constructor runs.
  */
-#define MAGIC_DESTROYED (~(long) 0)
-#define IS_UNINITIALIZED(x) (x == (Buffer::FreeList*)0)
-#define IS_DESTROYED(x) (x == (Buffer::FreeList*)MAGIC_DESTROYED)
-#define IS_INITIALIZED(x) (!IS_UNINITIALIZED (x) && !IS_DESTROYED (x))
-#define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
-#define UNINITIALIZED ((Buffer::FreeList*)0)
-uint32_t Buffer::g_maxSize = 0;
-Buffer::FreeList *Buffer::g_freeList = 0;
-struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
-
-Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
+__thread DataPool Buffer::g_pool;
+
+struct DataPool::Stats
+Buffer::GetPoolStats (void)
 {
-  NS_LOG_FUNCTION (this);
-  if (IS_INITIALIZED (g_freeList))
-    {
-      for (Buffer::FreeList::iterator i = g_freeList->begin ();
-           i != g_freeList->end (); i++)
-        {
-          Buffer::Deallocate (*i);
-        }
-      delete g_freeList;
-      g_freeList = DESTROYED;
-    }
+  return g_pool.GetStats ();
 }
 
 void
@@ -99,47 +69,23 @@ Buffer::Recycle (struct Buffer::Data *data)
 {
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
-  NS_ASSERT (!IS_UNINITIALIZED (g_freeList));
-  g_maxSize = std::max (g_maxSize, data->m_size);
-  /* feed into free list */
-  if (data->m_size < g_maxSize ||
-      IS_DESTROYED (g_freeList) ||
-      g_freeList->size () > 1000)
-    {
-      Buffer::Deallocate (data);
-    }
-  else
-    {
-      NS_ASSERT (IS_INITIALIZED (g_freeList));
-      g_freeList->push_back (data);
-    }
+  // the data may have been created by another thread
+  g_pool.Release (data, data->m_size - 1 + sizeof (struct Buffer::Data));
 }
 
 Buffer::Data *
 Buffer::Create (uint32_t dataSize)
 {
   NS_LOG_FUNCTION (dataSize);
-  /* try to find a buffer correctly sized. */
-  if (IS_UNINITIALIZED (g_freeList))
+  if (dataSize == 0)
     {
-      g_freeList = new Buffer::FreeList ();
+      dataSize = 1;
     }
-  else if (IS_INITIALIZED (g_freeList))
-    {
-      while (!g_freeList->empty ()) 
-        {
-          struct Buffer::Data *data = g_freeList->back ();
-          g_freeList->pop_back ();
-          if (data->m_size >= dataSize) 
-            {
-              data->m_count = 1;
-              return data;
-            }
-          Buffer::Deallocate (data);
-        }
-    }
-  struct Buffer::Data *data = Buffer::Allocate (dataSize);
-  NS_ASSERT (data->m_count == 1);
+  uint32_t size = dataSize - 1 + sizeof (struct Buffer::Data);
+  struct Buffer::Data *data = static_cast<struct Buffer::Data *> (g_pool.Allocate (size));
+  // use the whole block
+  data->m_size = size + 1 - sizeof (struct Buffer::Data);
+  data->m_count = 1;
   return data;
 }
 #else /* BUFFER_FREE_LIST */
@@ -244,7 +190,7 @@ void
 Buffer::Initialize (uint32_t zeroSize)
 {
   NS_LOG_FUNCTION (this << zeroSize);
-  m_data = Buffer::Create (0);
+  m_data = Buffer::Create (g_recommendedStart);
   m_start = std::min (m_data->m_size, g_recommendedStart);
   m_maxZeroAreaStart = m_start;
   m_zeroAreaStart = m_start;
@@ -426,6 +372,51 @@ Buffer::AddAtEnd (const Buffer &o)
       return;
     }
 
+  uint32_t zeroSize = m_zeroAreaEnd - m_zeroAreaStart;
+  uint32_t oZeroSize = o.m_zeroAreaEnd - o.m_zeroAreaStart;
+  if (zeroSize + oZeroSize > 0 &&
+      (zeroSize == 0 || oZeroSize == 0 ||
+       (m_end == m_zeroAreaEnd && o.m_start == o.m_zeroAreaStart)))
+    {
+      /**
+       * The zero areas of both buffers are adjacent once
+       * concatenated, or only one of them has a zero area:
+       * copy the real bytes of both buffers, and keep the zero
+       * areas virtual in a single zero area rather than writing
+       * them out with CreateFullCopy. This is what keeps the
+       * payload of fragments virtual when they are reassembled.
+       */
+      uint32_t size = GetInternalSize ();
+      uint32_t oSize = o.GetInternalSize ();
+      uint32_t zeroStart;
+      if (zeroSize > 0)
+        {
+          zeroStart = m_zeroAreaStart - m_start;
+        }
+      else
+        {
+          zeroStart = size + o.m_zeroAreaStart - o.m_start;
+        }
+      struct Buffer::Data *newData = Buffer::Create (size + oSize);
+      memcpy (newData->m_data, m_data->m_data + m_start, size);
+      memcpy (newData->m_data + size, o.m_data->m_data + o.m_start, oSize);
+      m_data->m_count--;
+      if (m_data->m_count == 0)
+        {
+          Buffer::Recycle (m_data);
+        }
+      m_data = newData;
+      m_start = 0;
+      m_zeroAreaStart = zeroStart;
+      m_zeroAreaEnd = zeroStart + zeroSize + oZeroSize;
+      m_end = size + oSize + zeroSize + oZeroSize;
+      m_data->m_dirtyStart = m_start;
+      m_data->m_dirtyEnd = m_end;
+      m_maxZeroAreaStart = std::max (m_maxZeroAreaStart, m_zeroAreaStart);
+      NS_ASSERT (CheckInternalState ());
+      return;
+    }
+
   Buffer dst = CreateFullCopy ();
   Buffer src = o.CreateFullCopy ();
 
@@ -689,6 +680,25 @@ Buffer::Deserialize (const uint8_t *buffer, uint32_t size)
   return (sizeCheck != 0) ? 0 : 1;
 }
 
+Buffer
+Buffer::DeepCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (CheckInternalState ());
+  Buffer copy (0, false);
+  copy.m_data = Buffer::Create (m_data->m_size);
+  // the bytes before and after the zero area are stored contiguously
+  memcpy (copy.m_data->m_data + m_start, m_data->m_data + m_start, GetInternalSize ());
+  copy.m_data->m_dirtyStart = m_start;
+  copy.m_data->m_dirtyEnd = m_end;
+  copy.m_maxZeroAreaStart = m_maxZeroAreaStart;
+  copy.m_zeroAreaStart = m_zeroAreaStart;
+  copy.m_zeroAreaEnd = m_zeroAreaEnd;
+  copy.m_start = m_start;
+  copy.m_end = m_end;
+  NS_ASSERT (copy.CheckInternalState ());
+  return copy;
+}
 
 void
 Buffer::TransformIntoRealBuffer (void) const
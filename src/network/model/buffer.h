@@ -24,6 +24,7 @@
 #include <vector>
 #include <ostream>
 #include "ns3/assert.h"
+#include "data-pool.h"
 
 #define BUFFER_FREE_LIST 1
 
@@ -588,6 +589,17 @@ private:
    */
   uint32_t Deserialize (const uint8_t* buffer, uint32_t size);
 
+  /**
+   * \brief Create a copy of the buffer which does not share its
+   * data storage with this buffer.
+   *
+   * Only the bytes of this buffer are copied: the zero area stays
+   * virtual.
+   *
+   * \returns the copy of the buffer
+   */
+  Buffer DeepCopy (void) const;
+
   /** 
    * Copy the specified amount of data from the buffer to the given output stream.
    * 
@@ -636,6 +648,14 @@ private:
    */
   Buffer (uint32_t dataSize, bool initialize);
   ~Buffer ();
+
+#ifdef BUFFER_FREE_LIST
+  /**
+   * \brief Get the statistics of the buffer data pool of the calling thread
+   * \returns the statistics
+   */
+  static struct DataPool::Stats GetPoolStats (void);
+#endif
 private:
   /**
    * This data structure is variable-sized through its last member whose size
@@ -759,9 +779,9 @@ private:
   /**
    * location in a newly-allocated buffer where you should start
    * writing data. i.e., m_start should be initialized to this 
-   * value.
+   * value. Each thread keeps its own value.
    */
-  static uint32_t g_recommendedStart;
+  static __thread uint32_t g_recommendedStart;
 
   /**
    * offset to the start of the virtual zero area from the start
@@ -785,16 +805,7 @@ private:
   uint32_t m_end;
 
 #ifdef BUFFER_FREE_LIST
-  /// Container for buffer data
-  typedef std::vector<struct Buffer::Data*> FreeList;
-  /// Local static destructor structure
-  struct LocalStaticDestructor 
-  {
-    ~LocalStaticDestructor ();
-  };
-  static uint32_t g_maxSize; //!< Max observed data size
-  static FreeList *g_freeList; //!< Buffer data container
-  static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
+  static __thread DataPool g_pool; //!< Buffer data pool of this thread
 #endif
 };
 
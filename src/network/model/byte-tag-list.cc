@@ -19,8 +19,12 @@
  */
 #include "byte-tag-list.h"
 #include "ns3/log.h"
+#include "ns3/core-config.h"
 #include <vector>
 #include <cstring>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
 
 #define USE_FREE_LIST 1
 #define FREE_LIST_SIZE 1000
@@ -52,12 +56,19 @@ struct ByteTagListData {
  *
  * Internal use only.
  */
-static class ByteTagListDataFreeList : public std::vector<struct ByteTagListData *>
+class ByteTagListDataFreeList : public std::vector<struct ByteTagListData *>
 {
 public:
   ~ByteTagListDataFreeList ();
-} g_freeList; //!< Container for struct ByteTagListData
-static uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
+};
+/**
+ * Container for struct ByteTagListData of this thread: each thread has its
+ * own free list, so that packets can be handled by several threads at the
+ * same time (see ns3::MultithreadedSimulatorImpl).
+ */
+static __thread ByteTagListDataFreeList *g_freeList = 0;
+static __thread bool g_freeListDestroyed = false; //!< the free list of this thread has been destroyed
+static __thread uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
 
 ByteTagListDataFreeList::~ByteTagListDataFreeList ()
 {
@@ -69,6 +80,73 @@ ByteTagListDataFreeList::~ByteTagListDataFreeList ()
       delete [] buffer;
     }
 }
+
+/**
+ * Destroy a free list of the calling thread.
+ *
+ * \param list The free list.
+ */
+static void
+DestroyFreeList (void *list)
+{
+  if (list != g_freeList)
+    {
+      // the free list has already been destroyed by the static destructors
+      return;
+    }
+  delete g_freeList;
+  g_freeList = 0;
+  g_freeListDestroyed = true;
+}
+
+/**
+ * \ingroup packet
+ *
+ * \brief Destroy the free list of the thread running the static destructors
+ */
+static struct ByteTagListLocalStaticDestructor
+{
+  ~ByteTagListLocalStaticDestructor ()
+  {
+    if (g_freeList != 0)
+      {
+        DestroyFreeList (g_freeList);
+      }
+  }
+} g_localStaticDestructor; //!< Local static destructor
+
+#ifdef HAVE_PTHREAD_H
+/** Key used to destroy the free list of a thread when it exits. */
+static pthread_key_t g_freeListKey;
+/** Ensure g_freeListKey is created once. */
+static pthread_once_t g_freeListKeyOnce = PTHREAD_ONCE_INIT;
+
+/** Create g_freeListKey. */
+static void
+CreateFreeListKey (void)
+{
+  pthread_key_create (&g_freeListKey, &DestroyFreeList);
+}
+#endif /* HAVE_PTHREAD_H */
+
+/**
+ * Get the free list of the calling thread, creating it if needed.
+ *
+ * \returns The free list, or 0 if it has been destroyed.
+ */
+static ByteTagListDataFreeList *
+GetFreeList (void)
+{
+  if (g_freeList == 0 && !g_freeListDestroyed)
+    {
+      g_freeList = new ByteTagListDataFreeList ();
+#ifdef HAVE_PTHREAD_H
+      pthread_once (&g_freeListKeyOnce, &CreateFreeListKey);
+      pthread_setspecific (g_freeListKey, g_freeList);
+#endif /* HAVE_PTHREAD_H */
+    }
+  return g_freeList;
+}
 #endif /* USE_FREE_LIST */
 
 ByteTagList::Iterator::Item::Item (TagBuffer buf_)
@@ -158,6 +236,10 @@ ByteTagList::ByteTagList (const ByteTagList &o)
     {
       m_data->count++;
     }
+  else
+    {
+      std::memcpy (m_inline, o.m_inline, m_used);
+    }
 }
 ByteTagList &
 ByteTagList::operator = (const ByteTagList &o)
@@ -177,6 +259,10 @@ ByteTagList::operator = (const ByteTagList &o)
     {
       m_data->count++;
     }
+  else
+    {
+      std::memcpy (m_inline, o.m_inline, m_used);
+    }
   return *this;
 }
 ByteTagList::~ByteTagList ()
@@ -195,8 +281,12 @@ ByteTagList::Add (TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
   NS_ASSERT (m_used <= spaceNeeded);
   if (m_data == 0)
     {
-      m_data = Allocate (spaceNeeded);
-      m_used = 0;
+      if (spaceNeeded > INLINE_SIZE)
+        {
+          // the tags do not fit inside the list anymore
+          m_data = Allocate (spaceNeeded);
+          std::memcpy (&m_data->data, m_inline, m_used);
+        }
     } 
   else if (m_data->size < spaceNeeded ||
            (m_data->count != 1 && m_data->dirty != m_used))
@@ -206,8 +296,8 @@ ByteTagList::Add (TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
       Deallocate (m_data);
       m_data = newData;
     }
-  TagBuffer tag = TagBuffer (&m_data->data[m_used], 
-                             &m_data->data[spaceNeeded]);
+  uint8_t *buffer = GetBuffer ();
+  TagBuffer tag = TagBuffer (&buffer[m_used], &buffer[spaceNeeded]);
   tag.WriteU32 (tid.GetUid ());
   tag.WriteU32 (bufferSize);
   tag.WriteU32 (start - m_adjustment);
@@ -221,7 +311,10 @@ ByteTagList::Add (TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
       m_maxEnd = end - m_adjustment;
     }
   m_used = spaceNeeded;
-  m_data->dirty = m_used;
+  if (m_data != 0)
+    {
+      m_data->dirty = m_used;
+    }
   return tag;
 }
 
@@ -263,16 +356,23 @@ ByteTagList::Iterator
 ByteTagList::Begin (int32_t offsetStart, int32_t offsetEnd) const
 {
   NS_LOG_FUNCTION (this << offsetStart << offsetEnd);
-  if (m_data == 0)
+  if (m_used == 0)
     {
       return Iterator (0, 0, offsetStart, offsetEnd, 0);
     }
   else
     {
-      return Iterator (m_data->data, &m_data->data[m_used], offsetStart, offsetEnd, m_adjustment);
+      uint8_t *buffer = GetBuffer ();
+      return Iterator (buffer, &buffer[m_used], offsetStart, offsetEnd, m_adjustment);
     }
 }
 
+uint8_t *
+ByteTagList::GetBuffer (void) const
+{
+  return m_data == 0 ? const_cast<uint8_t *> (m_inline) : m_data->data;
+}
+
 void 
 ByteTagList::AddAtEnd (int32_t appendOffset)
 {
@@ -344,10 +444,11 @@ struct ByteTagListData *
 ByteTagList::Allocate (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
-  while (!g_freeList.empty ())
+  ByteTagListDataFreeList *freeList = GetFreeList ();
+  while (freeList != 0 && !freeList->empty ())
     {
-      struct ByteTagListData *data = g_freeList.back ();
-      g_freeList.pop_back ();
+      struct ByteTagListData *data = freeList->back ();
+      freeList->pop_back ();
       NS_ASSERT (data != 0);
       if (data->size >= size)
         {
@@ -378,7 +479,10 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
   data->count--;
   if (data->count == 0)
     {
-      if (g_freeList.size () > FREE_LIST_SIZE ||
+      // the data may have been allocated by another thread
+      ByteTagListDataFreeList *freeList = GetFreeList ();
+      if (freeList == 0 ||
+          freeList->size () > FREE_LIST_SIZE ||
           data->size < g_maxSize)
         {
           uint8_t *buffer = (uint8_t *)data;
@@ -386,7 +490,7 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
         }
       else
         {
-          g_freeList.push_back (data);
+          freeList->push_back (data);
         }
     }
 }
@@ -45,6 +45,11 @@ struct ByteTagListData;
  *     as 4 32bit integers (TypeId, tag data size, start, end) followed 
  *     by the tag data as generated by Tag::Serialize.
  *
+ *   - As long as the tags fit in INLINE_SIZE bytes, for example one or two
+ *     tags of up to 20 bytes such as the Ipv4FlowProbeTag of the
+ *     FlowMonitor, the byte buffer is stored inside the ByteTagList itself
+ *     and copied with it. Larger buffers are allocated on the heap.
+ *
  *   - The struct ByteTagListData structure which contains the tag byte buffer
  *     is shared and, thus, reference-counted. This data structure is unshared
  *     as-needed to emulate COW semantics.
@@ -63,6 +68,12 @@ struct ByteTagListData;
 class ByteTagList
 {
 public:
+  /** Size of the byte buffer stored inside the ByteTagList, in bytes. */
+  enum InlineSize_e
+  {
+    INLINE_SIZE = 72
+  };
+
   /**
    * \brief An iterator for iterating through a byte tag list
    *
@@ -233,6 +244,13 @@ private:
    */
   ByteTagList::Iterator BeginAll (void) const;
 
+  /**
+   * \brief Get the byte buffer, inside this list or on the heap.
+   *
+   * \returns The first byte of the buffer.
+   */
+  uint8_t *GetBuffer (void) const;
+
   /**
    * \brief Allocate the memory for the ByteTagListData
    * \param size the memory to allocate
@@ -250,7 +268,8 @@ private:
   int32_t m_maxEnd; // !< maximal end offset
   int32_t m_adjustment; // !< adjustment to byte tag offsets
   uint16_t m_used; //!< the number of used bytes in the buffer
-  struct ByteTagListData *m_data; //!< the ByteTagListData structure
+  struct ByteTagListData *m_data; //!< the ByteTagListData structure, or 0 if the buffer is m_inline
+  uint8_t m_inline[INLINE_SIZE]; //!< the byte buffer, while the tags fit in it
 };
 
 void
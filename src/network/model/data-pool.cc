@@ -0,0 +1,182 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "data-pool.h"
+#include "ns3/log.h"
+#include "ns3/core-config.h"
+#include <new>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
+/**
+ * \file
+ * \ingroup packet
+ * ns3::DataPool implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("DataPool");
+
+const uint32_t DataPool::CLASSES;
+const uint32_t DataPool::MIN_SIZE;
+const uint32_t DataPool::MAX_CACHED;
+
+namespace {
+
+/** The pools registered by the calling thread, to destroy them with it. */
+__thread DataPool *g_registered = 0;
+
+/**
+ * Destroy the pools registered by the calling thread.
+ *
+ * \param [in] unused The value of the thread key.
+ */
+void
+DestroyRegisteredPools (void *unused)
+{
+  while (g_registered != 0)
+    {
+      DataPool *pool = g_registered;
+      g_registered = pool->m_nextRegistered;
+      pool->Destroy ();
+    }
+}
+
+#ifdef HAVE_PTHREAD_H
+/** Key used to destroy the pools of a thread when it exits. */
+pthread_key_t g_poolKey;
+/** Ensure g_poolKey is created once. */
+pthread_once_t g_poolKeyOnce = PTHREAD_ONCE_INIT;
+
+/** Create g_poolKey. */
+void
+CreatePoolKey (void)
+{
+  pthread_key_create (&g_poolKey, &DestroyRegisteredPools);
+}
+#endif /* HAVE_PTHREAD_H */
+
+/** Destroy the pools of the thread which runs the static destructors. */
+struct LocalStaticDestructor
+{
+  ~LocalStaticDestructor ()
+  {
+    DestroyRegisteredPools (0);
+  }
+} g_localStaticDestructor; //!< Local static destructor
+
+/**
+ * Get the size class of a block.
+ *
+ * \param [in] size The size of the block.
+ * \returns The size class, or DataPool::CLASSES if the block is too large.
+ */
+uint32_t
+GetClass (uint32_t size)
+{
+  uint32_t c = 0;
+  uint32_t classSize = DataPool::MIN_SIZE;
+  while (classSize < size && c < DataPool::CLASSES)
+    {
+      classSize <<= 1;
+      c++;
+    }
+  return c;
+}
+
+} // anonymous namespace
+
+void *
+DataPool::Allocate (uint32_t &size)
+{
+  uint32_t c = GetClass (size);
+  if (c < CLASSES)
+    {
+      size = MIN_SIZE << c;
+      Block *block = m_free[c];
+      if (block != 0)
+        {
+          m_free[c] = block->next;
+          m_nFree[c]--;
+          m_stats.hits++;
+          return block;
+        }
+    }
+  m_stats.misses++;
+  m_stats.bytes += size;
+  if (m_stats.bytes > m_stats.peakBytes)
+    {
+      m_stats.peakBytes = m_stats.bytes;
+    }
+  return ::operator new (size);
+}
+
+void
+DataPool::Release (void *block, uint32_t size)
+{
+  uint32_t c = GetClass (size);
+  if (c >= CLASSES || m_destroyed || (m_nFree[c] + 1) * size > MAX_CACHED)
+    {
+      m_stats.released++;
+      m_stats.bytes -= size;
+      ::operator delete (block);
+      return;
+    }
+  if (!m_registered)
+    {
+      m_nextRegistered = g_registered;
+      g_registered = this;
+#ifdef HAVE_PTHREAD_H
+      pthread_once (&g_poolKeyOnce, &CreatePoolKey);
+      pthread_setspecific (g_poolKey, this);
+#endif /* HAVE_PTHREAD_H */
+      m_registered = true;
+    }
+  Block *b = static_cast<Block *> (block);
+  b->next = m_free[c];
+  m_free[c] = b;
+  m_nFree[c]++;
+  m_stats.recycled++;
+}
+
+void
+DataPool::Destroy (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t c = 0; c < CLASSES; c++)
+    {
+      while (m_free[c] != 0)
+        {
+          Block *block = m_free[c];
+          m_free[c] = block->next;
+          m_stats.released++;
+          m_stats.bytes -= MIN_SIZE << c;
+          ::operator delete (block);
+        }
+      m_nFree[c] = 0;
+    }
+  m_destroyed = true;
+}
+
+struct DataPool::Stats
+DataPool::GetStats (void) const
+{
+  return m_stats;
+}
+
+} // namespace ns3
@@ -0,0 +1,118 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef DATA_POOL_H
+#define DATA_POOL_H
+
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup packet
+ * ns3::DataPool declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ * \brief Size-classed free lists of the memory blocks of one thread.
+ *
+ * Buffer and PacketMetadata allocate their data from a DataPool of the
+ * calling thread. The sizes are rounded up to a power of two, from 64
+ * bytes to 64 kilobytes, and each size class has its own free list, so
+ * that a few large packets do not make every block large. Each free
+ * list keeps at most 1 megabyte of blocks: the blocks released beyond
+ * that, and the blocks larger than the largest class, go back to the
+ * system allocator.
+ *
+ * The blocks of a thread are released when the thread exits, or by the
+ * static destructors for the thread which runs them. A block allocated
+ * by one thread may be released by another.
+ *
+ * A DataPool is a POD, zero-initialized, so that it can be a
+ * \c __thread variable: its fields are public for this reason only.
+ */
+class DataPool
+{
+public:
+  /** Statistics of a DataPool. */
+  struct Stats
+  {
+    uint64_t hits;      //!< Blocks allocated from a free list
+    uint64_t misses;    //!< Blocks allocated from the system allocator
+    uint64_t recycled;  //!< Blocks released to a free list
+    uint64_t released;  //!< Blocks released to the system allocator
+    /**
+     * Bytes allocated from the system allocator by this thread and not
+     * released to it by this thread, in use or in the free lists.
+     * Negative if this thread releases the blocks of other threads.
+     */
+    int64_t bytes;
+    int64_t peakBytes;  //!< Maximum of bytes
+  };
+
+  /** Number of size classes. */
+  static const uint32_t CLASSES = 11;
+  /** Size of the smallest class, in bytes. */
+  static const uint32_t MIN_SIZE = 64;
+  /** Maximum size of the blocks kept by each free list, in bytes. */
+  static const uint32_t MAX_CACHED = 1 << 20;
+
+  /**
+   * Allocate a block.
+   *
+   * \param [in,out] size The minimum size of the block, rounded up to
+   *                 the size of the block.
+   * \returns The block.
+   */
+  void *Allocate (uint32_t &size);
+  /**
+   * Release a block to the free list of its size, or to the system.
+   *
+   * \param [in] block The block.
+   * \param [in] size The size of the block returned by Allocate.
+   */
+  void Release (void *block, uint32_t size);
+  /**
+   * Release all the blocks of the free lists to the system: the
+   * blocks released later go directly to the system.
+   */
+  void Destroy (void);
+  /**
+   * Get the statistics.
+   *
+   * \returns The statistics.
+   */
+  struct Stats GetStats (void) const;
+
+  /** A block in a free list. */
+  struct Block
+  {
+    Block *next;  //!< Next block in the free list
+  };
+
+  Block *m_free[CLASSES];      //!< One free list per size class
+  uint32_t m_nFree[CLASSES];   //!< Number of blocks in each free list
+  struct Stats m_stats;        //!< Allocation statistics
+  bool m_registered;           //!< Will the pool be destroyed with its thread
+  bool m_destroyed;            //!< Has the pool been destroyed
+  DataPool *m_nextRegistered;  //!< Next pool registered by this thread
+};
+
+} // namespace ns3
+
+#endif /* DATA_POOL_H */
@@ -19,6 +19,8 @@
  */
 #include <utility>
 #include <list>
+#include <algorithm>
+#include <vector>
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
@@ -32,20 +34,16 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("PacketMetadata");
 
 bool PacketMetadata::m_enable = false;
+bool PacketMetadata::m_lazy = false;
 bool PacketMetadata::m_enableChecking = false;
 bool PacketMetadata::m_metadataSkipped = false;
-uint32_t PacketMetadata::m_maxSize = 0;
 uint16_t PacketMetadata::m_chunkUid = 0;
-PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+__thread DataPool PacketMetadata::m_pool;
 
-PacketMetadata::DataFreeList::~DataFreeList ()
+struct DataPool::Stats
+PacketMetadata::GetPoolStats (void)
 {
-  NS_LOG_FUNCTION (this);
-  for (iterator i = begin (); i != end (); i++)
-    {
-      PacketMetadata::Deallocate (*i);
-    }
-  PacketMetadata::m_enable = false;
+  return m_pool.GetStats ();
 }
 
 void 
@@ -60,6 +58,15 @@ PacketMetadata::Enable (void)
                  "to call ns3::PacketMetadata::Enable () near the beginning of"
                  " the program, before any packets are sent.");
   m_enable = true;
+  m_lazy = false;
+}
+
+void
+PacketMetadata::EnableLazy (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Enable ();
+  m_lazy = true;
 }
 
 void 
@@ -506,6 +513,7 @@ PacketMetadata::ReplaceTail (PacketMetadata::SmallItem *item,
 
   // create a copy of the packet without its tail.
   PacketMetadata h (m_packetUid, 0);
+  h.m_log = 0;
   uint16_t current = m_head;
   while (current != 0xffff && current != m_tail)
     {
@@ -568,78 +576,150 @@ PacketMetadata::ReadItems (uint16_t current,
 }
 
 struct PacketMetadata::Data *
-PacketMetadata::Create (uint32_t size)
+PacketMetadata::Create (uint32_t n)
 {
-  NS_LOG_FUNCTION (size);
-  NS_LOG_LOGIC ("create size="<<size<<", max="<<m_maxSize);
-  if (size > m_maxSize)
-    {
-      m_maxSize = size;
-    }
-  while (!m_freeList.empty ()) 
+  NS_LOG_FUNCTION (n);
+  if (n <= PACKET_METADATA_DATA_M_DATA_SIZE)
     {
-      struct PacketMetadata::Data *data = m_freeList.back ();
-      m_freeList.pop_back ();
-      if (data->m_size >= size) 
-        {
-          NS_LOG_LOGIC ("create found size="<<data->m_size);
-          data->m_count = 1;
-          return data;
-        }
-      PacketMetadata::Deallocate (data);
-      NS_LOG_LOGIC ("create dealloc size="<<data->m_size);
+      n = PACKET_METADATA_DATA_M_DATA_SIZE;
     }
-  NS_LOG_LOGIC ("create alloc size="<<m_maxSize);
-  return PacketMetadata::Allocate (m_maxSize);
+  uint32_t size = sizeof (struct Data) + n - PACKET_METADATA_DATA_M_DATA_SIZE;
+  struct PacketMetadata::Data *data = static_cast<struct PacketMetadata::Data *> (m_pool.Allocate (size));
+  // use the whole block, within the range of m_size
+  n = size - sizeof (struct Data) + PACKET_METADATA_DATA_M_DATA_SIZE;
+  data->m_size = std::min (n, (uint32_t)std::numeric_limits<uint16_t>::max ());
+  data->m_count = 1;
+  data->m_dirtyEnd = 0;
+  return data;
 }
 
 void
 PacketMetadata::Recycle (struct PacketMetadata::Data *data)
 {
   NS_LOG_FUNCTION (data);
-  if (!m_enable)
-    {
-      PacketMetadata::Deallocate (data);
-      return;
-    } 
-  NS_LOG_LOGIC ("recycle size="<<data->m_size<<", list="<<m_freeList.size ());
   NS_ASSERT (data->m_count == 0);
-  if (m_freeList.size () > 1000 ||
-      data->m_size < m_maxSize) 
-    {
-      PacketMetadata::Deallocate (data);
-    } 
-  else 
-    {
-      m_freeList.push_back (data);
-    }
+  // the data may have been created by another thread
+  uint32_t size = sizeof (struct Data) + data->m_size - PACKET_METADATA_DATA_M_DATA_SIZE;
+  m_pool.Release (data, size);
 }
 
-struct PacketMetadata::Data *
-PacketMetadata::Allocate (uint32_t n)
+
+void
+PacketMetadata::StartLog (uint32_t size)
 {
-  NS_LOG_FUNCTION (n);
-  uint32_t size = sizeof (struct Data);
-  if (n <= PACKET_METADATA_DATA_M_DATA_SIZE)
+  NS_LOG_FUNCTION (this << size);
+  m_log = 0;
+  LogEntry *entry = AddLogEntry (LogEntry::CREATE, 0, size);
+  entry->packetUid = m_packetUid;
+}
+
+PacketMetadata::LogEntry *
+PacketMetadata::AddLogEntry (enum LogEntry::Operation operation, uint32_t uid, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << operation << uid << size);
+  Ptr<LogEntry> entry = ns3::Create<LogEntry> ();
+  entry->operation = operation;
+  entry->uid = uid;
+  entry->size = size;
+  entry->chunkUid = 0;
+  entry->packetUid = 0;
+  entry->prev = m_log;
+  if (operation == LogEntry::CREATE || operation == LogEntry::ADD_HEADER
+      || operation == LogEntry::ADD_TRAILER)
+    {
+      // assigned now, so that the fragments of a header or trailer
+      // built from different copies of the log can still be merged
+      entry->chunkUid = m_chunkUid;
+      m_chunkUid++;
+    }
+  m_log = entry;
+  return PeekPointer (entry);
+}
+
+void
+PacketMetadata::Materialize (void) const
+{
+  if (m_log == 0)
     {
-      n = PACKET_METADATA_DATA_M_DATA_SIZE;
+      return;
     }
-  size += n - PACKET_METADATA_DATA_M_DATA_SIZE;
-  uint8_t *buf = new uint8_t [size];
-  struct PacketMetadata::Data *data = (struct PacketMetadata::Data *)buf;
-  data->m_size = n;
-  data->m_count = 1;
-  data->m_dirtyEnd = 0;
-  return data;
+  NS_LOG_FUNCTION (this);
+  PacketMetadata *self = const_cast<PacketMetadata *> (this);
+  uint64_t uid = m_packetUid;
+  *self = Replay (m_log);
+  // AddAtEnd to an empty metadata takes the uid of the other one
+  self->m_packetUid = uid;
 }
-void 
-PacketMetadata::Deallocate (struct PacketMetadata::Data *data)
+
+PacketMetadata
+PacketMetadata::DeepCopy (void) const
 {
-  NS_LOG_FUNCTION (data);
-  uint8_t *buf = (uint8_t *)data;
-  delete [] buf;
+  NS_LOG_FUNCTION (this);
+  Materialize ();
+  PacketMetadata copy (m_packetUid, 0);
+  copy.m_log = 0;
+  copy.m_data->m_count--;
+  PacketMetadata::Recycle (copy.m_data);
+  copy.m_data = PacketMetadata::Create (m_used);
+  memcpy (copy.m_data->m_data, m_data->m_data, m_used);
+  copy.m_data->m_dirtyEnd = m_used;
+  copy.m_head = m_head;
+  copy.m_tail = m_tail;
+  copy.m_used = m_used;
+  return copy;
 }
 
+PacketMetadata
+PacketMetadata::Replay (Ptr<const LogEntry> log)
+{
+  NS_LOG_FUNCTION (log);
+  std::vector<const LogEntry *> entries;
+  for (const LogEntry *entry = PeekPointer (log); entry != 0; entry = PeekPointer (entry->prev))
+    {
+      entries.push_back (entry);
+    }
+  const LogEntry *create = entries.back ();
+  NS_ASSERT (create->operation == LogEntry::CREATE);
+  PacketMetadata metadata (create->packetUid, 0);
+  metadata.m_log = 0;
+  if (create->size > 0)
+    {
+      metadata.DoAddHeader (0, create->size, create->chunkUid);
+    }
+  for (uint32_t i = entries.size () - 1; i-- > 0; )
+    {
+      const LogEntry *entry = entries[i];
+      switch (entry->operation)
+        {
+        case LogEntry::ADD_HEADER:
+          metadata.DoAddHeader (entry->uid, entry->size, entry->chunkUid);
+          break;
+        case LogEntry::REMOVE_HEADER:
+          metadata.DoRemoveHeader (entry->uid, entry->size);
+          break;
+        case LogEntry::ADD_TRAILER:
+          metadata.DoAddTrailer (entry->uid, entry->size, entry->chunkUid);
+          break;
+        case LogEntry::REMOVE_TRAILER:
+          metadata.DoRemoveTrailer (entry->uid, entry->size);
+          break;
+        case LogEntry::ADD_AT_END:
+          metadata.AddAtEnd (Replay (entry->other));
+          break;
+        case LogEntry::REMOVE_AT_START:
+          metadata.RemoveAtStart (entry->size);
+          break;
+        case LogEntry::REMOVE_AT_END:
+          metadata.RemoveAtEnd (entry->size);
+          break;
+        default:
+          NS_ASSERT (false);
+          break;
+        }
+    }
+  NS_ASSERT (metadata.IsStateOk ());
+  return metadata;
+}
 
 PacketMetadata 
 PacketMetadata::CreateFragment (uint32_t start, uint32_t end) const
@@ -657,6 +737,11 @@ PacketMetadata::AddHeader (const Header &header, uint32_t size)
   NS_LOG_FUNCTION (this << &header << size);
   NS_ASSERT (IsStateOk ());
   uint32_t uid = header.GetInstanceTypeId ().GetUid () << 1;
+  if (m_log != 0)
+    {
+      AddLogEntry (LogEntry::ADD_HEADER, uid, size);
+      return;
+    }
   DoAddHeader (uid, size);
   NS_ASSERT (IsStateOk ());
 }
@@ -669,14 +754,19 @@ PacketMetadata::DoAddHeader (uint32_t uid, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
-
+  DoAddHeader (uid, size, m_chunkUid);
+  m_chunkUid++;
+}
+void
+PacketMetadata::DoAddHeader (uint32_t uid, uint32_t size, uint16_t chunkUid)
+{
+  NS_LOG_FUNCTION (this << uid << size << chunkUid);
   struct PacketMetadata::SmallItem item;
   item.next = m_head;
   item.prev = 0xffff;
   item.typeUid = uid;
   item.size = size;
-  item.chunkUid = m_chunkUid;
-  m_chunkUid++;
+  item.chunkUid = chunkUid;
   uint16_t written = AddSmall (&item);
   UpdateHead (written);
 }
@@ -691,6 +781,17 @@ PacketMetadata::RemoveHeader (const Header &header, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (m_log != 0)
+    {
+      AddLogEntry (LogEntry::REMOVE_HEADER, uid, size);
+      return;
+    }
+  DoRemoveHeader (uid, size);
+}
+void
+PacketMetadata::DoRemoveHeader (uint32_t uid, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << uid << size);
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
   uint32_t read = ReadItems (m_head, &item, &extraItem);
@@ -739,16 +840,27 @@ PacketMetadata::AddTrailer (const Trailer &trailer, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (m_log != 0)
+    {
+      AddLogEntry (LogEntry::ADD_TRAILER, uid, size);
+      return;
+    }
+  DoAddTrailer (uid, size, m_chunkUid);
+  m_chunkUid++;
+  NS_ASSERT (IsStateOk ());
+}
+void
+PacketMetadata::DoAddTrailer (uint32_t uid, uint32_t size, uint16_t chunkUid)
+{
+  NS_LOG_FUNCTION (this << uid << size << chunkUid);
   struct PacketMetadata::SmallItem item;
   item.next = 0xffff;
   item.prev = m_tail;
   item.typeUid = uid;
   item.size = size;
-  item.chunkUid = m_chunkUid;
-  m_chunkUid++;
+  item.chunkUid = chunkUid;
   uint16_t written = AddSmall (&item);
   UpdateTail (written);
-  NS_ASSERT (IsStateOk ());
 }
 void 
 PacketMetadata::RemoveTrailer (const Trailer &trailer, uint32_t size)
@@ -761,6 +873,17 @@ PacketMetadata::RemoveTrailer (const Trailer &trailer, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (m_log != 0)
+    {
+      AddLogEntry (LogEntry::REMOVE_TRAILER, uid, size);
+      return;
+    }
+  DoRemoveTrailer (uid, size);
+}
+void
+PacketMetadata::DoRemoveTrailer (uint32_t uid, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << uid << size);
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
   uint32_t read = ReadItems (m_tail, &item, &extraItem);
@@ -808,6 +931,14 @@ PacketMetadata::AddAtEnd (PacketMetadata const&o)
       m_metadataSkipped = true;
       return;
     }
+  if (m_log != 0 && o.m_log != 0)
+    {
+      AddLogEntry (LogEntry::ADD_AT_END, 0, 0)->other = o.m_log;
+      return;
+    }
+  // one of them has already been built
+  Materialize ();
+  o.Materialize ();
   if (m_tail == 0xffff)
     {
       // We have no items so 'AddAtEnd' is 
@@ -896,6 +1027,11 @@ PacketMetadata::RemoveAtStart (uint32_t start)
       m_metadataSkipped = true;
       return;
     }
+  if (m_log != 0)
+    {
+      AddLogEntry (LogEntry::REMOVE_AT_START, 0, start);
+      return;
+    }
   NS_ASSERT (m_data != 0);
   uint32_t leftToRemove = start;
   uint16_t current = m_head;
@@ -923,6 +1059,7 @@ PacketMetadata::RemoveAtStart (uint32_t start)
         {
           // fragment the list item.
           PacketMetadata fragment (m_packetUid, 0);
+          fragment.m_log = 0;
           extraItem.fragmentStart += leftToRemove;
           leftToRemove = 0;
           uint16_t written = fragment.AddBig (0xffff, fragment.m_tail,
@@ -959,6 +1096,11 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
       m_metadataSkipped = true;
       return;
     }
+  if (m_log != 0)
+    {
+      AddLogEntry (LogEntry::REMOVE_AT_END, 0, end);
+      return;
+    }
   NS_ASSERT (m_data != 0);
 
   uint32_t leftToRemove = end;
@@ -987,6 +1129,7 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
         {
           // fragment the list item.
           PacketMetadata fragment (m_packetUid, 0);
+          fragment.m_log = 0;
           NS_ASSERT (extraItem.fragmentEnd > leftToRemove);
           extraItem.fragmentEnd -= leftToRemove;
           leftToRemove = 0;
@@ -1047,6 +1190,7 @@ PacketMetadata::ItemIterator
 PacketMetadata::BeginItem (Buffer buffer) const
 {
   NS_LOG_FUNCTION (this << &buffer);
+  Materialize ();
   return ItemIterator (this, buffer);
 }
 PacketMetadata::ItemIterator::ItemIterator (const PacketMetadata *metadata, Buffer buffer)
@@ -1138,6 +1282,7 @@ uint32_t
 PacketMetadata::GetSerializedSize (void) const
 {
   NS_LOG_FUNCTION (this);
+  Materialize ();
   uint32_t totalSize = 0;
 
   // add 8 bytes for the packet uid
@@ -1183,6 +1328,7 @@ uint32_t
 PacketMetadata::Serialize (uint8_t* buffer, uint32_t maxSize) const
 {
   NS_LOG_FUNCTION (this << &buffer << maxSize);
+  Materialize ();
   uint8_t* start = buffer;
 
   buffer = AddToRawU64 (m_packetUid, start, buffer, maxSize);
@@ -1284,6 +1430,7 @@ uint32_t
 PacketMetadata::Deserialize (const uint8_t* buffer, uint32_t size)
 {
   NS_LOG_FUNCTION (this << &buffer << size);
+  m_log = 0;
   const uint8_t* start = buffer;
   uint32_t desSize = size - 4;
 
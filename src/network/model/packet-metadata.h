@@ -26,7 +26,10 @@
 #include "ns3/callback.h"
 #include "ns3/assert.h"
 #include "ns3/type-id.h"
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
 #include "buffer.h"
+#include "data-pool.h"
 
 namespace ns3 {
 
@@ -74,6 +77,11 @@ class Trailer;
  * integers, and some others as variable-size 32-bit integers.
  * The variable-size 32 bit integers are stored using the uleb128
  * encoding.
+ *
+ * When enabled with EnableLazy, the metadata only records a log of
+ * the operations, shared by the copies of the metadata, and builds
+ * the linked list from this log when it is needed, i.e., by
+ * BeginItem, GetSerializedSize and Serialize.
  */
 class PacketMetadata 
 {
@@ -155,10 +163,23 @@ private:
    * \brief Enable the packet metadata
    */
   static void Enable (void);
+  /**
+   * \brief Enable the packet metadata, built from a log of the
+   * operations only when it is needed
+   *
+   * This applies to the metadata created after the call, until
+   * Enable is called again.
+   */
+  static void EnableLazy (void);
   /**
    * \brief Enable the packet metadata checking
    */
   static void EnableChecking (void);
+  /**
+   * \brief Get the statistics of the metadata data pool of the calling thread
+   * \returns the statistics
+   */
+  static struct DataPool::Stats GetPoolStats (void);
 
   /**
    * \brief Constructor
@@ -270,6 +291,16 @@ private:
    */
   uint32_t Deserialize (const uint8_t* buffer, uint32_t size);
 
+  /**
+   * \brief Create a copy of the metadata which does not share its
+   * data storage, nor its operation log, with this metadata.
+   *
+   * A lazy metadata is built from its log first.
+   *
+   * \returns the copy of the metadata
+   */
+  PacketMetadata DeepCopy (void) const;
+
 private:
   /**
    * \brief Helper for the raw serialization.
@@ -492,15 +523,32 @@ private:
   };
 
   /**
-   * \brief Class to hold all the metadata
+   * \brief An operation in the log of a lazy metadata
+   *
+   * The log is a list of the operations, from the last one to the
+   * creation of the metadata, shared by the copies of the metadata.
    */
-  class DataFreeList : public std::vector<struct Data *>
+  struct LogEntry : public SimpleRefCount<LogEntry>
   {
-public:
-    ~DataFreeList ();
+    /** The operations */
+    enum Operation {
+      CREATE,           //!< Creation, with a payload of size bytes
+      ADD_HEADER,       //!< AddHeader
+      REMOVE_HEADER,    //!< RemoveHeader
+      ADD_TRAILER,      //!< AddTrailer
+      REMOVE_TRAILER,   //!< RemoveTrailer
+      ADD_AT_END,       //!< AddAtEnd of the metadata logged in other
+      REMOVE_AT_START,  //!< RemoveAtStart
+      REMOVE_AT_END     //!< RemoveAtEnd
+    } operation; //!< The operation
+    uint32_t uid; //!< Uid of the header or trailer type
+    uint32_t size; //!< Size of the operation
+    uint16_t chunkUid; //!< Chunk uid of the added header, trailer or payload
+    uint64_t packetUid; //!< Packet uid, for CREATE
+    Ptr<const LogEntry> prev; //!< The previous operation, or 0 for CREATE
+    Ptr<const LogEntry> other; //!< The log of the other metadata, for ADD_AT_END
   };
 
-  friend DataFreeList::~DataFreeList ();
   friend class ItemIterator;
 
   PacketMetadata ();
@@ -615,6 +663,56 @@ public:
    * \param size header serialized size
    */
   void DoAddHeader (uint32_t uid, uint32_t size);
+  /**
+   * \brief Add an header with a given chunk uid
+   * \param uid header's uid to add
+   * \param size header serialized size
+   * \param chunkUid the chunk uid of the header
+   */
+  void DoAddHeader (uint32_t uid, uint32_t size, uint16_t chunkUid);
+  /**
+   * \brief Remove an header
+   * \param uid header's uid to remove
+   * \param size header serialized size
+   */
+  void DoRemoveHeader (uint32_t uid, uint32_t size);
+  /**
+   * \brief Add a trailer
+   * \param uid trailer's uid to add
+   * \param size trailer serialized size
+   * \param chunkUid the chunk uid of the trailer
+   */
+  void DoAddTrailer (uint32_t uid, uint32_t size, uint16_t chunkUid);
+  /**
+   * \brief Remove a trailer
+   * \param uid trailer's uid to remove
+   * \param size trailer serialized size
+   */
+  void DoRemoveTrailer (uint32_t uid, uint32_t size);
+  /**
+   * \brief Start the log of a lazy metadata
+   * \param size the size of the payload
+   */
+  void StartLog (uint32_t size);
+  /**
+   * \brief Add an operation to the log of a lazy metadata
+   * \param operation the operation
+   * \param uid the uid of the header or trailer type
+   * \param size the size of the operation
+   * \returns the new log entry
+   */
+  LogEntry *AddLogEntry (enum LogEntry::Operation operation, uint32_t uid, uint32_t size);
+  /**
+   * \brief Build the linked list of a lazy metadata from its log,
+   * which makes it an eager metadata
+   */
+  void Materialize (void) const;
+  /**
+   * \brief Build a metadata by replaying a log
+   * \param log the last operation of the log
+   * \returns the metadata
+   */
+  static PacketMetadata Replay (Ptr<const LogEntry> log);
   /**
    * \brief Check if the metadata state is ok
    * \returns true if the internal state is ok
@@ -645,19 +743,13 @@ public:
    */
   static struct PacketMetadata::Data *Create (uint32_t size);
   /**
-   * \brief Allocate a buffer data storage
-   * \param n the storage size to create
-   * \returns a pointer to the allocated buffer storage
-   */
-  static struct PacketMetadata::Data *Allocate (uint32_t n);
-  /**
-   * \brief Deallocate the buffer memory
-   * \param data the buffer data storage
+   * The metadata data pool of this thread: each thread has its own
+   * pool, so that packets can be handled by several threads at the
+   * same time (see ns3::MultithreadedSimulatorImpl).
    */
-  static void Deallocate (struct PacketMetadata::Data *data);
-
-  static DataFreeList m_freeList; //!< the metadata data storage
+  static __thread DataPool m_pool;
   static bool m_enable; //!< Enable the packet metadata
+  static bool m_lazy; //!< Log the operations, and build the metadata on demand
   static bool m_enableChecking; //!< Enable the packet metadata checking
 
   /**
@@ -667,7 +759,6 @@ public:
    */
   static bool m_metadataSkipped;
 
-  static uint32_t m_maxSize; //!< maximum metadata size
   static uint16_t m_chunkUid; //!< Chunk Uid
 
   struct Data *m_data; //!< Metadata storage
@@ -680,6 +771,7 @@ public:
   uint16_t m_tail; //!< list tail
   uint16_t m_used; //!< used portion
   uint64_t m_packetUid; //!< packet Uid
+  Ptr<const LogEntry> m_log; //!< Operation log if lazy, 0 otherwise
 };
 
 } // namespace ns3
@@ -694,7 +786,11 @@ PacketMetadata::PacketMetadata (uint64_t uid, uint32_t size)
     m_packetUid (uid)
 {
   memset (m_data->m_data, 0xff, 4);
-  if (size > 0)
+  if (m_lazy)
+    {
+      StartLog (size);
+    }
+  else if (size > 0)
     {
       DoAddHeader (0, size);
     }
@@ -704,7 +800,8 @@ PacketMetadata::PacketMetadata (PacketMetadata const &o)
     m_head (o.m_head),
     m_tail (o.m_tail),
     m_used (o.m_used),
-    m_packetUid (o.m_packetUid)
+    m_packetUid (o.m_packetUid),
+    m_log (o.m_log)
 {
   NS_ASSERT (m_data != 0);
   NS_ASSERT (m_data->m_count < std::numeric_limits<uint32_t>::max());
@@ -730,6 +827,7 @@ PacketMetadata::operator = (PacketMetadata const& o)
   m_tail = o.m_tail;
   m_used = o.m_used;
   m_packetUid = o.m_packetUid;
+  m_log = o.m_log;
   return *this;
 }
 PacketMetadata::~PacketMetadata ()
@@ -154,9 +154,40 @@ PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
 
 }
 
+uint32_t
+PacketTagList::FindInline (TypeId tid) const
+{
+  uint32_t i = 0;
+  while (i < m_nInline && m_inline[i].tid != tid)
+    {
+      i++;
+    }
+  return i;
+}
+
+void
+PacketTagList::RemoveInline (uint32_t i)
+{
+  NS_ASSERT (i < m_nInline);
+  m_nInline--;
+  for (; i < m_nInline; ++i)
+    {
+      m_inline[i] = m_inline[i + 1];
+    }
+}
+
 bool
 PacketTagList::Remove (Tag & tag)
 {
+  uint32_t i = FindInline (tag.GetInstanceTypeId ());
+  if (i < m_nInline)
+    {
+      NS_LOG_INFO ("found inline tag " << i);
+      tag.Deserialize (TagBuffer (m_inline[i].data,
+                                  m_inline[i].data + INLINE_SIZE));
+      RemoveInline (i);
+      return true;
+    }
   return COWTraverse (tag, &PacketTagList::RemoveWriter);
 }
 
@@ -196,6 +227,21 @@ PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
 bool
 PacketTagList::Replace (Tag & tag)
 {
+  uint32_t i = FindInline (tag.GetInstanceTypeId ());
+  if (i < m_nInline)
+    {
+      NS_LOG_INFO ("found inline tag " << i);
+      uint32_t size = tag.GetSerializedSize ();
+      if (size <= INLINE_SIZE)
+        {
+          tag.Serialize (TagBuffer (m_inline[i].data, m_inline[i].data + size));
+          return true;
+        }
+      // the new value is too large to stay inline
+      RemoveInline (i);
+      Add (tag);
+      return true;
+    }
   bool found = COWTraverse (tag, &PacketTagList::ReplaceWriter);
   if (!found)
     {
@@ -245,10 +291,21 @@ PacketTagList::Add (const Tag &tag) const
 {
   NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
   // ensure this id was not yet added
+  NS_ASSERT_MSG (FindInline (tag.GetInstanceTypeId ()) == m_nInline, "Error: cannot add the same kind of tag twice.");
   for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
     {
       NS_ASSERT_MSG (cur->tid != tag.GetInstanceTypeId (), "Error: cannot add the same kind of tag twice.");
     }
+  uint32_t size = tag.GetSerializedSize ();
+  if (size <= INLINE_SIZE && m_nInline < INLINE_TAGS)
+    {
+      PacketTagList *self = const_cast<PacketTagList *> (this);
+      struct InlineTag *slot = &self->m_inline[m_nInline];
+      slot->tid = tag.GetInstanceTypeId ();
+      tag.Serialize (TagBuffer (slot->data, slot->data + size));
+      self->m_nInline++;
+      return;
+    }
   struct TagData * head = new struct TagData ();
   head->count = 1;
   head->next = 0;
@@ -265,6 +322,14 @@ PacketTagList::Peek (Tag &tag) const
 {
   NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
   TypeId tid = tag.GetInstanceTypeId ();
+  uint32_t i = FindInline (tid);
+  if (i < m_nInline)
+    {
+      /* found inline tag */
+      tag.Deserialize (TagBuffer (const_cast<uint8_t *> (m_inline[i].data),
+                                  const_cast<uint8_t *> (m_inline[i].data) + INLINE_SIZE));
+      return true;
+    }
   for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
     {
       if (cur->tid == tid) 
@@ -284,5 +349,17 @@ PacketTagList::Head (void) const
   return m_next;
 }
 
+const struct PacketTagList::InlineTag *
+PacketTagList::InlineHead (void) const
+{
+  return m_inline;
+}
+
+uint32_t
+PacketTagList::GetNInline (void) const
+{
+  return m_nInline;
+}
+
 } /* namespace ns3 */
 
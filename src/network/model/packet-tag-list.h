@@ -120,6 +120,16 @@ class Tag;
  *       shared. This portion is copied before the #Remove or #Replace is
  *       performed.
  *
+ * \par <b> Inline tags: </b>
+ * \n
+ * The first #INLINE_TAGS tags which serialize to at most #INLINE_SIZE
+ * bytes, such as FlowIdTag or SocketIpTosTag, are stored by value in
+ * the PacketTagList itself rather than in the tree, so that a packet
+ * carrying only a few small tags needs no heap allocation.  The inline
+ * tags are copied along with the PacketTagList, which is cheap at this
+ * size, and are not shared.  The tags added once the inline area is
+ * full, and the larger tags, go in the tree as described above.
+ *
  * \par <b> Memory Management: </b>
  * \n
  * Packet tags must serialize to a finite maximum size, see TagData
@@ -167,6 +177,22 @@ public:
     uint32_t count;           /**< Number of incoming links */
   };  /* struct TagData */
 
+  /** Limits of the inline tags. */
+  enum InlineTag_e
+  {
+    INLINE_TAGS = 3,          /**< Number of inline tags */
+    INLINE_SIZE = 16          /**< Maximum size of an inline tag */
+  };
+
+  /**
+   * A tag stored inline in the PacketTagList.
+   */
+  struct InlineTag
+  {
+    uint8_t data[INLINE_SIZE];  /**< Serialization buffer */
+    TypeId tid;                 /**< Type of the tag serialized into #data */
+  };  /* struct InlineTag */
+
   /**
    * Create a new PacketTagList.
    */
@@ -234,9 +260,18 @@ public:
    */
   inline void RemoveAll (void);
   /**
-   * \returns pointer to head of tag list
+   * \returns pointer to head of tag list, which does not include
+   *          the inline tags
    */
   const struct PacketTagList::TagData *Head (void) const;
+  /**
+   * \returns pointer to the first inline tag
+   */
+  const struct PacketTagList::InlineTag *InlineHead (void) const;
+  /**
+   * \returns the number of inline tags
+   */
+  uint32_t GetNInline (void) const;
 
 private:
   /**
@@ -286,11 +321,34 @@ private:
    * \returns True, since tag value will definitely be replaced.
    */
   bool ReplaceWriter (Tag & tag, bool preMerge, struct TagData * cur, struct TagData ** prevNext);
+  /**
+   * Find an inline tag.
+   *
+   * \param [in] tid The type of the tag.
+   * \returns The index of the inline tag, or #m_nInline if not found.
+   */
+  uint32_t FindInline (TypeId tid) const;
+  /**
+   * Remove an inline tag, keeping the others in order.
+   *
+   * \param [in] i The index of the inline tag.
+   */
+  void RemoveInline (uint32_t i);
+  /**
+   * Copy the inline tags of another PacketTagList.
+   *
+   * \param [in] o The PacketTagList to copy.
+   */
+  inline void CopyInline (PacketTagList const &o);
 
   /**
    * Pointer to first \ref TagData on the list
    */
   struct TagData *m_next;
+  /** The inline tags, in the order they were added. */
+  struct InlineTag m_inline[INLINE_TAGS];
+  /** Number of inline tags. */
+  uint8_t m_nInline;
 };
 
 } // namespace ns3
@@ -302,13 +360,15 @@ private:
 namespace ns3 {
 
 PacketTagList::PacketTagList ()
-  : m_next ()
+  : m_next (),
+    m_nInline (0)
 {
 }
 
 PacketTagList::PacketTagList (PacketTagList const &o)
   : m_next (o.m_next)
 {
+  CopyInline (o);
   if (m_next != 0)
     {
       m_next->count++;
@@ -318,16 +378,19 @@ PacketTagList::PacketTagList (PacketTagList const &o)
 PacketTagList &
 PacketTagList::operator = (PacketTagList const &o)
 {
-  // self assignment
-  if (m_next == o.m_next) 
+  // self assignment, or same tree
+  if (m_next != o.m_next) 
     {
-      return *this;
+      RemoveAll ();
+      m_next = o.m_next;
+      if (m_next != 0) 
+        {
+          m_next->count++;
+        }
     }
-  RemoveAll ();
-  m_next = o.m_next;
-  if (m_next != 0) 
+  if (this != &o)
     {
-      m_next->count++;
+      CopyInline (o);
     }
   return *this;
 }
@@ -337,6 +400,16 @@ PacketTagList::~PacketTagList ()
   RemoveAll ();
 }
 
+void
+PacketTagList::CopyInline (PacketTagList const &o)
+{
+  m_nInline = o.m_nInline;
+  for (uint32_t i = 0; i < m_nInline; ++i)
+    {
+      m_inline[i] = o.m_inline[i];
+    }
+}
+
 void
 PacketTagList::RemoveAll (void)
 {
@@ -359,6 +432,7 @@ PacketTagList::RemoveAll (void)
       delete prev;
     }
   m_next = 0;
+  m_nInline = 0;
 }
 
 } // namespace ns3
@@ -23,12 +23,13 @@
 #include "ns3/simulator.h"
 #include <string>
 #include <cstdarg>
+#include <vector>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Packet");
 
-uint32_t Packet::m_globalUid = 0;
+__thread uint32_t Packet::m_globalUid = 0;
 
 TypeId 
 ByteTagIterator::Item::GetTypeId (void) const
@@ -81,40 +82,52 @@ ByteTagIterator::ByteTagIterator (ByteTagList::Iterator i)
 }
 
 
-PacketTagIterator::PacketTagIterator (const struct PacketTagList::TagData *head)
-  : m_current (head)
+PacketTagIterator::PacketTagIterator (const PacketTagList &list)
+  : m_inline (list.InlineHead ()),
+    m_nInline (list.GetNInline ()),
+    m_current (list.Head ())
 {
 }
 bool
 PacketTagIterator::HasNext (void) const
 {
-  return m_current != 0;
+  return m_nInline != 0 || m_current != 0;
 }
 PacketTagIterator::Item
 PacketTagIterator::Next (void)
 {
   NS_ASSERT (HasNext ());
+  if (m_nInline != 0)
+    {
+      const struct PacketTagList::InlineTag *prev = m_inline;
+      m_inline++;
+      m_nInline--;
+      return PacketTagIterator::Item (prev->tid, prev->data,
+                                      PacketTagList::INLINE_SIZE);
+    }
   const struct PacketTagList::TagData *prev = m_current;
   m_current = m_current->next;
-  return PacketTagIterator::Item (prev);
+  return PacketTagIterator::Item (prev->tid, prev->data,
+                                  PacketTagList::TagData::MAX_SIZE);
 }
 
-PacketTagIterator::Item::Item (const struct PacketTagList::TagData *data)
-  : m_data (data)
+PacketTagIterator::Item::Item (TypeId tid, const uint8_t *data, uint32_t size)
+  : m_tid (tid),
+    m_data (data),
+    m_size (size)
 {
 }
 TypeId
 PacketTagIterator::Item::GetTypeId (void) const
 {
-  return m_data->tid;
+  return m_tid;
 }
 void
 PacketTagIterator::Item::GetTag (Tag &tag) const
 {
-  NS_ASSERT (tag.GetInstanceTypeId () == m_data->tid);
-  tag.Deserialize (TagBuffer ((uint8_t*)m_data->data,
-                              (uint8_t*)m_data->data
-                              + PacketTagList::TagData::MAX_SIZE));
+  NS_ASSERT (tag.GetInstanceTypeId () == m_tid);
+  tag.Deserialize (TagBuffer ((uint8_t*)m_data,
+                              (uint8_t*)m_data + m_size));
 }
 
 
@@ -127,6 +140,57 @@ Packet::Copy (void) const
   return Ptr<Packet> (new Packet (*this), false);
 }
 
+Ptr<Packet>
+Packet::DeepCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  Buffer buffer = m_buffer.DeepCopy ();
+  PacketMetadata metadata = m_metadata.DeepCopy ();
+
+  ByteTagList byteTagList;
+  byteTagList.Add (m_byteTagList);
+
+  // the inline packet tags are added first, in order, so that they stay
+  // inline; the other packet tags are added at the head of the list, in
+  // reverse order
+  std::vector<PacketTagIterator::Item> tags;
+  const struct PacketTagList::InlineTag *inlineTags = m_packetTagList.InlineHead ();
+  for (uint32_t i = 0; i < m_packetTagList.GetNInline (); ++i)
+    {
+      tags.push_back (PacketTagIterator::Item (inlineTags[i].tid, inlineTags[i].data,
+                                               PacketTagList::INLINE_SIZE));
+    }
+  std::vector<PacketTagIterator::Item>::size_type nInline = tags.size ();
+  for (const PacketTagList::TagData *cur = m_packetTagList.Head (); cur != 0; cur = cur->next)
+    {
+      tags.insert (tags.begin () + nInline,
+                   PacketTagIterator::Item (cur->tid, cur->data,
+                                            PacketTagList::TagData::MAX_SIZE));
+    }
+  PacketTagList packetTagList;
+  for (std::vector<PacketTagIterator::Item>::const_iterator i = tags.begin ();
+       i != tags.end (); ++i)
+    {
+      Callback<ObjectBase *> constructor = i->GetTypeId ().GetConstructor ();
+      if (constructor.IsNull ())
+        {
+          NS_FATAL_ERROR ("Packet tag " << i->GetTypeId ().GetName () << " has no constructor and cannot be copied");
+        }
+      Tag *tag = dynamic_cast<Tag *> (constructor ());
+      NS_ASSERT (tag != 0);
+      i->GetTag (*tag);
+      packetTagList.Add (*tag);
+      delete tag;
+    }
+
+  Ptr<Packet> copy = Ptr<Packet> (new Packet (buffer, byteTagList, packetTagList, metadata), false);
+  if (m_nixVector)
+    {
+      copy->SetNixVector (m_nixVector->Copy ());
+    }
+  return copy;
+}
+
 Packet::Packet ()
   : m_buffer (),
     m_byteTagList (),
@@ -538,6 +602,13 @@ Packet::EnablePrinting (void)
   PacketMetadata::Enable ();
 }
 
+void
+Packet::EnableLazyPrinting (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  PacketMetadata::EnableLazy ();
+}
+
 void
 Packet::EnableChecking (void)
 {
@@ -881,7 +952,7 @@ Packet::PrintPacketTags (std::ostream &os) const
 PacketTagIterator 
 Packet::GetPacketTagIterator (void) const
 {
-  return PacketTagIterator (m_packetTagList.Head ());
+  return PacketTagIterator (m_packetTagList);
 }
 
 std::ostream& operator<< (std::ostream& os, const Packet &packet)
@@ -150,12 +150,17 @@ public:
     void GetTag (Tag &tag) const;
 private:
     friend class PacketTagIterator;
+    friend class Packet;
     /**
      * Constructor
-     * \param data the data to copy.
+     * \param tid the ns3::TypeId associated to this tag.
+     * \param data the serialized tag.
+     * \param size the size of the serialization buffer.
      */
-    Item (const struct PacketTagList::TagData *data);
-    const struct PacketTagList::TagData *m_data; //!< the tag data
+    Item (TypeId tid, const uint8_t *data, uint32_t size);
+    TypeId m_tid;          //!< the ns3::TypeId associated to this tag
+    const uint8_t *m_data; //!< the serialized tag
+    uint32_t m_size;       //!< the size of the serialization buffer
   };
   /**
    * \returns true if calling Next is safe, false otherwise.
@@ -169,9 +174,11 @@ private:
   friend class Packet;
   /**
    * Constructor
-   * \param head head of the items
+   * \param list the list of the items
    */
-  PacketTagIterator (const struct PacketTagList::TagData *head);
+  PacketTagIterator (const PacketTagList &list);
+  const struct PacketTagList::InlineTag *m_inline; //!< next inline tag
+  uint32_t m_nInline;                               //!< number of inline tags left
   const struct PacketTagList::TagData *m_current;  //!< actual position over the set of tags in a packet
 };
 
@@ -424,6 +431,24 @@ public:
    */
   Ptr<Packet> Copy (void) const;
 
+  /**
+   * \brief performs a deep copy of the packet.
+   *
+   * \returns a deep copy of the packet.
+   *
+   * Unlike Copy, the returned packet does not share its buffer,
+   * its metadata, its tags or its nix-vector with the original packet.
+   * The reference counts of these datasets are not atomic, hence two
+   * threads must not use packets which share them: this method allows
+   * a packet to be handed over to another thread. The bytes of the buffer
+   * and the metadata are copied directly, without serializing them, and
+   * the zero area of the buffer stays virtual; a lazy metadata is built
+   * from its log first. The packet tags are copied through their Tag
+   * interface, hence they must have a constructor registered in their
+   * TypeId.
+   */
+  Ptr<Packet> DeepCopy (void) const;
+
   /**
    * \brief Returns the packet's Uid.
    *
@@ -490,6 +515,18 @@ public:
    * simulation setup and before any packet is created.
    */
   static void EnablePrinting (void);
+  /**
+   * \brief Enable printing packets metadata, built on demand.
+   *
+   * Like EnablePrinting, but the packets only keep a log of the
+   * operations on their headers and trailers: the metadata is built
+   * from this log for the packets which are printed, inspected with
+   * BeginItem, or serialized. This is cheaper when only a few packets
+   * are printed, e.g., by a trace sink filtering them. An inconsistent
+   * header or trailer removal is detected when the metadata is built,
+   * rather than when the header or trailer is removed.
+   */
+  static void EnableLazyPrinting (void);
   /**
    * \brief Enable packets metadata checking.
    *
@@ -545,6 +582,9 @@ public:
   /**
    * \brief Retiurns an iterator over the set of byte tags included in this packet
    *
+   * The iterator may point inside this packet: it must not be used after
+   * the packet is modified or destroyed.
+   *
    * \returns an iterator over the set of byte tags included in this packet.
    */
   ByteTagIterator GetByteTagIterator (void) const;
@@ -721,7 +761,12 @@ private:
   /* Please see comments above about nix-vector */
   Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
-  static uint32_t m_globalUid; //!< Global counter of packets Uid
+  /**
+   * Counter of packets Uid of this thread: the threads of a multithreaded
+   * simulation have different system ids, which make up the upper 32 bits
+   * of the Uid.
+   */
+  static __thread uint32_t m_globalUid;
 };
 
 /**
@@ -19,9 +19,12 @@
  */
 
 #include "ns3/buffer.h"
+#include "ns3/data-pool.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/double.h"
 #include "ns3/test.h"
+#include <cstring>
+#include <vector>
 
 using namespace ns3;
 
@@ -359,6 +362,106 @@ BufferTest::DoRun (void)
   val2 <<= 8;
   val2 |= i.ReadU8 ();
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
+
+  // reassembling fragments keeps the zero area virtual
+  buffer = Buffer (2000);
+  buffer.AddAtStart (4);
+  buffer.Begin ().WriteHtonU32 (0x01020304);
+  buffer.AddAtEnd (2);
+  i = buffer.End ();
+  i.Prev (2);
+  i.WriteU8 (0x5);
+  i.WriteU8 (0x6);
+  Buffer head = buffer.CreateFragment (0, 500);
+  Buffer middle = buffer.CreateFragment (500, 1000);
+  Buffer tail = buffer.CreateFragment (1500, 506);
+  middle.AddAtEnd (tail);
+  head.AddAtEnd (middle);
+  NS_TEST_ASSERT_MSG_EQ (head.GetSize (), 2006, "Bad reassembled size");
+  NS_TEST_ASSERT_MSG_EQ (head.GetSerializedSize (), buffer.GetSerializedSize (),
+                         "The zero area of the fragments was written out");
+  uint8_t expected[2006];
+  uint8_t got[2006];
+  buffer.CopyData (expected, 2006);
+  head.CopyData (got, 2006);
+  NS_TEST_ASSERT_MSG_EQ (memcmp (expected, got, 2006), 0, "Bad reassembled content");
+  i = head.Begin ();
+  NS_TEST_ASSERT_MSG_EQ (i.ReadNtohU32 (), 0x01020304, "Bad reassembled header");
+  // fragments with real bytes between their zero areas are written out
+  Buffer gap = tail;
+  gap.AddAtEnd (buffer.CreateFragment (0, 100));
+  NS_TEST_ASSERT_MSG_EQ (gap.GetSize (), 606, "Bad concatenated size");
+  gap.CopyData (got, 606);
+  NS_TEST_ASSERT_MSG_EQ (memcmp (expected + 1500, got, 506), 0, "Bad concatenated content");
+  NS_TEST_ASSERT_MSG_EQ (memcmp (expected, got + 506, 100), 0, "Bad concatenated content");
+}
+//-----------------------------------------------------------------------------
+class DataPoolTest : public TestCase {
+public:
+  virtual void DoRun (void);
+  DataPoolTest ();
+};
+
+DataPoolTest::DataPoolTest ()
+  : TestCase ("DataPool") {
+}
+
+void
+DataPoolTest::DoRun (void)
+{
+  DataPool pool = DataPool ();
+  uint32_t size = 100;
+  void *small = pool.Allocate (size);
+  NS_TEST_ASSERT_MSG_EQ (size, 128, "Size not rounded up to its class");
+  pool.Release (small, size);
+  size = 9000;
+  void *large = pool.Allocate (size);
+  NS_TEST_ASSERT_MSG_EQ (size, 16384, "Size not rounded up to its class");
+  NS_TEST_ASSERT_MSG_NE (large, small, "Block reused for another class");
+  pool.Release (large, size);
+  size = 120;
+  NS_TEST_ASSERT_MSG_EQ (pool.Allocate (size), small, "Block not reused");
+  pool.Release (small, size);
+  size = 100000;
+  void *huge = pool.Allocate (size);
+  NS_TEST_ASSERT_MSG_EQ (size, 100000, "Size larger than the classes rounded up");
+  pool.Release (huge, size);
+
+  DataPool::Stats stats = pool.GetStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats.hits, 1, "Bad number of hits");
+  NS_TEST_ASSERT_MSG_EQ (stats.misses, 3, "Bad number of misses");
+  NS_TEST_ASSERT_MSG_EQ (stats.recycled, 3, "Bad number of recycled blocks");
+  NS_TEST_ASSERT_MSG_EQ (stats.released, 1, "Bad number of released blocks");
+  NS_TEST_ASSERT_MSG_EQ (stats.bytes, 128 + 16384, "Bad number of bytes");
+  NS_TEST_ASSERT_MSG_EQ (stats.peakBytes, 128 + 16384 + 100000, "Bad peak number of bytes");
+
+  // the free lists are bounded
+  std::vector<void *> blocks;
+  for (uint32_t i = 0; i < 20; i++)
+    {
+      size = 65536;
+      blocks.push_back (pool.Allocate (size));
+    }
+  for (uint32_t i = 0; i < 20; i++)
+    {
+      pool.Release (blocks[i], size);
+    }
+  stats = pool.GetStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats.released, 1 + 20 - DataPool::MAX_CACHED / 65536, "Free list not bounded");
+
+  pool.Destroy ();
+  stats = pool.GetStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats.bytes, 0, "Blocks not released");
+
+  // the buffers recycle their data
+  DataPool::Stats before = Buffer::GetPoolStats ();
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Buffer buffer (100);
+      buffer.AddAtStart (8);
+    }
+  DataPool::Stats after = Buffer::GetPoolStats ();
+  NS_TEST_ASSERT_MSG_GT (after.hits, before.hits, "Buffer data not reused");
 }
 //-----------------------------------------------------------------------------
 class BufferTestSuite : public TestSuite
@@ -371,6 +474,7 @@ BufferTestSuite::BufferTestSuite ()
   : TestSuite ("buffer", UNIT)
 {
   AddTestCase (new BufferTest, TestCase::QUICK);
+  AddTestCase (new DataPoolTest, TestCase::QUICK);
 }
 
 static BufferTestSuite g_bufferTestSuite;
@@ -252,16 +252,21 @@ HistoryTrailer<N>::Deserialize (Buffer::Iterator start)
 
 class PacketMetadataTest : public TestCase {
 public:
-  PacketMetadataTest ();
+  /**
+   * \param lazy Build the metadata from a log of the operations
+   */
+  PacketMetadataTest (bool lazy);
   virtual ~PacketMetadataTest ();
   void CheckHistory (Ptr<Packet> p, const char *file, int line, uint32_t n, ...);
   virtual void DoRun (void);
 private:
   Ptr<Packet> DoAddHeader (Ptr<Packet> p);
+  bool m_lazy;
 };
 
-PacketMetadataTest::PacketMetadataTest ()
-  : TestCase ("Packet metadata")
+PacketMetadataTest::PacketMetadataTest (bool lazy)
+  : TestCase (lazy ? "Lazy packet metadata" : "Packet metadata"),
+    m_lazy (lazy)
 {
 }
 
@@ -398,7 +403,14 @@ PacketMetadataTest::DoAddHeader (Ptr<Packet> p)
 void
 PacketMetadataTest::DoRun (void)
 {
-  PacketMetadata::Enable ();
+  if (m_lazy)
+    {
+      PacketMetadata::EnableLazy ();
+    }
+  else
+    {
+      PacketMetadata::Enable ();
+    }
 
   Ptr<Packet> p = Create<Packet> (0);
   Ptr<Packet> p1 = Create<Packet> (0);
@@ -821,6 +833,27 @@ PacketMetadataTest::DoRun (void)
                                  p3->GetSize ());
   delete [] buf;
   NS_TEST_EXPECT_MSG_EQ (msg, std::string ("hello world"), "Could not find original data in received packet");
+
+  // the fragments of a header built from two copies of the same
+  // history are merged back
+  p = Create<Packet> (10);
+  ADD_HEADER (p, 20);
+  ADD_TRAILER (p, 8);
+  p1 = p->CreateFragment (0, 15);
+  p2 = p->CreateFragment (15, 23);
+  REM_TRAILER (p2, 8);
+  p1->AddAtEnd (p2);
+  ADD_HEADER (p1, 5);
+  p3 = p1->Copy ();
+  REM_HEADER (p3, 5);
+  CHECK_HISTORY (p3, 2, 20, 10);
+  CHECK_HISTORY (p1, 3, 5, 20, 10);
+  CHECK_HISTORY (p, 3, 20, 10, 8);
+
+  if (m_lazy)
+    {
+      PacketMetadata::Enable ();
+    }
 }
 //-----------------------------------------------------------------------------
 class PacketMetadataTestSuite : public TestSuite
@@ -832,7 +865,8 @@ public:
 PacketMetadataTestSuite::PacketMetadataTestSuite ()
   : TestSuite ("packet-metadata", UNIT)
 {
-  AddTestCase (new PacketMetadataTest, TestCase::QUICK);
+  AddTestCase (new PacketMetadataTest (false), TestCase::QUICK);
+  AddTestCase (new PacketMetadataTest (true), TestCase::QUICK);
 }
 
 PacketMetadataTestSuite g_packetMetadataTest;
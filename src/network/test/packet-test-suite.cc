@@ -27,6 +27,7 @@
 #include <iostream>
 #include <iomanip>
 #include <ctime>
+#include <cstring>
 
 using namespace ns3;
 
@@ -582,6 +583,71 @@ PacketTest::DoRun (void)
     tmp->AddPaddingAtEnd (50);
     CHECK (tmp, 1, E (25, 0, 50));
   }
+
+  /* Test DeepCopy: the copy keeps the bytes and the tags, and does
+   * not share them with the original.
+   */
+  {
+    Ptr<Packet> tmp = Create<Packet> (100);
+    tmp->AddHeader (ATestHeader<10> ());
+    tmp->AddByteTag (ATestTag<20> ());
+    tmp->AddPacketTag (ATestTag<3> (7));
+    Ptr<Packet> copy = tmp->DeepCopy ();
+    NS_TEST_EXPECT_MSG_EQ (copy->GetSize (), 110, "Wrong size of the copy");
+    CHECK (copy, 1, E (20, 0, 110));
+    ATestTag<3> tag;
+    NS_TEST_EXPECT_MSG_EQ (copy->PeekPacketTag (tag), true, "Packet tag not copied");
+    NS_TEST_EXPECT_MSG_EQ (tag.GetData (), 7, "Wrong packet tag data");
+    ATestHeader<10> header;
+    copy->RemoveHeader (header);
+    NS_TEST_EXPECT_MSG_EQ (header.m_error, false, "Wrong header in the copy");
+    NS_TEST_EXPECT_MSG_EQ (tmp->GetSize (), 110, "The original was modified");
+    CHECK (tmp, 1, E (20, 0, 110));
+
+    uint8_t bytes[4] = { 1, 2, 3, 4 };
+    uint8_t out[4];
+    Ptr<Packet> real = Create<Packet> (bytes, 4);
+    Ptr<Packet> realCopy = real->DeepCopy ();
+    realCopy->AddHeader (ATestHeader<10> ());
+    real->AddAtEnd (Create<Packet> (6));
+    NS_TEST_EXPECT_MSG_EQ (realCopy->GetSize (), 14, "Wrong size of the copy");
+    realCopy->RemoveHeader (header);
+    NS_TEST_EXPECT_MSG_EQ (header.m_error, false, "Wrong header in the copy");
+    realCopy->CopyData (out, 4);
+    NS_TEST_EXPECT_MSG_EQ (memcmp (out, bytes, 4), 0, "Wrong bytes in the copy");
+    real->CopyData (out, 4);
+    NS_TEST_EXPECT_MSG_EQ (memcmp (out, bytes, 4), 0, "The original was modified");
+    NS_TEST_EXPECT_MSG_EQ (real->GetSize (), 10, "The original was modified");
+  }
+
+  /* Test the byte tags stored inside the ByteTagList: two 20-byte tags
+   * fit in it, a third one moves them to the heap, and the copies made
+   * before and after keep their own tags.
+   */
+  {
+    Ptr<Packet> tmp = Create<Packet> (100);
+    tmp->AddByteTag (ATestTag<19> ());
+    tmp->AddByteTag (ATestTag<18> ());
+    Ptr<Packet> inlineCopy = tmp->Copy ();
+    CHECK (inlineCopy, 2, E (19, 0, 100), E (18, 0, 100));
+    tmp->AddByteTag (ATestTag<17> ());
+    CHECK (tmp, 3, E (19, 0, 100), E (18, 0, 100), E (17, 0, 100));
+    CHECK (inlineCopy, 2, E (19, 0, 100), E (18, 0, 100));
+    Ptr<Packet> heapCopy = tmp->Copy ();
+    inlineCopy->AddHeader (ATestHeader<10> ());
+    inlineCopy->AddByteTag (ATestTag<1> ());
+    CHECK (inlineCopy, 3, E (19, 10, 110), E (18, 10, 110), E (1, 0, 110));
+    heapCopy->RemoveAtStart (50);
+    CHECK (heapCopy, 3, E (19, 0, 50), E (18, 0, 50), E (17, 0, 50));
+    CHECK (tmp, 3, E (19, 0, 100), E (18, 0, 100), E (17, 0, 100));
+    Ptr<Packet> fragment = inlineCopy->CreateFragment (0, 20);
+    fragment->AddAtEnd (tmp->CreateFragment (90, 10));
+    CHECK (fragment, 6, E (19, 10, 20), E (18, 10, 20), E (1, 0, 20),
+           E (19, 20, 30), E (18, 20, 30), E (17, 20, 30));
+    tmp->RemoveAllByteTags ();
+    CHECK (tmp, 0, E (0, 0, 0));
+    CHECK (heapCopy, 3, E (19, 0, 50), E (18, 0, 50), E (17, 0, 50));
+  }
 }
 //--------------------------------------
 class PacketTagListTest : public TestCase
@@ -806,6 +872,69 @@ PacketTagListTest::DoRun (void)
     ReplaceCheck (7);
   }
   
+  { // Inline tags
+    std::cout << GetName () << "check inline tags" << std::endl;
+    ATestTag<1> a (3);
+    ATestTag<2> b (3);
+    ATestTag<3> c (3);
+    ATestTag<4> d (3);
+    ATestTag<20> big (3);   // too large to be inline
+    PacketTagList ptl;
+    ptl.Add (a);
+    ptl.Add (big);
+    ptl.Add (b);
+    ptl.Add (c);
+    ptl.Add (d);            // inline area full
+    NS_TEST_EXPECT_MSG_EQ (ptl.GetNInline (), 3, "inline tags");
+    NS_TEST_EXPECT_MSG_EQ ((ptl.Head () != 0 && ptl.Head ()->next != 0
+                            && ptl.Head ()->next->next == 0), true,
+                           "tags in the list");
+    const char * msg = "inline";
+    CheckRef (ptl, a, msg);
+    CheckRef (ptl, b, msg);
+    CheckRef (ptl, c, msg);
+    CheckRef (ptl, d, msg);
+    CheckRef (ptl, big, msg);
+
+    PacketTagList cpy = ptl;
+    cpy.Remove (b);
+    ATestTag<5> e (3);
+    cpy.Add (e);            // takes the free inline slot
+    NS_TEST_EXPECT_MSG_EQ (cpy.GetNInline (), 3, "inline tags of the copy");
+    ATestTag<3> c4 (4);
+    cpy.Replace (c4);
+    msg = "inline, copy";
+    CheckRef (cpy, a, msg);
+    CheckRef (cpy, b, msg, true);
+    CheckRef (cpy, c4, msg);
+    CheckRef (cpy, d, msg);
+    CheckRef (cpy, e, msg);
+    CheckRef (cpy, big, msg);
+    msg = "inline, orig";
+    CheckRef (ptl, b, msg);
+    CheckRef (ptl, c, msg);
+    CheckRef (ptl, e, msg, true);
+
+    Ptr<Packet> packet = Create<Packet> (10);
+    packet->AddPacketTag (a);
+    packet->AddPacketTag (big);
+    packet->AddPacketTag (b);
+    packet->AddPacketTag (c);
+    packet->AddPacketTag (d);
+    Ptr<Packet> deep = packet->DeepCopy ();
+    uint32_t n = 0;
+    for (PacketTagIterator i = deep->GetPacketTagIterator (); i.HasNext (); )
+      {
+        PacketTagIterator::Item item = i.Next ();
+        ATestTagBase *tag = dynamic_cast<ATestTagBase *> (item.GetTypeId ().GetConstructor () ());
+        item.GetTag (*tag);
+        NS_TEST_EXPECT_MSG_EQ (tag->GetData (), 3, "deep copy " << item.GetTypeId ().GetName ());
+        delete tag;
+        n++;
+      }
+    NS_TEST_EXPECT_MSG_EQ (n, 5, "tags of the deep copy");
+  }
+
   { // Timing
     std::cout << GetName () << "add+remove timing" << std::endl;
     int flm = std::numeric_limits<int>::max ();
@@ -25,6 +25,11 @@
 #include "ns3/log.h"
 #include "ns3/test.h"
 #include "ns3/pcap-file.h"
+#include "ns3/pcap-file-wrapper.h"
+#include "ns3/uinteger.h"
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 using namespace ns3;
 
@@ -1121,6 +1126,272 @@ DiffTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (usec, 3696, "Files are different from 2.3696 seconds");
 }
 
+// ===========================================================================
+// Test case to make sure that the buffered, asynchronous and pcapng writers
+// reproduce a known good pcap file.
+// ===========================================================================
+class WriteModesTestCase : public TestCase
+{
+public:
+  WriteModesTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WriteModesTestCase::WriteModesTestCase ()
+  : TestCase ("Check that PcapFile writes the same packets in all its write modes")
+{
+}
+
+void
+WriteModesTestCase::DoRun (void)
+{
+  struct Mode
+  {
+    bool async;
+    uint32_t bufferSize;
+    bool swapMode;
+    bool ngMode;
+  };
+  //
+  // The small buffer sizes split the file in many blocks, and make the
+  // 1070 bytes packets larger than a block.
+  //
+  const Mode modes[] = {
+    { false, 1, false, false },
+    { true, 512, false, false },
+    { true, 512, false, true },
+    { false, 100, true, true }
+  };
+  std::string known = CreateDataDirFilename ("known.pcap");
+  uint8_t data[PcapFile::SNAPLEN_DEFAULT];
+  uint32_t tsSec, tsUsec, inclLen, origLen, readLen;
+
+  for (uint32_t m = 0; m < sizeof (modes) / sizeof (modes[0]); ++m)
+    {
+      Mode const &mode = modes[m];
+      std::ostringstream oss;
+      oss << "write-mode-" << m << ".pcap";
+      std::string filename = CreateTempDirFilename (oss.str ());
+
+      PcapFile in;
+      in.Open (known, std::ios::in);
+      NS_TEST_ASSERT_MSG_EQ (in.Fail (), false, "Open (" << known << ") returns error");
+      PcapFile out;
+      out.SetBufferSize (mode.bufferSize);
+      out.Open (filename, std::ios::out);
+      out.SetAsync (mode.async);
+      NS_TEST_ASSERT_MSG_EQ (out.Fail (), false, "Open (" << filename << ") returns error");
+      out.Init (in.GetDataLinkType (), in.GetSnapLen (), PcapFile::ZONE_DEFAULT,
+                mode.swapMode, false, mode.ngMode);
+
+      uint32_t packets = 0;
+      uint64_t ngSize = 60;
+      while (true)
+        {
+          in.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen, readLen);
+          if (in.Fail ())
+            {
+              break;
+            }
+          out.Write (tsSec, tsUsec, data, readLen);
+          ngSize += 32 + ((readLen + 3) & ~3);
+          packets++;
+        }
+      NS_TEST_EXPECT_MSG_EQ (packets, N_KNOWN_PACKETS, "Read () of known good pcap file");
+      NS_TEST_EXPECT_MSG_EQ (out.Fail (), false, "Write () in mode " << m << " returns error");
+      out.Close ();
+
+      if (mode.ngMode)
+        {
+          NS_TEST_EXPECT_MSG_EQ (CheckFileLength (filename, ngSize), true,
+                                 "Incorrect size of pcapng file in mode " << m);
+          out.Open (filename, std::ios::in);
+          NS_TEST_ASSERT_MSG_EQ (out.Fail (), false, "Open (" << filename << ") of pcapng file returns error");
+          NS_TEST_EXPECT_MSG_EQ (out.IsPcapNg (), true, "pcapng file not recognized");
+          NS_TEST_EXPECT_MSG_EQ (out.GetSwapMode (), mode.swapMode, "Incorrect byte order of pcapng file");
+          NS_TEST_EXPECT_MSG_EQ (out.IsNanoSecMode (), false, "Incorrect timestamp resolution of pcapng file");
+          NS_TEST_EXPECT_MSG_EQ (out.GetDataLinkType (), in.GetDataLinkType (), "Incorrect data link type of pcapng file");
+          NS_TEST_EXPECT_MSG_EQ (out.GetSnapLen (), in.GetSnapLen (), "Incorrect snap length of pcapng file");
+          out.Close ();
+        }
+      else
+        {
+          NS_TEST_EXPECT_MSG_EQ (CheckFileLength (filename, 24 + 16 * N_KNOWN_PACKETS + 4 * 46 + 2 * 1070), true,
+                                 "Incorrect size of pcap file in mode " << m);
+        }
+
+      uint32_t sec (0), usec (0);
+      packets = 0;
+      bool diff = PcapFile::Diff (known, filename, sec, usec, packets);
+      NS_TEST_EXPECT_MSG_EQ (diff, false, "PcapDiff(known, file in mode " << m << ") must be false");
+      NS_TEST_EXPECT_MSG_EQ (packets, N_KNOWN_PACKETS, "PcapDiff(known, file in mode " << m << ") packets");
+      remove (filename.c_str ());
+    }
+
+  //
+  // Nanosecond timestamps and truncated packets in a pcapng file.
+  //
+  std::string filename = CreateTempDirFilename ("write-mode-ns.pcapng");
+  PcapFile f;
+  f.Open (filename, std::ios::out);
+  f.Init (1, 43, PcapFile::ZONE_DEFAULT, false, true, true);
+  uint8_t bufferOut[128];
+  for (uint32_t i = 0; i < 128; ++i)
+    {
+      bufferOut[i] = i;
+    }
+  f.Write (7, 123456789, bufferOut, 128);
+  f.Write (8, 5, bufferOut, 3);
+  f.Close ();
+  NS_TEST_EXPECT_MSG_EQ (CheckFileLength (filename, 60 + 32 + 44 + 32 + 4), true,
+                         "Incorrect size of truncated pcapng file");
+
+  f.Open (filename, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << filename << ") returns error");
+  NS_TEST_EXPECT_MSG_EQ (f.IsNanoSecMode (), true, "Incorrect timestamp resolution of pcapng file");
+  NS_TEST_EXPECT_MSG_EQ (f.GetSnapLen (), 43, "Incorrect snap length of pcapng file");
+  f.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen, readLen);
+  NS_TEST_EXPECT_MSG_EQ (tsSec, 7, "Incorrect seconds timestamp");
+  NS_TEST_EXPECT_MSG_EQ (tsUsec, 123456789, "Incorrect nanoseconds timestamp");
+  NS_TEST_EXPECT_MSG_EQ (inclLen, 43, "Incorrect included length");
+  NS_TEST_EXPECT_MSG_EQ (origLen, 128, "Incorrect original length");
+  NS_TEST_EXPECT_MSG_EQ (std::memcmp (data, bufferOut, 43), 0, "Incorrect packet data");
+  f.Read (data, 2, tsSec, tsUsec, inclLen, origLen, readLen);
+  NS_TEST_EXPECT_MSG_EQ (tsSec, 8, "Incorrect seconds timestamp");
+  NS_TEST_EXPECT_MSG_EQ (inclLen, 3, "Incorrect included length");
+  NS_TEST_EXPECT_MSG_EQ (readLen, 2, "Incorrect read length");
+  f.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen, readLen);
+  NS_TEST_EXPECT_MSG_EQ (f.Eof (), true, "Read () at the end of the pcapng file does not return error");
+  f.Close ();
+  remove (filename.c_str ());
+}
+
+// ===========================================================================
+// Test case to make sure that PcapFileWrapper samples the packets.
+// ===========================================================================
+class SamplingTestCase : public TestCase
+{
+public:
+  SamplingTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+SamplingTestCase::SamplingTestCase ()
+  : TestCase ("Check that PcapFileWrapper writes one packet out of PacketSampling")
+{
+}
+
+void
+SamplingTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("sampling.pcap");
+  Ptr<PcapFileWrapper> wrapper = CreateObject<PcapFileWrapper> ();
+  wrapper->SetAttribute ("PacketSampling", UintegerValue (3));
+  wrapper->Open (filename, std::ios::out);
+  wrapper->Init (1);
+  uint8_t buffer[10];
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      buffer[i] = i;
+      wrapper->Write (MicroSeconds (i), buffer, i + 1);
+    }
+  wrapper->Close ();
+
+  PcapFile f;
+  f.Open (filename, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << filename << ") returns error");
+  uint8_t data[10];
+  uint32_t tsSec, tsUsec, inclLen, origLen, readLen;
+  for (uint32_t i = 0; i < 10; i += 3)
+    {
+      f.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen, readLen);
+      NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Read () of sampled packet " << i << " returns error");
+      NS_TEST_EXPECT_MSG_EQ (tsUsec, i, "Incorrect timestamp of sampled packet");
+      NS_TEST_EXPECT_MSG_EQ (inclLen, i + 1, "Incorrect length of sampled packet");
+    }
+  f.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen, readLen);
+  NS_TEST_EXPECT_MSG_EQ (f.Eof (), true, "Too many sampled packets");
+  f.Close ();
+  remove (filename.c_str ());
+}
+
+// ===========================================================================
+// Test case to make sure that the asynchronous writer survives a fork, and
+// that opening a file which is already open leaves its records intact.
+// ===========================================================================
+class AsyncForkTestCase : public TestCase
+{
+public:
+  AsyncForkTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AsyncForkTestCase::AsyncForkTestCase ()
+  : TestCase ("Check that the asynchronous PcapFile writer works across a fork")
+{
+}
+
+void
+AsyncForkTestCase::DoRun (void)
+{
+  std::string parentName = CreateTempDirFilename ("async-fork-parent.pcap");
+  std::string childName = CreateTempDirFilename ("async-fork-child.pcap");
+  uint8_t buffer[100];
+  std::memset (buffer, 0xab, sizeof (buffer));
+
+  PcapFile f;
+  f.SetBufferSize (256);
+  f.Open (parentName, std::ios::out);
+  f.SetAsync (true);
+  f.Init (1);
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      f.Write (i, 0, buffer, sizeof (buffer));
+    }
+
+  pid_t pid = fork ();
+  NS_TEST_ASSERT_MSG_NE (pid, -1, "fork () failed");
+  if (pid == 0)
+    {
+      PcapFile g;
+      g.SetBufferSize (256);
+      g.Open (childName, std::ios::out);
+      g.SetAsync (true);
+      g.Init (1);
+      for (uint32_t i = 0; i < 10; ++i)
+        {
+          g.Write (i, 0, buffer, sizeof (buffer));
+        }
+      g.Close ();
+      _exit (g.Fail () ? 1 : 0);
+    }
+  int status = 0;
+  waitpid (pid, &status, 0);
+  NS_TEST_EXPECT_MSG_EQ ((WIFEXITED (status) && WEXITSTATUS (status) == 0), true,
+                         "The child process failed to write its file");
+  NS_TEST_EXPECT_MSG_EQ (CheckFileLength (childName, 24 + 10 * (16 + 100)), true,
+                         "Incorrect size of the file written by the child process");
+
+  for (uint32_t i = 10; i < 20; ++i)
+    {
+      f.Write (i, 0, buffer, sizeof (buffer));
+    }
+  f.Open (parentName, std::ios::out);
+  NS_TEST_EXPECT_MSG_EQ (f.Fail (), true, "Open () of an open file does not return error");
+  f.Clear ();
+  f.Close ();
+  NS_TEST_EXPECT_MSG_EQ (CheckFileLength (parentName, 24 + 20 * (16 + 100)), true,
+                         "Incorrect size of the file written by the parent process");
+  remove (parentName.c_str ());
+  remove (childName.c_str ());
+}
+
 class PcapFileTestSuite : public TestSuite
 {
 public:
@@ -1138,6 +1409,9 @@ PcapFileTestSuite::PcapFileTestSuite ()
   AddTestCase (new RecordHeaderTestCase, TestCase::QUICK);
   AddTestCase (new ReadFileTestCase, TestCase::QUICK);
   AddTestCase (new DiffTestCase, TestCase::QUICK);
+  AddTestCase (new WriteModesTestCase, TestCase::QUICK);
+  AddTestCase (new SamplingTestCase, TestCase::QUICK);
+  AddTestCase (new AsyncForkTestCase, TestCase::QUICK);
 }
 
 static PcapFileTestSuite pcapFileTestSuite;
@@ -46,12 +46,33 @@ PcapFileWrapper::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&PcapFileWrapper::m_nanosecMode),
                    MakeBooleanChecker())
+    .AddAttribute ("PcapNg",
+                   "Whether the file is written in the pcapng format rather than in the pcap format(default).",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PcapFileWrapper::m_ngMode),
+                   MakeBooleanChecker ())
+    .AddAttribute ("AsyncWrite",
+                   "Whether the file is written by a background thread, in blocks of BufferSize bytes.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PcapFileWrapper::m_async),
+                   MakeBooleanChecker ())
+    .AddAttribute ("BufferSize",
+                   "Size of the write buffer of the file, in bytes.",
+                   UintegerValue (PcapFile::BUFFER_SIZE_DEFAULT),
+                   MakeUintegerAccessor (&PcapFileWrapper::m_bufferSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("PacketSampling",
+                   "Write only the first packet of every PacketSampling packets.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&PcapFileWrapper::m_sampling),
+                   MakeUintegerChecker<uint32_t> (1))
   ;
   return tid;
 }
 
 
 PcapFileWrapper::PcapFileWrapper ()
+  : m_sampleCount (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -93,7 +114,10 @@ void
 PcapFileWrapper::Open (std::string const &filename, std::ios::openmode mode)
 {
   NS_LOG_FUNCTION (this << filename << mode);
+  m_file.SetBufferSize (m_bufferSize);
   m_file.Open (filename, mode);
+  m_file.SetAsync (m_async);
+  m_sampleCount = 0;
 }
 
 void
@@ -107,18 +131,30 @@ PcapFileWrapper::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t tzCorrec
   NS_LOG_FUNCTION (this << dataLinkType << snapLen << tzCorrection);
   if (snapLen != std::numeric_limits<uint32_t>::max ())
     {
-      m_file.Init (dataLinkType, snapLen, tzCorrection, false, m_nanosecMode);
+      m_file.Init (dataLinkType, snapLen, tzCorrection, false, m_nanosecMode, m_ngMode);
     } 
   else
     {
-      m_file.Init (dataLinkType, m_snapLen, tzCorrection, false, m_nanosecMode);
+      m_file.Init (dataLinkType, m_snapLen, tzCorrection, false, m_nanosecMode, m_ngMode);
     } 
 }
 
+bool
+PcapFileWrapper::Sample (void)
+{
+  bool write = m_sampleCount == 0;
+  m_sampleCount = (m_sampleCount + 1) % m_sampling;
+  return write;
+}
+
 void
 PcapFileWrapper::Write (Time t, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << t << p);
+  if (!Sample ())
+    {
+      return;
+    }
   if (m_file.IsNanoSecMode())
     {
       uint64_t current = t.GetNanoSeconds ();
@@ -139,6 +175,10 @@ void
 PcapFileWrapper::Write (Time t, const Header &header, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << t << &header << p);
+  if (!Sample ())
+    {
+      return;
+    }
   if (m_file.IsNanoSecMode())
     {
       uint64_t current = t.GetNanoSeconds ();
@@ -159,6 +199,10 @@ void
 PcapFileWrapper::Write (Time t, uint8_t const *buffer, uint32_t length)
 {
   NS_LOG_FUNCTION (this << t << &buffer << length);
+  if (!Sample ())
+    {
+      return;
+    }
   if (m_file.IsNanoSecMode())
     {
       uint64_t current = t.GetNanoSeconds ();
@@ -35,6 +35,11 @@ namespace ns3 {
  * ns-3 interface to the low-level public methods of PcapFile.  Users are
  * encouraged to use this object instead of class ns3::PcapFile in ns-3
  * public APIs.
+ *
+ * The attributes select the format of the file, how it is written, and
+ * which packets are written: setting the PacketSampling attribute to N
+ * writes only the first packet of every N, which keeps the traces of
+ * every device affordable in large simulations.
  */
 class PcapFileWrapper : public Object
 {
@@ -221,9 +226,21 @@ public:
   uint32_t GetDataLinkType (void);
 
 private:
+  /**
+   * Count a packet to write, for the packet sampling.
+   *
+   * \returns true if the packet is to be written.
+   */
+  bool Sample (void);
+
   PcapFile m_file; //!< Pcap file
   uint32_t m_snapLen; //!< max length of saved packets
   bool     m_nanosecMode; //!< Timestamps in nanosecond mode
+  bool     m_ngMode; //!< Write the file in the pcapng format
+  bool     m_async; //!< Write the file from a background thread
+  uint32_t m_bufferSize; //!< Size of the write buffer
+  uint32_t m_sampling; //!< Write one packet out of m_sampling
+  uint32_t m_sampleCount; //!< Packets to skip before the next one written
 };
 
 } // namespace ns3
@@ -28,7 +28,12 @@
 #include "ns3/buffer.h"
 #include "pcap-file.h"
 #include "ns3/log.h"
-#include "ns3/build-profile.h"
+#include "ns3/core-config.h"
+#include <algorithm>
+#include <deque>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
 //
 // This file is used as part of the ns-3 test framework, so please refrain from 
 // adding any ns-3 specific constructs such as Packet to this file.
@@ -47,20 +52,240 @@ const uint32_t NS_SWAPPED_MAGIC = 0x4d3cb2a1; /**< Looks this way if byte swappi
 const uint16_t VERSION_MAJOR = 2;             /**< Major version of supported pcap file format */
 const uint16_t VERSION_MINOR = 4;             /**< Minor version of supported pcap file format */
 
+const uint32_t NG_SECTION_HEADER = 0x0a0d0d0a;   /**< pcapng section header block type */
+const uint32_t NG_INTERFACE = 0x00000001;        /**< pcapng interface description block type */
+const uint32_t NG_ENHANCED_PACKET = 0x00000006;  /**< pcapng enhanced packet block type */
+const uint32_t NG_BYTE_ORDER_MAGIC = 0x1a2b3c4d; /**< pcapng byte order magic */
+const uint16_t NG_VERSION_MAJOR = 1;             /**< Major version of supported pcapng file format */
+const uint16_t NG_VERSION_MINOR = 0;             /**< Minor version of supported pcapng file format */
+const uint16_t NG_OPTION_END = 0;                /**< pcapng end of options option code */
+const uint16_t NG_OPTION_TSRESOL = 9;            /**< pcapng if_tsresol option code */
+
+/**
+ * Size of the header of a pcapng enhanced packet block, and of its
+ * trailer: the packet data is written in between.
+ */
+const uint32_t NG_PACKET_HEADER_SIZE = 28;
+const uint32_t NG_PACKET_TRAILER_SIZE = 4;       /**< See NG_PACKET_HEADER_SIZE */
+
+/** Maximum number of blocks of a file waiting for the background thread. */
+const uint32_t MAX_PENDING_BLOCKS = 4;
+
+namespace {
+
+/** A block of records to be written by the background thread. */
+struct PcapBlock
+{
+  std::ostream *stream;  //!< the stream to write to
+  uint8_t *data;         //!< the records, released once written
+  uint32_t size;         //!< the size of the records
+  uint32_t *pending;     //!< the count of pending blocks of the file
+};
+
+#ifdef HAVE_PTHREAD_H
+/** Protects the state of the background thread and the pending counts. */
+pthread_mutex_t g_mutex = PTHREAD_MUTEX_INITIALIZER;
+/** Signals a new block, a written block, or the end of the thread. */
+pthread_cond_t g_cond = PTHREAD_COND_INITIALIZER;
+/** The background thread. */
+pthread_t g_thread;
+/** The blocks waiting for the background thread, in order. */
+std::deque<PcapBlock> *g_blocks = 0;
+/** Has the background thread been started. */
+bool g_started = false;
+/** Has the background thread been asked to stop. */
+bool g_stopped = false;
+/** The number of blocks being written by the background thread. */
+uint32_t g_writing = 0;
+/** Have the fork handlers been registered. */
+bool g_forkHandlers = false;
+
+/**
+ * Write the blocks handed over to the background thread, until it is
+ * asked to stop and no block is left.
+ *
+ * \returns 0.
+ */
+void *
+RunWriter (void *)
+{
+  pthread_mutex_lock (&g_mutex);
+  while (true)
+    {
+      while (g_blocks->empty () && !g_stopped)
+        {
+          pthread_cond_wait (&g_cond, &g_mutex);
+        }
+      if (g_blocks->empty ())
+        {
+          break;
+        }
+      PcapBlock block = g_blocks->front ();
+      g_blocks->pop_front ();
+      g_writing++;
+      pthread_mutex_unlock (&g_mutex);
+      block.stream->write ((const char *)block.data, block.size);
+      delete [] block.data;
+      pthread_mutex_lock (&g_mutex);
+      g_writing--;
+      (*block.pending)--;
+      pthread_cond_broadcast (&g_cond);
+    }
+  pthread_mutex_unlock (&g_mutex);
+  return 0;
+}
+
+/** Stop the background thread once it has written all its blocks. */
+struct WriterStopper
+{
+  ~WriterStopper ()
+  {
+    pthread_mutex_lock (&g_mutex);
+    bool started = g_started;
+    g_stopped = true;
+    pthread_cond_broadcast (&g_cond);
+    pthread_mutex_unlock (&g_mutex);
+    if (started)
+      {
+        pthread_join (g_thread, 0);
+        delete g_blocks;
+        g_blocks = 0;
+      }
+  }
+} g_writerStopper; //!< Stops the background thread at exit
+
+/** Write all the blocks and lock the background thread before a fork. */
+void
+ForkPrepare (void)
+{
+  pthread_mutex_lock (&g_mutex);
+  while (g_started && (!g_blocks->empty () || g_writing > 0))
+    {
+      pthread_cond_wait (&g_cond, &g_mutex);
+    }
+}
+
+/** Unlock the background thread after a fork, in the parent process. */
+void
+ForkParent (void)
+{
+  pthread_mutex_unlock (&g_mutex);
+}
+
+/**
+ * Unlock the background thread after a fork, in the child process.  The
+ * child has no background thread: the next block starts a new one.
+ */
+void
+ForkChild (void)
+{
+  pthread_cond_init (&g_cond, 0);
+  if (g_started)
+    {
+      delete g_blocks;
+      g_blocks = 0;
+      g_started = false;
+    }
+  pthread_mutex_unlock (&g_mutex);
+}
+#endif /* HAVE_PTHREAD_H */
+
+/**
+ * Hand a block over to the background thread.
+ *
+ * Waits while the file has MAX_PENDING_BLOCKS blocks pending, so that
+ * a slow disk does not let the blocks pile up in memory.
+ *
+ * \param [in] block The block.
+ * \returns false if the background thread cannot write the block.
+ */
+bool
+SubmitToWriter (PcapBlock const &block)
+{
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_lock (&g_mutex);
+  if (!g_started && !g_stopped)
+    {
+      if (!g_forkHandlers)
+        {
+          pthread_atfork (&ForkPrepare, &ForkParent, &ForkChild);
+          g_forkHandlers = true;
+        }
+      g_blocks = new std::deque<PcapBlock> ();
+      if (pthread_create (&g_thread, 0, &RunWriter, 0) != 0)
+        {
+          NS_LOG_WARN ("Unable to start the pcap writer thread");
+          g_stopped = true;
+        }
+      else
+        {
+          g_started = true;
+        }
+    }
+  if (g_stopped)
+    {
+      pthread_mutex_unlock (&g_mutex);
+      return false;
+    }
+  while (*block.pending >= MAX_PENDING_BLOCKS)
+    {
+      pthread_cond_wait (&g_cond, &g_mutex);
+    }
+  g_blocks->push_back (block);
+  (*block.pending)++;
+  pthread_cond_broadcast (&g_cond);
+  pthread_mutex_unlock (&g_mutex);
+  return true;
+#else /* HAVE_PTHREAD_H */
+  return false;
+#endif /* HAVE_PTHREAD_H */
+}
+
+/**
+ * Wait until the background thread has written the blocks of a file.
+ *
+ * \param [in] pending The count of pending blocks of the file.
+ */
+void
+WaitForWriter (uint32_t const *pending)
+{
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_lock (&g_mutex);
+  while (*pending > 0)
+    {
+      pthread_cond_wait (&g_cond, &g_mutex);
+    }
+  pthread_mutex_unlock (&g_mutex);
+#endif /* HAVE_PTHREAD_H */
+}
+
+} // anonymous namespace
+
 PcapFile::PcapFile ()
   : m_file (),
     m_swapMode (false),
-    m_nanosecMode (false)
+    m_nanosecMode (false),
+    m_ngMode (false),
+    m_async (false),
+    m_bufferSize (BUFFER_SIZE_DEFAULT),
+    m_buffer (0),
+    m_block (0),
+    m_blockSize (0),
+    m_blockUsed (0),
+    m_pending (0),
+    m_fatalBuf (this),
+    m_fatalStream (&m_fatalBuf)
 {
   NS_LOG_FUNCTION (this);
-  FatalImpl::RegisterStream (&m_file); 
+  FatalImpl::RegisterStream (&m_fatalStream); 
 }
 
 PcapFile::~PcapFile ()
 {
   NS_LOG_FUNCTION (this);
-  FatalImpl::UnregisterStream (&m_file);
+  FatalImpl::UnregisterStream (&m_fatalStream);
   Close ();
+  delete [] m_buffer;
 }
 
 
@@ -68,18 +293,21 @@ bool
 PcapFile::Fail (void) const
 {
   NS_LOG_FUNCTION (this);
+  WaitBlocks ();
   return m_file.fail ();
 }
 bool 
 PcapFile::Eof (void) const
 {
   NS_LOG_FUNCTION (this);
+  WaitBlocks ();
   return m_file.eof ();
 }
 void 
 PcapFile::Clear (void)
 {
   NS_LOG_FUNCTION (this);
+  WaitBlocks ();
   m_file.clear ();
 }
 
@@ -88,9 +316,141 @@ void
 PcapFile::Close (void)
 {
   NS_LOG_FUNCTION (this);
+  SubmitBlock ();
+  WaitBlocks ();
   m_file.close ();
 }
 
+void
+PcapFile::SetBufferSize (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  m_bufferSize = size;
+}
+
+void
+PcapFile::SetAsync (bool async)
+{
+  NS_LOG_FUNCTION (this << async);
+  if (!async)
+    {
+      SubmitBlock ();
+      WaitBlocks ();
+    }
+  m_async = async;
+}
+
+void
+PcapFile::SubmitBlock (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_block == 0)
+    {
+      return;
+    }
+  PcapBlock block;
+  block.stream = &m_file;
+  block.data = m_block;
+  block.size = m_blockUsed;
+  block.pending = &m_pending;
+  m_block = 0;
+  m_blockUsed = 0;
+  if (!SubmitToWriter (block))
+    {
+      m_file.write ((const char *)block.data, block.size);
+      delete [] block.data;
+    }
+}
+
+void
+PcapFile::WaitBlocks (void) const
+{
+  WaitForWriter (&m_pending);
+}
+
+PcapFile::FatalFlushBuf::FatalFlushBuf (PcapFile *file)
+  : m_pcap (file)
+{
+}
+
+int
+PcapFile::FatalFlushBuf::sync (void)
+{
+  m_pcap->SubmitBlock ();
+  m_pcap->WaitBlocks ();
+  m_pcap->m_file.flush ();
+  return 0;
+}
+
+uint8_t *
+PcapFile::Reserve (uint32_t size)
+{
+  if (m_block != 0 && m_blockUsed + size > m_blockSize)
+    {
+      SubmitBlock ();
+    }
+  if (m_block == 0)
+    {
+      m_blockSize = std::max (m_bufferSize, size);
+      m_block = new uint8_t [m_blockSize];
+      m_blockUsed = 0;
+    }
+  uint8_t *p = m_block + m_blockUsed;
+  m_blockUsed += size;
+  return p;
+}
+
+void
+PcapFile::WriteBytes (void const *data, uint32_t size)
+{
+  if (m_async)
+    {
+      std::memcpy (Reserve (size), data, size);
+    }
+  else
+    {
+      m_file.write ((const char *)data, size);
+    }
+}
+
+uint8_t *
+PcapFile::Put (uint8_t *p, uint16_t val)
+{
+  if (m_swapMode)
+    {
+      val = Swap (val);
+    }
+  std::memcpy (p, &val, sizeof (val));
+  return p + sizeof (val);
+}
+
+uint8_t *
+PcapFile::Put (uint8_t *p, uint32_t val)
+{
+  if (m_swapMode)
+    {
+      val = Swap (val);
+    }
+  std::memcpy (p, &val, sizeof (val));
+  return p + sizeof (val);
+}
+
+uint16_t
+PcapFile::ReadU16 (void)
+{
+  uint16_t val = 0;
+  m_file.read ((char *)&val, sizeof (val));
+  return m_swapMode ? Swap (val) : val;
+}
+
+uint32_t
+PcapFile::ReadU32 (void)
+{
+  uint32_t val = 0;
+  m_file.read ((char *)&val, sizeof (val));
+  return m_swapMode ? Swap (val) : val;
+}
+
 uint32_t
 PcapFile::GetMagic (void)
 {
@@ -154,6 +514,13 @@ PcapFile::IsNanoSecMode (void)
   return m_nanosecMode;
 }
 
+bool
+PcapFile::IsPcapNg (void)
+{
+  NS_LOG_FUNCTION (this);
+  return m_ngMode;
+}
+
 uint8_t
 PcapFile::Swap (uint8_t val)
 {
@@ -202,11 +569,49 @@ void
 PcapFile::WriteFileHeader (void)
 {
   NS_LOG_FUNCTION (this);
+  SubmitBlock ();
+  WaitBlocks ();
   //
   // If we're initializing the file, we need to write the pcap file header
   // at the start of the file.
   //
   m_file.seekp (0, std::ios::beg);
+
+  if (m_ngMode)
+    {
+      //
+      // A section header block, without the optional section length,
+      // followed by the description of the only interface.
+      //
+      uint8_t header[60];
+      uint8_t *p = header;
+      p = Put (p, NG_SECTION_HEADER);
+      p = Put (p, uint32_t (28));
+      p = Put (p, NG_BYTE_ORDER_MAGIC);
+      p = Put (p, m_fileHeader.m_versionMajor);
+      p = Put (p, m_fileHeader.m_versionMinor);
+      p = Put (p, uint32_t (0xffffffff));
+      p = Put (p, uint32_t (0xffffffff));
+      p = Put (p, uint32_t (28));
+
+      p = Put (p, NG_INTERFACE);
+      p = Put (p, uint32_t (32));
+      p = Put (p, uint16_t (m_fileHeader.m_type));
+      p = Put (p, uint16_t (0));
+      p = Put (p, m_fileHeader.m_snapLen);
+      p = Put (p, NG_OPTION_TSRESOL);
+      p = Put (p, uint16_t (1));
+      *p++ = m_nanosecMode ? 9 : 6;
+      *p++ = 0;
+      *p++ = 0;
+      *p++ = 0;
+      p = Put (p, NG_OPTION_END);
+      p = Put (p, uint16_t (0));
+      p = Put (p, uint32_t (32));
+      NS_ASSERT (p == header + sizeof (header));
+      m_file.write ((const char *)header, sizeof (header));
+      return;
+    }
  
   //
   // We have the ability to write out the pcap file header in a foreign endian
@@ -257,6 +662,12 @@ PcapFile::ReadAndVerifyFileHeader (void)
   // them all individually.
   //
   m_file.read ((char *)&m_fileHeader.m_magicNumber, sizeof(m_fileHeader.m_magicNumber));
+  m_ngMode = m_fileHeader.m_magicNumber == NG_SECTION_HEADER;
+  if (m_ngMode)
+    {
+      ReadAndVerifyNgHeader ();
+      return;
+    }
   m_file.read ((char *)&m_fileHeader.m_versionMajor, sizeof(m_fileHeader.m_versionMajor));
   m_file.read ((char *)&m_fileHeader.m_versionMinor, sizeof(m_fileHeader.m_versionMinor));
   m_file.read ((char *)&m_fileHeader.m_zone, sizeof(m_fileHeader.m_zone));
@@ -321,6 +732,100 @@ PcapFile::ReadAndVerifyFileHeader (void)
     }
 }
 
+void
+PcapFile::ReadAndVerifyNgHeader (void)
+{
+  NS_LOG_FUNCTION (this);
+  //
+  // The section header block type reads the same in both byte orders:
+  // the byte order magic tells whether to swap.
+  //
+  m_swapMode = false;
+  uint32_t length = ReadU32 ();
+  uint32_t magic = ReadU32 ();
+  if (magic == Swap (NG_BYTE_ORDER_MAGIC))
+    {
+      m_swapMode = true;
+      length = Swap (length);
+    }
+  else if (magic != NG_BYTE_ORDER_MAGIC)
+    {
+      m_file.setstate (std::ios::failbit);
+    }
+  m_fileHeader.m_versionMajor = ReadU16 ();
+  m_fileHeader.m_versionMinor = ReadU16 ();
+  m_fileHeader.m_zone = 0;
+  m_fileHeader.m_sigFigs = 0;
+  if (m_fileHeader.m_versionMajor != NG_VERSION_MAJOR || length < 28)
+    {
+      m_file.setstate (std::ios::failbit);
+    }
+  m_file.seekg (length - 16, std::ios::cur);
+
+  //
+  // Skip any block before the description of the first interface, which
+  // gives the data link type, the snap length and the timestamp
+  // resolution of the packets.  All the packets are assumed to belong
+  // to this interface.
+  //
+  while (!m_file.fail ())
+    {
+      uint32_t type = ReadU32 ();
+      length = ReadU32 ();
+      if (m_file.fail () || length < 12 || length % 4 != 0)
+        {
+          m_file.setstate (std::ios::failbit);
+          break;
+        }
+      if (type != NG_INTERFACE)
+        {
+          m_file.seekg (length - 8, std::ios::cur);
+          continue;
+        }
+      m_fileHeader.m_type = ReadU16 ();
+      ReadU16 ();
+      m_fileHeader.m_snapLen = ReadU32 ();
+      m_nanosecMode = false;
+      uint32_t left = length - 20;
+      while (left >= 4 && !m_file.fail ())
+        {
+          uint16_t code = ReadU16 ();
+          uint16_t optionLength = ReadU16 ();
+          uint32_t padded = (optionLength + 3) & ~3;
+          left -= 4;
+          if (code == NG_OPTION_END || padded > left)
+            {
+              break;
+            }
+          if (code == NG_OPTION_TSRESOL && optionLength == 1)
+            {
+              uint8_t resolution = 0;
+              m_file.read ((char *)&resolution, 1);
+              if (resolution != 6 && resolution != 9)
+                {
+                  NS_LOG_WARN ("Unsupported timestamp resolution " << uint32_t (resolution));
+                  m_file.setstate (std::ios::failbit);
+                }
+              m_nanosecMode = resolution == 9;
+              m_file.seekg (padded - 1, std::ios::cur);
+            }
+          else
+            {
+              m_file.seekg (padded, std::ios::cur);
+            }
+          left -= padded;
+        }
+      m_file.seekg (left, std::ios::cur);
+      ReadU32 ();
+      break;
+    }
+
+  if (m_file.fail ())
+    {
+      m_file.close ();
+    }
+}
+
 void
 PcapFile::Open (std::string const &filename, std::ios::openmode mode)
 {
@@ -333,6 +838,18 @@ PcapFile::Open (std::string const &filename, std::ios::openmode mode)
   mode |= std::ios::binary;
 
   m_filename=filename;
+  m_ngMode = false;
+  if ((mode & std::ios::out) && !m_file.is_open ())
+    {
+      //
+      // Write the file in large blocks.  The buffer of a file stream can
+      // only be set while the stream is closed: an open stream keeps
+      // its buffer, and the open below fails anyway.
+      //
+      delete [] m_buffer;
+      m_buffer = new char [m_bufferSize];
+      m_file.rdbuf ()->pubsetbuf (m_buffer, m_bufferSize);
+    }
   m_file.open (filename.c_str (), mode);
   if (mode & std::ios::in)
     {
@@ -342,15 +859,20 @@ PcapFile::Open (std::string const &filename, std::ios::openmode mode)
 }
 
 void
-PcapFile::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t timeZoneCorrection, bool swapMode, bool nanosecMode)
+PcapFile::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t timeZoneCorrection, bool swapMode, bool nanosecMode, bool ngMode)
 {
-  NS_LOG_FUNCTION (this << dataLinkType << snapLen << timeZoneCorrection << swapMode);
+  NS_LOG_FUNCTION (this << dataLinkType << snapLen << timeZoneCorrection << swapMode << nanosecMode << ngMode);
 
   //
   // Initialize the magic number and nanosecond mode flag
   //
   m_nanosecMode = nanosecMode;
-  if (nanosecMode)
+  m_ngMode = ngMode;
+  if (ngMode)
+    {
+      m_fileHeader.m_magicNumber = NG_SECTION_HEADER;
+    }
+  else if (nanosecMode)
     {
       m_fileHeader.m_magicNumber = NS_MAGIC;
     }
@@ -362,9 +884,9 @@ PcapFile::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t timeZoneCorrect
   //
   // Initialize remainder of the in-memory file header.
   //
-  m_fileHeader.m_versionMajor = VERSION_MAJOR;
-  m_fileHeader.m_versionMinor = VERSION_MINOR;
-  m_fileHeader.m_zone = timeZoneCorrection;
+  m_fileHeader.m_versionMajor = ngMode ? NG_VERSION_MAJOR : VERSION_MAJOR;
+  m_fileHeader.m_versionMinor = ngMode ? NG_VERSION_MINOR : VERSION_MINOR;
+  m_fileHeader.m_zone = ngMode ? 0 : timeZoneCorrection;
   m_fileHeader.m_sigFigs = 0;
   m_fileHeader.m_snapLen = snapLen;
   m_fileHeader.m_type = dataLinkType;
@@ -407,36 +929,56 @@ PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
 
   uint32_t inclLen = totalLen > m_fileHeader.m_snapLen ? m_fileHeader.m_snapLen : totalLen;
 
-  PcapRecordHeader header;
-  header.m_tsSec = tsSec;
-  header.m_tsUsec = tsUsec;
-  header.m_inclLen = inclLen;
-  header.m_origLen = totalLen;
-
-  if (m_swapMode)
-    {
-      Swap (&header, &header);
-    }
-
   //
   // Watch out for memory alignment differences between machines, so write
-  // them all individually.
+  // them all individually, but in one go.
   //
-  m_file.write ((const char *)&header.m_tsSec, sizeof(header.m_tsSec));
-  m_file.write ((const char *)&header.m_tsUsec, sizeof(header.m_tsUsec));
-  m_file.write ((const char *)&header.m_inclLen, sizeof(header.m_inclLen));
-  m_file.write ((const char *)&header.m_origLen, sizeof(header.m_origLen));
-  NS_BUILD_DEBUG(m_file.flush());
+  if (m_ngMode)
+    {
+      uint64_t ts = uint64_t (tsSec) * (m_nanosecMode ? 1000000000 : 1000000) + tsUsec;
+      uint32_t padded = (inclLen + 3) & ~3;
+      uint8_t header[NG_PACKET_HEADER_SIZE];
+      uint8_t *p = header;
+      p = Put (p, NG_ENHANCED_PACKET);
+      p = Put (p, NG_PACKET_HEADER_SIZE + padded + NG_PACKET_TRAILER_SIZE);
+      p = Put (p, uint32_t (0));
+      p = Put (p, uint32_t (ts >> 32));
+      p = Put (p, uint32_t (ts));
+      p = Put (p, inclLen);
+      p = Put (p, totalLen);
+      WriteBytes (header, sizeof (header));
+      return inclLen;
+    }
+
+  uint8_t header[16];
+  uint8_t *p = header;
+  p = Put (p, tsSec);
+  p = Put (p, tsUsec);
+  p = Put (p, inclLen);
+  p = Put (p, totalLen);
+  WriteBytes (header, sizeof (header));
   return inclLen;
 }
 
+void
+PcapFile::WritePacketTrailer (uint32_t inclLen)
+{
+  if (m_ngMode)
+    {
+      uint32_t padded = (inclLen + 3) & ~3;
+      uint8_t trailer[3 + NG_PACKET_TRAILER_SIZE] = { 0, 0, 0 };
+      Put (trailer + padded - inclLen, NG_PACKET_HEADER_SIZE + padded + NG_PACKET_TRAILER_SIZE);
+      WriteBytes (trailer, padded - inclLen + NG_PACKET_TRAILER_SIZE);
+    }
+}
+
 void
 PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, uint8_t const * const data, uint32_t totalLen)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << &data << totalLen);
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, totalLen);
-  m_file.write ((const char *)data, inclLen);
-  NS_BUILD_DEBUG(m_file.flush());
+  WriteBytes (data, inclLen);
+  WritePacketTrailer (inclLen);
 }
 
 void 
@@ -444,8 +986,15 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << p);
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, p->GetSize ());
-  p->CopyData (&m_file, inclLen);
-  NS_BUILD_DEBUG(m_file.flush());
+  if (m_async)
+    {
+      p->CopyData (Reserve (inclLen), inclLen);
+    }
+  else
+    {
+      p->CopyData (&m_file, inclLen);
+    }
+  WritePacketTrailer (inclLen);
 }
 
 void 
@@ -460,9 +1009,18 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, const Header &header, Ptr<cons
   headerBuffer.AddAtStart (headerSize);
   header.Serialize (headerBuffer.Begin ());
   uint32_t toCopy = std::min (headerSize, inclLen);
-  headerBuffer.CopyData (&m_file, toCopy);
-  inclLen -= toCopy;
-  p->CopyData (&m_file, inclLen);
+  if (m_async)
+    {
+      uint8_t *data = Reserve (inclLen);
+      headerBuffer.CopyData (data, toCopy);
+      p->CopyData (data + toCopy, inclLen - toCopy);
+    }
+  else
+    {
+      headerBuffer.CopyData (&m_file, toCopy);
+      p->CopyData (&m_file, inclLen - toCopy);
+    }
+  WritePacketTrailer (inclLen);
 }
 
 void
@@ -478,6 +1036,44 @@ PcapFile::Read (
   NS_LOG_FUNCTION (this << &data <<maxBytes << tsSec << tsUsec << inclLen << origLen << readLen);
   NS_ASSERT (m_file.good ());
 
+  if (m_ngMode)
+    {
+      //
+      // Skip the blocks other than the enhanced packet blocks, then read
+      // the packet and skip its padding, options and trailer.
+      //
+      while (true)
+        {
+          uint32_t type = ReadU32 ();
+          uint32_t length = ReadU32 ();
+          if (m_file.fail ())
+            {
+              return;
+            }
+          if (type != NG_ENHANCED_PACKET)
+            {
+              m_file.seekg (length - 8, std::ios::cur);
+              continue;
+            }
+          ReadU32 ();
+          uint64_t ts = uint64_t (ReadU32 ()) << 32;
+          ts |= ReadU32 ();
+          inclLen = ReadU32 ();
+          origLen = ReadU32 ();
+          if (m_file.fail ())
+            {
+              return;
+            }
+          uint64_t unit = m_nanosecMode ? 1000000000 : 1000000;
+          tsSec = ts / unit;
+          tsUsec = ts % unit;
+          readLen = maxBytes < inclLen ? maxBytes : inclLen;
+          m_file.read ((char *)data, readLen);
+          m_file.seekg (length - NG_PACKET_HEADER_SIZE - readLen, std::ios::cur);
+          return;
+        }
+    }
+
   PcapRecordHeader header;
 
   //
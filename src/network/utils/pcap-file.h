@@ -38,12 +38,23 @@ class Header;
  * A class representing a pcap file.  This allows easy creation, writing and 
  * reading of files composed of stored packets; which may be viewed using
  * standard tools.
+ *
+ * Files are written either in the classic pcap format or, if requested
+ * at Init time, in the pcapng format with one interface.  Both formats
+ * can be read back.
+ *
+ * The records are written through a write buffer of #SetBufferSize
+ * bytes, so that the file is written in large blocks.  In asynchronous
+ * mode (#SetAsync) the records are gathered in blocks of that size,
+ * which a background thread, shared by all the files, writes to disk
+ * while the simulation goes on.
  */
 class PcapFile
 {
 public:
   static const int32_t  ZONE_DEFAULT    = 0;           /**< Time zone offset for current location */
   static const uint32_t SNAPLEN_DEFAULT = 65535;       /**< Default value for maximum octets to save per packet */
+  static const uint32_t BUFFER_SIZE_DEFAULT = 65536;   /**< Default size of the write buffer */
 
 public:
   PcapFile ();
@@ -80,6 +91,25 @@ public:
    */
   void Open (std::string const &filename, std::ios::openmode mode);
 
+  /**
+   * Set the size of the write buffer, used from the next call to Open.
+   *
+   * \param size The size of the write buffer, in bytes.
+   */
+  void SetBufferSize (uint32_t size);
+
+  /**
+   * Write the records from a background thread, or from the calling
+   * thread.  In asynchronous mode, the records are written in blocks of
+   * the size of the write buffer, and Close waits until they are all
+   * written.  The records not yet handed over to the background thread
+   * are lost if the program crashes.  Without thread support, the
+   * records are always written from the calling thread.
+   *
+   * \param async Whether to write the records from a background thread.
+   */
+  void SetAsync (bool async);
+
   /**
    * Close the underlying file.
    */
@@ -108,6 +138,13 @@ public:
    * \param swapMode Flag indicating a difference in endianness of the 
    * writing system. Defaults to false.
    *
+   * \param nanosecMode Flag indicating that the packet timestamps are in
+   * nanoseconds rather than microseconds. Defaults to false.
+   *
+   * \param ngMode Flag indicating that the file is written in the pcapng
+   * format rather than the pcap format. The time zone correction is not
+   * recorded in this format. Defaults to false.
+   *
    * \return false if the open succeeds, true otherwise.
    *
    * \warning Calling this method on an existing file will result in the loss
@@ -117,7 +154,8 @@ public:
              uint32_t snapLen = SNAPLEN_DEFAULT, 
              int32_t timeZoneCorrection = ZONE_DEFAULT,
              bool swapMode = false,
-             bool nanosecMode = false);
+             bool nanosecMode = false,
+             bool ngMode = false);
 
   /**
    * \brief Write next packet to file
@@ -199,6 +237,14 @@ public:
    * file have nanosecond resolution.
    */
    bool IsNanoSecMode (void);
+
+  /**
+   * \brief Get the format of the file.
+   *
+   * \returns true if the file is in the pcapng format, false if it is in
+   * the pcap format.
+   */
+  bool IsPcapNg (void);
  
   /**
    * \brief Returns the magic number of the pcap file as defined by the magic_number
@@ -357,16 +403,116 @@ private:
    */
   uint32_t WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen);
 
+  /**
+   * \brief Write the end of a packet record
+   *
+   * Writes the padding and the trailer of a pcapng block; nothing for
+   * a pcap file.
+   *
+   * \param inclLen the length of the packet written in the file
+   */
+  void WritePacketTrailer (uint32_t inclLen);
+  /**
+   * \brief Write bytes to the file, through the current block in
+   * asynchronous mode
+   *
+   * \param data the bytes to write
+   * \param size the number of bytes to write
+   */
+  void WriteBytes (void const *data, uint32_t size);
+  /**
+   * \brief Reserve space for a record in the current block
+   *
+   * The current block is handed over to the background thread first if
+   * the record does not fit in it.
+   *
+   * \param size the size of the record
+   * \returns the space for the record
+   */
+  uint8_t *Reserve (uint32_t size);
+  /**
+   * \brief Hand the current block over to the background thread
+   */
+  void SubmitBlock (void);
+  /**
+   * \brief Wait until the background thread has written all the blocks
+   * handed over to it
+   */
+  void WaitBlocks (void) const;
+  /**
+   * \brief Store a value at a given position in file byte order
+   * \param p the position
+   * \param val the value
+   * \returns the position after the value
+   */
+  uint8_t *Put (uint8_t *p, uint16_t val);
+  /**
+   * \brief Store a value at a given position in file byte order
+   * \param p the position
+   * \param val the value
+   * \returns the position after the value
+   */
+  uint8_t *Put (uint8_t *p, uint32_t val);
+  /**
+   * \brief Read a value in file byte order
+   * \returns the value
+   */
+  uint16_t ReadU16 (void);
+  /**
+   * \brief Read a value in file byte order
+   * \returns the value
+   */
+  uint32_t ReadU32 (void);
+
   /**
    * \brief Read and verify a Pcap file header
    */
   void ReadAndVerifyFileHeader (void);
+  /**
+   * \brief Read and verify the header of a pcapng file, up to and
+   * including its first interface description block
+   */
+  void ReadAndVerifyNgHeader (void);
 
   std::string    m_filename;    //!< file name
   std::fstream   m_file;        //!< file stream
   PcapFileHeader m_fileHeader;  //!< file header
   bool m_swapMode;              //!< swap mode
   bool m_nanosecMode;           //!< nanosecond timestamp mode
+  bool m_ngMode;                //!< pcapng format
+  bool m_async;                 //!< write from the background thread
+  uint32_t m_bufferSize;        //!< size of the write buffer
+  char *m_buffer;               //!< write buffer of the file stream
+  uint8_t *m_block;             //!< block being filled in asynchronous mode
+  uint32_t m_blockSize;         //!< size of m_block
+  uint32_t m_blockUsed;         //!< bytes used in m_block
+  mutable uint32_t m_pending;   //!< blocks not yet written by the background thread
+
+  /**
+   * \brief Stream buffer which, when flushed on a fatal error, hands the
+   * records over to the background thread and waits until they are
+   * written, rather than flushing the file stream under its feet
+   */
+  class FatalFlushBuf : public std::streambuf
+  {
+  public:
+    /**
+     * Constructor
+     * \param file the pcap file to flush
+     */
+    FatalFlushBuf (PcapFile *file);
+  protected:
+    /**
+     * Write the pending records and flush the file stream
+     * \returns 0
+     */
+    virtual int sync (void);
+  private:
+    PcapFile *m_pcap;           //!< the pcap file to flush
+  };
+
+  FatalFlushBuf m_fatalBuf;     //!< stream buffer of m_fatalStream
+  std::ostream m_fatalStream;   //!< stream flushed on a fatal error
 };
 
 } // namespace ns3
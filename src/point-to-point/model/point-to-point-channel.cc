@@ -21,6 +21,8 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/node.h"
 #include "ns3/log.h"
 
 namespace ns3 {
@@ -57,7 +59,8 @@ PointToPointChannel::PointToPointChannel()
   :
     Channel (),
     m_delay (Seconds (0.)),
-    m_nDevices (0)
+    m_nDevices (0),
+    m_crossSystem (false)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -80,6 +83,17 @@ PointToPointChannel::Attach (Ptr<PointToPointNetDevice> device)
       m_link[1].m_dst = m_link[0].m_src;
       m_link[0].m_state = IDLE;
       m_link[1].m_state = IDLE;
+
+      // The nodes of different system ids may be run by different
+      // threads, which is checked at each transmission
+      Ptr<Node> node0 = m_link[0].m_src->GetNode ();
+      Ptr<Node> node1 = m_link[1].m_src->GetNode ();
+      if (node0 != 0 && node1 != 0 && node0->GetSystemId () != node1->GetSystemId ())
+        {
+          m_crossSystem = true;
+          m_link[0].m_dstNodeId = node1->GetId ();
+          m_link[1].m_dstNodeId = node0->GetId ();
+        }
     }
 }
 
@@ -97,6 +111,18 @@ PointToPointChannel::TransmitStart (
 
   uint32_t wire = src == m_link[0].m_src ? 0 : 1;
 
+  if (m_crossSystem && MultithreadedSimulatorImpl::IsPartitionThread ())
+    {
+      // The destination may be run by another thread: it gets a deep copy
+      // of the packet and the reference counts of its objects are left
+      // untouched. As with the PointToPointRemoteChannel, the
+      // TxRxPointToPoint trace source is not fired.
+      Simulator::ScheduleWithContext (m_link[wire].m_dstNodeId,
+                                      txTime + m_delay, &PointToPointNetDevice::Receive,
+                                      PeekPointer (m_link[wire].m_dst), p->DeepCopy ());
+      return true;
+    }
+
   Simulator::ScheduleWithContext (m_link[wire].m_dst->GetNode ()->GetId (),
                                   txTime + m_delay, &PointToPointNetDevice::Receive,
                                   m_link[wire].m_dst, p);
@@ -128,6 +154,19 @@ PointToPointChannel::GetDevice (uint32_t i) const
   return GetPointToPointDevice (i);
 }
 
+Address
+PointToPointChannel::GetRemoteAddress (const PointToPointNetDevice *device) const
+{
+  NS_LOG_FUNCTION (this << device);
+  NS_ASSERT (m_nDevices == N_DEVICES);
+  if (PeekPointer (m_link[0].m_src) == device)
+    {
+      return m_link[1].m_src->GetAddress ();
+    }
+  NS_ASSERT (PeekPointer (m_link[1].m_src) == device);
+  return m_link[0].m_src->GetAddress ();
+}
+
 Time
 PointToPointChannel::GetDelay (void) const
 {
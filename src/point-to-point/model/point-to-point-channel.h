@@ -25,6 +25,7 @@
 #include "ns3/nstime.h"
 #include "ns3/data-rate.h"
 #include "ns3/traced-callback.h"
+#include "ns3/address.h"
 
 namespace ns3 {
 
@@ -100,6 +101,18 @@ public:
    */
   virtual Ptr<NetDevice> GetDevice (uint32_t i) const;
 
+  /**
+   * \brief Get the address of the NetDevice at the other end of the channel
+   *
+   * Unlike GetDevice, this method creates no reference to the remote
+   * NetDevice, which may be run by another thread (see
+   * ns3::MultithreadedSimulatorImpl).
+   *
+   * \param device One of the two NetDevices attached to the channel
+   * \returns The address of the other NetDevice
+   */
+  Address GetRemoteAddress (const PointToPointNetDevice *device) const;
+
 protected:
   /**
    * \brief Get the delay associated with this channel
@@ -151,6 +164,12 @@ private:
 
   Time          m_delay;    //!< Propagation delay
   int32_t       m_nDevices; //!< Devices of this channel
+  /**
+   * The two devices are on nodes of different system ids, which are run
+   * by different threads when the simulation is run by a
+   * MultithreadedSimulatorImpl.
+   */
+  bool          m_crossSystem;
 
   /**
    * The trace source for the packet transmission animation events that the 
@@ -194,11 +213,12 @@ public:
     /** \brief Create the link, it will be in INITIALIZING state
      *
      */
-    Link() : m_state (INITIALIZING), m_src (0), m_dst (0) {}
+    Link() : m_state (INITIALIZING), m_src (0), m_dst (0), m_dstNodeId (0) {}
 
     WireState                  m_state; //!< State of the link
     Ptr<PointToPointNetDevice> m_src;   //!< First NetDevice
     Ptr<PointToPointNetDevice> m_dst;   //!< Second NetDevice
+    uint32_t                   m_dstNodeId; //!< Id of the node of the second NetDevice
   };
 
   Link    m_link[N_DEVICES]; //!< Link model
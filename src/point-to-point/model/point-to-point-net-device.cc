@@ -384,9 +384,13 @@ PointToPointNetDevice::Receive (Ptr<Packet> packet)
 
       //
       // Trace sinks will expect complete packets, not packets without some of the
-      // headers.
+      // headers.  The copy is only needed if some sinks are connected.
       //
-      Ptr<Packet> originalPacket = packet->Copy ();
+      Ptr<Packet> originalPacket;
+      if (!m_macRxTrace.IsEmpty () || !m_macPromiscRxTrace.IsEmpty ())
+        {
+          originalPacket = packet->Copy ();
+        }
 
       //
       // Strip off the point-to-point protocol header and forward this packet
@@ -657,17 +661,9 @@ PointToPointNetDevice::GetRemote (void) const
 {
   NS_LOG_FUNCTION (this);
   NS_ASSERT (m_channel->GetNDevices () == 2);
-  for (uint32_t i = 0; i < m_channel->GetNDevices (); ++i)
-    {
-      Ptr<NetDevice> tmp = m_channel->GetDevice (i);
-      if (tmp != this)
-        {
-          return tmp->GetAddress ();
-        }
-    }
-  NS_ASSERT (false);
-  // quiet compiler.
-  return Address ();
+  // the remote device may be run by another thread, its reference count
+  // must not be touched
+  return m_channel->GetRemoteAddress (this);
 }
 
 bool
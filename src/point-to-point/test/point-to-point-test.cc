@@ -23,6 +23,9 @@
 #include "ns3/simulator.h"
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
+#include "ns3/global-value.h"
+#include "ns3/string.h"
+#include <vector>
 
 using namespace ns3;
 
@@ -98,6 +101,189 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Test the MultithreadedSimulatorImpl over PointToPoint links
+ *
+ * Packets are forwarded around a ring of nodes, each node in its own
+ * partition, and the receptions must be the same as with the
+ * DefaultSimulatorImpl.
+ */
+class PointToPointMultithreadedTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointMultithreadedTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /** The size and time of the packets received by a node. */
+  typedef std::vector<std::pair<uint32_t, int64_t> > Receptions;
+
+  /**
+   * \brief Run the simulation of the ring
+   *
+   * \param impl The simulator implementation
+   * \returns The packets received by each node
+   */
+  std::vector<Receptions> RunRing (std::string impl);
+
+  /**
+   * \brief Send a packet
+   *
+   * \param device NetDevice to send to
+   * \param size The size of the packet
+   */
+  void SendPacket (Ptr<PointToPointNetDevice> device, uint32_t size);
+
+  /**
+   * \brief Record a packet and forward it to the next node, one byte shorter
+   *
+   * \param device The receiving NetDevice
+   * \param packet The packet
+   * \param protocol The protocol number
+   * \param from The address of the sender
+   * \returns true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                uint16_t protocol, const Address &from);
+
+  /**
+   * \brief Count the transmissions traced by the channels
+   *
+   * \param packet The packet
+   * \param txDevice The transmitting NetDevice
+   * \param rxDevice The receiving NetDevice
+   * \param duration The transmission time
+   * \param lastBitTime The reception time of the last bit
+   */
+  void TxRx (Ptr<const Packet> packet, Ptr<NetDevice> txDevice, Ptr<NetDevice> rxDevice,
+             Time duration, Time lastBitTime);
+
+  std::vector<Ptr<PointToPointNetDevice> > m_out; //!< The device to the next node, for each node
+  std::vector<Receptions> m_receptions;           //!< The packets received by each node
+  uint32_t m_nTxRx;                               //!< The number of traced transmissions
+};
+
+PointToPointMultithreadedTest::PointToPointMultithreadedTest ()
+  : TestCase ("PointToPoint with the MultithreadedSimulatorImpl"),
+    m_nTxRx (0)
+{
+}
+
+void
+PointToPointMultithreadedTest::SendPacket (Ptr<PointToPointNetDevice> device, uint32_t size)
+{
+  Ptr<Packet> p = Create<Packet> (size);
+  device->Send (p, device->GetBroadcast (), 0x800);
+}
+
+bool
+PointToPointMultithreadedTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                                        uint16_t protocol, const Address &from)
+{
+  uint32_t node = device->GetNode ()->GetId ();
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetContext (), node, "Packet received in the wrong context");
+  m_receptions[node].push_back (std::make_pair (packet->GetSize (), Simulator::Now ().GetTimeStep ()));
+  if (packet->GetSize () > 1)
+    {
+      SendPacket (m_out[node], packet->GetSize () - 1);
+    }
+  return true;
+}
+
+void
+PointToPointMultithreadedTest::TxRx (Ptr<const Packet> packet, Ptr<NetDevice> txDevice, Ptr<NetDevice> rxDevice,
+                                     Time duration, Time lastBitTime)
+{
+  m_nTxRx++;
+}
+
+std::vector<PointToPointMultithreadedTest::Receptions>
+PointToPointMultithreadedTest::RunRing (std::string impl)
+{
+  const uint32_t nNodes = 4;
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue (impl));
+
+  std::vector<Ptr<Node> > nodes;
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      nodes.push_back (CreateObject<Node> (i));
+    }
+  m_out.clear ();
+  m_receptions.assign (nNodes, Receptions ());
+  m_nTxRx = 0;
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+      Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+      Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+      channel->SetAttribute ("Delay", TimeValue (MilliSeconds (2 + i)));
+      channel->TraceConnectWithoutContext ("TxRxPointToPoint", MakeCallback (&PointToPointMultithreadedTest::TxRx, this));
+      nodes[i]->AddDevice (devA);
+      nodes[(i + 1) % nNodes]->AddDevice (devB);
+      devA->Attach (channel);
+      devA->SetAddress (Mac48Address::Allocate ());
+      devA->SetQueue (CreateObject<DropTailQueue> ());
+      devA->AggregateObject (CreateObject<NetDeviceQueueInterface> ());
+      devB->Attach (channel);
+      devB->SetAddress (Mac48Address::Allocate ());
+      devB->SetQueue (CreateObject<DropTailQueue> ());
+      devB->AggregateObject (CreateObject<NetDeviceQueueInterface> ());
+      devB->SetReceiveCallback (MakeCallback (&PointToPointMultithreadedTest::Receive, this));
+      m_out.push_back (devA);
+    }
+
+  // the packets are sent in the context of their node
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      for (uint32_t j = 0; j < 5; j++)
+        {
+          Simulator::ScheduleWithContext (i, MilliSeconds (100 * j + 10 * i),
+                                          &PointToPointMultithreadedTest::SendPacket,
+                                          this, m_out[i], 20 + j);
+        }
+    }
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), Seconds (10), "Wrong end of the simulation");
+  Simulator::Destroy ();
+
+  m_out.clear ();
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+  return m_receptions;
+}
+
+void
+PointToPointMultithreadedTest::DoRun (void)
+{
+  // the nodes have different system ids, but the channels of the
+  // DefaultSimulatorImpl are not cross-partition ones
+  std::vector<Receptions> expected = RunRing ("ns3::DefaultSimulatorImpl");
+  uint32_t nReceptions = 0;
+  for (uint32_t i = 0; i < expected.size (); i++)
+    {
+      nReceptions += expected[i].size ();
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_nTxRx, nReceptions, "The channels should trace every transmission with the DefaultSimulatorImpl");
+  std::vector<Receptions> receptions = RunRing ("ns3::MultithreadedSimulatorImpl");
+  for (uint32_t i = 0; i < expected.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (receptions[i].size (), expected[i].size (), "Wrong number of packets received by node " << i);
+      NS_TEST_EXPECT_MSG_GT (expected[i].size (), 0, "No packet received by node " << i);
+      for (uint32_t j = 0; j < expected[i].size (); j++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (receptions[i][j].first, expected[i][j].first, "Wrong packet received by node " << i);
+          NS_TEST_EXPECT_MSG_EQ (receptions[i][j].second, expected[i][j].second, "Packet received at the wrong time by node " << i);
+        }
+    }
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -114,6 +300,7 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointMultithreadedTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
@@ -0,0 +1,196 @@
+#!/usr/bin/env python
+## -*- Mode: python; py-indent-offset: 4; indent-tabs-mode: nil; coding: utf-8; -*-
+
+"""
+Parameter sweep driver for the blue-vs-gentleblue example.
+
+Every point of the parameter grid is run once per RngRun value, in parallel
+worker processes, and the results are appended to a CSV file or to a SQLite
+table (when the output file name ends with .db or .sqlite).  The output file
+is also the checkpoint: the runs already recorded in it are skipped, hence an
+interrupted sweep is resumed by running the same command again.
+
+Example (after ./waf configure --enable-examples && ./waf build):
+
+  ./src/traffic-control/examples/blue-sweep.py \\
+      --param queueDiscType=BLUE,GentleBLUE --param nLeaf=5,10,20 \\
+      --param threshold=0.4,0.6,0.8 --runs 10 --output sweep.csv
+"""
+
+from __future__ import print_function
+
+import csv
+import glob
+import itertools
+import multiprocessing
+import optparse
+import os
+import sqlite3
+import subprocess
+import sys
+
+METRICS = ['goodput', 'meanDelay', 'rxPackets', 'lostPackets',
+           'queueDiscDrops', 'unforcedDrop', 'forcedDrop', 'unforcedMark']
+
+
+def find_program(build_dir):
+    pattern = os.path.join(build_dir, 'src', 'traffic-control', 'examples',
+                           'ns3*-blue-vs-gentleblue-*')
+    programs = [p for p in glob.glob(pattern) if os.access(p, os.X_OK)]
+    if not programs:
+        sys.exit('blue-vs-gentleblue not found in %s; build the examples or use --program' % build_dir)
+    return sorted(programs)[0]
+
+
+def parse_assignments(values):
+    result = []
+    for value in values:
+        if '=' not in value:
+            sys.exit('expected name=value, got %s' % value)
+        name, value = value.split('=', 1)
+        result.append((name, value))
+    return result
+
+
+class Runner(object):
+    """Run one simulation; picklable so that it can be used by the pool."""
+
+    def __init__(self, program, lib_dir, fixed):
+        self.program = program
+        self.lib_dir = lib_dir
+        self.fixed = fixed
+
+    def __call__(self, job):
+        params, run = job
+        args = [self.program, '--csv=1', '--RngRun=%d' % run]
+        args += ['--%s=%s' % item for item in self.fixed]
+        args += ['--%s=%s' % item for item in params]
+        env = dict(os.environ)
+        env['LD_LIBRARY_PATH'] = os.pathsep.join(
+            [self.lib_dir] + [p for p in env.get('LD_LIBRARY_PATH', '').split(os.pathsep) if p])
+        proc = subprocess.Popen(args, stdout=subprocess.PIPE, stderr=subprocess.PIPE, env=env)
+        out, err = proc.communicate()
+        lines = out.decode('utf-8', 'replace').strip().splitlines()
+        if proc.returncode != 0 or len(lines) < 2:
+            return job, None, err.decode('utf-8', 'replace').strip()
+        header = lines[-2].split(',')
+        values = lines[-1].split(',')
+        return job, dict(zip(header, values)), None
+
+
+class CsvStore(object):
+    def __init__(self, filename, columns):
+        self.columns = columns
+        exists = os.path.exists(filename) and os.path.getsize(filename) > 0
+        self.done = set()
+        if exists:
+            with open(filename) as f:
+                reader = csv.DictReader(f)
+                if reader.fieldnames != columns:
+                    sys.exit('%s was written with different parameters' % filename)
+                for row in reader:
+                    self.done.add(tuple(row[c] for c in columns[:-len(METRICS)]))
+        self.f = open(filename, 'a')
+        self.writer = csv.writer(self.f)
+        if not exists:
+            self.writer.writerow(columns)
+            self.f.flush()
+
+    def add(self, key, metrics):
+        self.writer.writerow(list(key) + [metrics.get(m, '') for m in METRICS])
+        self.f.flush()
+
+    def close(self):
+        self.f.close()
+
+
+class SqliteStore(object):
+    def __init__(self, filename, columns):
+        self.columns = columns
+        self.db = sqlite3.connect(filename)
+        quoted = ['"%s"' % c for c in columns]
+        self.db.execute('CREATE TABLE IF NOT EXISTS results (%s)' % ', '.join(quoted))
+        existing = [row[1] for row in self.db.execute('PRAGMA table_info(results)')]
+        if existing != columns:
+            sys.exit('%s was written with different parameters' % filename)
+        keys = ', '.join(quoted[:-len(METRICS)])
+        self.done = set(tuple(str(v) for v in row)
+                        for row in self.db.execute('SELECT %s FROM results' % keys))
+        self.insert = 'INSERT INTO results VALUES (%s)' % ', '.join('?' * len(columns))
+
+    def add(self, key, metrics):
+        self.db.execute(self.insert, list(key) + [metrics.get(m) for m in METRICS])
+        self.db.commit()
+
+    def close(self):
+        self.db.close()
+
+
+def main():
+    parser = optparse.OptionParser(usage='%prog [options]', description=__doc__.strip().split('\n')[0])
+    parser.add_option('--param', action='append', default=[], metavar='NAME=V1,V2,...',
+                      help='command-line argument of blue-vs-gentleblue to sweep (repeatable)')
+    parser.add_option('--fixed', action='append', default=[], metavar='NAME=VALUE',
+                      help='command-line argument passed unchanged to every run (repeatable)')
+    parser.add_option('--runs', type='int', default=1, help='number of RngRun values per grid point')
+    parser.add_option('--first-run', type='int', default=1, help='first RngRun value')
+    parser.add_option('--jobs', type='int', default=multiprocessing.cpu_count(),
+                      help='number of parallel simulations')
+    parser.add_option('--output', default='blue-sweep.csv',
+                      help='CSV file, or SQLite database if ending with .db or .sqlite')
+    parser.add_option('--build-dir', default=os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                                                          '..', '..', '..', 'build'),
+                      help='ns-3 build directory, holding the ns-3 libraries')
+    parser.add_option('--program', help='path of the blue-vs-gentleblue program')
+    options, args = parser.parse_args()
+
+    grid = [(name, value.split(',')) for name, value in parse_assignments(options.param)]
+    fixed = parse_assignments(options.fixed)
+    names = [name for name, _ in grid]
+    columns = names + ['run'] + METRICS
+
+    if options.output.endswith('.db') or options.output.endswith('.sqlite'):
+        store = SqliteStore(options.output, columns)
+    else:
+        store = CsvStore(options.output, columns)
+
+    jobs = []
+    for values in itertools.product(*[v for _, v in grid]):
+        for run in range(options.first_run, options.first_run + options.runs):
+            key = tuple(values) + (str(run),)
+            if key not in store.done:
+                jobs.append((list(zip(names, values)), run))
+
+    total = len(jobs)
+    print('%d runs to do, %d already done' % (total, len(store.done)))
+    if total == 0:
+        store.close()
+        return 0
+
+    program = options.program or find_program(options.build_dir)
+    runner = Runner(os.path.abspath(program), os.path.abspath(options.build_dir), fixed)
+
+    pool = multiprocessing.Pool(max(1, options.jobs))
+    failed = 0
+    try:
+        for i, (job, metrics, error) in enumerate(pool.imap_unordered(runner, jobs)):
+            params, run = job
+            key = tuple(v for _, v in params) + (str(run),)
+            if metrics is None:
+                failed += 1
+                print('FAIL %s run %d: %s' % (dict(params), run, error), file=sys.stderr)
+                continue
+            store.add(key, metrics)
+            print('[%d/%d] %s run %d goodput %s' % (i + 1, total, dict(params), run, metrics.get('goodput')))
+        pool.close()
+    except KeyboardInterrupt:
+        pool.terminate()
+        print('interrupted; run the same command again to resume', file=sys.stderr)
+        failed += 1
+    pool.join()
+    store.close()
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
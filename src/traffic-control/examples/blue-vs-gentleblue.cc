@@ -26,6 +26,7 @@
 #include "ns3/applications-module.h"
 #include "ns3/point-to-point-layout-module.h"
 #include "ns3/traffic-control-module.h"
+#include "ns3/flow-monitor-module.h"
 
 #include <iostream>
 #include <iomanip>
@@ -46,6 +47,12 @@ int main (int argc, char *argv[])
   uint16_t port = 5001;
   std::string bottleNeckLinkBw = "1Mbps";
   std::string bottleNeckLinkDelay = "50ms";
+  double      threshold = 0.6;
+  double      initPmark = 0.15;
+  double      pmarkIncrement = 0.0025;
+  double      pmarkDecrement = 0.00025;
+  std::string freezeTime = "10ms";
+  bool        csv = false;
 
   CommandLine cmd;
   cmd.AddValue ("nLeaf",     "Number of left and right side leaf nodes", nLeaf);
@@ -55,6 +62,12 @@ int main (int argc, char *argv[])
   cmd.AddValue ("appPktSize", "Set OnOff App Packet Size", pktSize);
   cmd.AddValue ("appDataRate", "Set OnOff App DataRate", appDataRate);
   cmd.AddValue ("modeBytes", "Set QueueDisc mode to Packets <0> or bytes <1>", modeBytes);
+  cmd.AddValue ("threshold", "Set the Gentle-BLUE threshold", threshold);
+  cmd.AddValue ("initPmark", "Set the Gentle-BLUE initial marking probability", initPmark);
+  cmd.AddValue ("pmarkIncrement", "Set the BLUE marking probability increment", pmarkIncrement);
+  cmd.AddValue ("pmarkDecrement", "Set the BLUE marking probability decrement", pmarkDecrement);
+  cmd.AddValue ("freezeTime", "Set the BLUE freeze time", freezeTime);
+  cmd.AddValue ("csv", "Print the results as a CSV header and row", csv);
 
   cmd.Parse (argc,argv);
 
@@ -87,8 +100,11 @@ int main (int argc, char *argv[])
   }
 
   Config::SetDefault ("ns3::BlueQueueDisc::PMark", DoubleValue (0.0));
-  Config::SetDefault ("ns3::BlueQueueDisc::Increment", DoubleValue (0.0025));
-  Config::SetDefault ("ns3::BlueQueueDisc::Decrement", DoubleValue (0.00025));
+  Config::SetDefault ("ns3::BlueQueueDisc::Increment", DoubleValue (pmarkIncrement));
+  Config::SetDefault ("ns3::BlueQueueDisc::Decrement", DoubleValue (pmarkDecrement));
+  Config::SetDefault ("ns3::BlueQueueDisc::FreezeTime", StringValue (freezeTime));
+  Config::SetDefault ("ns3::BlueQueueDisc::Thresold", DoubleValue (threshold));
+  Config::SetDefault ("ns3::BlueQueueDisc::IntiPmark", DoubleValue (initPmark));
   Config::SetDefault ("ns3::BlueQueueDisc::MeanPktSize", UintegerValue (pktSize));
 
   // Create the point-to-point link helpers
@@ -171,7 +187,16 @@ int main (int argc, char *argv[])
 
   Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
 
-  std::cout << "Running the simulation" << std::endl;
+  FlowMonitorHelper flowmon;
+  Ptr<FlowMonitor> monitor = flowmon.InstallAll ();
+  // The flow monitor checks for lost packets periodically, hence the
+  // simulation has to be stopped explicitly
+  Simulator::Stop (Seconds (30.0));
+
+  if (!csv)
+    {
+      std::cout << "Running the simulation" << std::endl;
+    }
   Simulator::Run ();
 
   uint32_t totalRxBytesCounter = 0;
@@ -181,14 +206,54 @@ int main (int argc, char *argv[])
       Ptr <PacketSink> pktSink = DynamicCast <PacketSink> (app);
       totalRxBytesCounter += pktSink->GetTotalRx ();
     }
-  NS_LOG_UNCOND ("----------------------------\nQueueDisc Type:" 
-                 << queueDiscType 
-                 << "\nGoodput Bytes/sec:" 
-                 << totalRxBytesCounter/Simulator::Now ().GetSeconds ()); 
-  NS_LOG_UNCOND ("----------------------------");
 
+  // Mean one-way delay of the received packets
+  monitor->CheckForLostPackets ();
+  FlowMonitor::FlowStatsContainer stats = monitor->GetFlowStats ();
+  Time delaySum;
+  uint64_t rxPackets = 0;
+  uint64_t lostPackets = 0;
+  for (FlowMonitor::FlowStatsContainer::const_iterator it = stats.begin (); it != stats.end (); ++it)
+    {
+      delaySum += it->second.delaySum;
+      rxPackets += it->second.rxPackets;
+      lostPackets += it->second.lostPackets;
+    }
+  double meanDelay = (rxPackets > 0 ? delaySum.GetSeconds () / rxPackets : 0.0);
+
+  // Drops at the bottleneck, where the data packets are queued
+  Ptr<NetDevice> bottleNeckDevice = d.GetRight ()->GetDevice (0);
+  Ptr<QueueDisc> queueDisc = d.GetRight ()->GetObject<TrafficControlLayer> ()->GetRootQueueDiscOnDevice (bottleNeckDevice);
+  BlueQueueDisc::Stats st = {0, 0, 0};
+  Ptr<BlueQueueDisc> blue = DynamicCast<BlueQueueDisc> (queueDisc);
+  if (blue != 0)
+    {
+      st = blue->GetStats ();
+    }
+  uint32_t queueDiscDrops = (queueDisc != 0 ? queueDisc->GetTotalDroppedPackets () : 0);
+  double goodput = totalRxBytesCounter / Simulator::Now ().GetSeconds ();
+
+  if (csv)
+    {
+      std::cout << "goodput,meanDelay,rxPackets,lostPackets,queueDiscDrops,unforcedDrop,forcedDrop,unforcedMark" << std::endl;
+      std::cout << goodput << "," << meanDelay << "," << rxPackets << "," << lostPackets << ","
+                << queueDiscDrops << "," << st.unforcedDrop << "," << st.forcedDrop << "," << st.unforcedMark << std::endl;
+    }
+  else
+    {
+      NS_LOG_UNCOND ("----------------------------\nQueueDisc Type:" 
+                     << queueDiscType 
+                     << "\nGoodput Bytes/sec:" 
+                     << goodput
+                     << "\nMean delay (s):"
+                     << meanDelay
+                     << "\nQueueDisc drops:"
+                     << queueDiscDrops); 
+      NS_LOG_UNCOND ("----------------------------");
+
+      std::cout << "Destroying the simulation" << std::endl;
+    }
 
-  std::cout << "Destroying the simulation" << std::endl;
   Simulator::Destroy ();
   return 0;
 }
@@ -23,10 +23,13 @@
 #include "ns3/enum.h"
 #include "ns3/uinteger.h"
 #include "ns3/double.h"
+#include "ns3/string.h"
 #include "ns3/simulator.h"
 #include "ns3/abort.h"
 #include "blue-queue-disc.h"
 #include "ns3/drop-tail-queue.h"
+#include <fstream>
+#include <algorithm>
 
 namespace ns3 {
 
@@ -34,6 +37,9 @@ NS_LOG_COMPONENT_DEFINE ("BlueQueueDisc");
 
 NS_OBJECT_ENSURE_REGISTERED (BlueQueueDisc);
 
+const double BlueQueueDisc::MIN_STEP = 1e-6;
+const double BlueQueueDisc::MAX_STEP = 1.0;
+
 TypeId BlueQueueDisc::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::BlueQueueDisc")
@@ -79,25 +85,92 @@ TypeId BlueQueueDisc::GetTypeId (void)
     .AddAttribute ("Thresold",
                    "Congestion Indicator",
                    DoubleValue (0.6),
-                   MakeDoubleAccessor (&BlueQueueDisc::m_threshold),
-                   MakeDoubleChecker<double> ())
+                   MakeDoubleAccessor (&BlueQueueDisc::SetThreshold,
+                                       &BlueQueueDisc::GetThreshold),
+                   MakeDoubleChecker<double> (0.0, 1.0))
     .AddAttribute ("IntiPmark",
                    "Initial Marking Probability",
                    DoubleValue (0.15),
-                   MakeDoubleAccessor (&BlueQueueDisc::m_initPmark),
-                   MakeDoubleChecker<double> ())
+                   MakeDoubleAccessor (&BlueQueueDisc::SetInitPmark,
+                                       &BlueQueueDisc::GetInitPmark),
+                   MakeDoubleChecker<double> (0.0, 1.0))
     .AddAttribute ("GentleBlue",
                    "True to enable Gentle BLUE",
                    BooleanValue (false),
                    MakeBooleanAccessor (&BlueQueueDisc::m_isGentleBlue),
                    MakeBooleanChecker ())
+    .AddAttribute ("AdaptiveBlue",
+                   "True to adapt Increment, Decrement and FreezeTime to reach the target delay",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&BlueQueueDisc::m_isAdaptive),
+                   MakeBooleanChecker ())
+    .AddAttribute ("TargetDelay",
+                   "Target average queuing delay in adaptive BLUE",
+                   TimeValue (MilliSeconds (20)),
+                   MakeTimeAccessor (&BlueQueueDisc::m_targetDelay),
+                   MakeTimeChecker ())
+    .AddAttribute ("Interval",
+                   "Time interval to adapt Increment, Decrement and FreezeTime",
+                   TimeValue (Seconds (0.5)),
+                   MakeTimeAccessor (&BlueQueueDisc::m_interval),
+                   MakeTimeChecker ())
+    .AddAttribute ("Alpha",
+                   "Relative increase of the adapted parameters in adaptive BLUE",
+                   DoubleValue (0.25),
+                   MakeDoubleAccessor (&BlueQueueDisc::m_alpha),
+                   MakeDoubleChecker <double> (0, 1))
+    .AddAttribute ("Beta",
+                   "Relative decrease of the adapted parameters in adaptive BLUE",
+                   DoubleValue (0.9),
+                   MakeDoubleAccessor (&BlueQueueDisc::m_beta),
+                   MakeDoubleChecker <double> (0, 1))
+    .AddAttribute ("LinkBandwidth",
+                   "The BLUE link bandwidth, used to estimate the queuing delay and the link utilisation",
+                   DataRateValue (DataRate ("1.5Mbps")),
+                   MakeDataRateAccessor (&BlueQueueDisc::m_linkBandwidth),
+                   MakeDataRateChecker ())
+    .AddAttribute ("UseEcn",
+                   "True to mark ECN-capable packets instead of dropping them early",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&BlueQueueDisc::m_useEcn),
+                   MakeBooleanChecker ())
+    .AddAttribute ("RngBatchSize",
+                   "Number of uniform random values drawn at once for the drop decision",
+                   UintegerValue (64),
+                   MakeUintegerAccessor (&BlueQueueDisc::m_rngBatchSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("EventLogSize",
+                   "Number of most recent decisions kept in the event log (0 disables the log)",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&BlueQueueDisc::m_eventLogSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("EventLogFile",
+                   "File the event log is written to when the queue disc is disposed (empty for none)",
+                   StringValue (""),
+                   MakeStringAccessor (&BlueQueueDisc::m_eventLogFile),
+                   MakeStringChecker ())
+    .AddTraceSource ("Pmark",
+                     "Marking probability, updated when packets arrive or leave",
+                     MakeTraceSourceAccessor (&BlueQueueDisc::m_Pmark),
+                     "ns3::TracedValueCallback::Double")
+    .AddTraceSource ("Decision",
+                     "Decision taken on an incoming packet",
+                     MakeTraceSourceAccessor (&BlueQueueDisc::m_traceDecision),
+                     "ns3::BlueQueueDisc::DecisionTracedCallback")
   ;
 
   return tid;
 }
 
 BlueQueueDisc::BlueQueueDisc () :
-  QueueDisc ()
+  QueueDisc (),
+  m_queueLimit (0),
+  m_initPmark (0.0),
+  m_threshold (0.0),
+  m_rngBatchSize (1),
+  m_rngBatchIndex (0),
+  m_eventLogSize (0),
+  m_eventLogHead (0)
 {
   NS_LOG_FUNCTION (this);
   m_uv = CreateObject<UniformRandomVariable> ();
@@ -112,6 +185,11 @@ void
 BlueQueueDisc::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_eventLogSize > 0 && !m_eventLogFile.empty ())
+    {
+      DumpEventLog (m_eventLogFile);
+    }
+  m_eventLog.clear ();
   m_uv = 0;
   QueueDisc::DoDispose ();
 }
@@ -135,6 +213,86 @@ BlueQueueDisc::SetQueueLimit (uint32_t lim)
 {
   NS_LOG_FUNCTION (this << lim);
   m_queueLimit = lim;
+  UpdatePmarkTable ();
+}
+
+void
+BlueQueueDisc::SetThreshold (double threshold)
+{
+  NS_LOG_FUNCTION (this << threshold);
+  m_threshold = threshold;
+  UpdatePmarkTable ();
+}
+
+double
+BlueQueueDisc::GetThreshold (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_threshold;
+}
+
+void
+BlueQueueDisc::SetInitPmark (double initPmark)
+{
+  NS_LOG_FUNCTION (this << initPmark);
+  m_initPmark = initPmark;
+  UpdatePmarkTable ();
+}
+
+double
+BlueQueueDisc::GetInitPmark (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_initPmark;
+}
+
+void
+BlueQueueDisc::UpdatePmarkTable (void)
+{
+  NS_LOG_FUNCTION (this);
+  double queueLimit = m_queueLimit;
+  double thresholdQueueLimit = queueLimit * m_threshold;
+  double reverseInitPmark = 1 - m_initPmark;
+  // fraction of the queue above the threshold, i.e., (L - T) / L
+  double aboveThreshold = 0.0;
+  if (queueLimit > 0)
+    {
+      aboveThreshold = (queueLimit - thresholdQueueLimit) / queueLimit;
+    }
+
+  // Below the threshold, Pmark grows linearly from 0 to (L - T) / L * (1 - p0)
+  m_pmarkTable[0].upper = thresholdQueueLimit;
+  m_pmarkTable[0].offset = 0.0;
+  m_pmarkTable[0].slope = 0.0;
+  if (thresholdQueueLimit > 0)
+    {
+      m_pmarkTable[0].slope = aboveThreshold * reverseInitPmark / thresholdQueueLimit;
+    }
+
+  // Between the threshold and the queue limit, Pmark keeps growing with
+  // slope T / L^2 * (1 - p0)
+  m_pmarkTable[1].upper = queueLimit;
+  m_pmarkTable[1].offset = aboveThreshold * reverseInitPmark;
+  m_pmarkTable[1].slope = 0.0;
+  if (queueLimit > 0)
+    {
+      m_pmarkTable[1].slope = (1 - aboveThreshold) * reverseInitPmark / queueLimit;
+    }
+}
+
+double
+BlueQueueDisc::GetGentlePmark (uint32_t nQueued) const
+{
+  if (nQueued <= m_pmarkTable[0].upper)
+    {
+      return m_pmarkTable[0].offset + nQueued * m_pmarkTable[0].slope;
+    }
+  if (nQueued < m_pmarkTable[1].upper)
+    {
+      return m_pmarkTable[1].offset + nQueued * m_pmarkTable[1].slope;
+    }
+  // The queue is full: force a drop
+  return 1.0;
 }
 
 uint32_t
@@ -167,6 +325,8 @@ BlueQueueDisc::AssignStreams (int64_t stream)
 {
   NS_LOG_FUNCTION (this << stream);
   m_uv->SetStream (stream);
+  // discard the values drawn from the previous stream
+  m_rngBatchIndex = m_rngBatch.size ();
   return 1;
 }
 
@@ -176,79 +336,179 @@ BlueQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
   NS_LOG_FUNCTION (this << item);
 
   uint32_t nQueued = GetQueueSize ();
+  bool isMarked = false;
 
-  if(m_isGentleBlue)
-  {
-    UpdatePmark ();
+  if (m_isAdaptive && !m_isGentleBlue)
+    {
+      Time now = Simulator::Now ();
+      if (now >= m_lastAdapt + m_interval)
+        {
+          Adapt (now);
+        }
+      m_queueBytesSum += GetInternalQueue (0)->GetNBytes ();
+      m_queueSamples++;
+    }
 
-    // Drop due to queue limit: reactive
-    if(m_Pmark == 1.0)
+  if (m_isGentleBlue)
     {
-      m_stats.forcedDrop++;
+      UpdatePmark (nQueued);
 
-      Drop (item);
-      return false;
-        std::cout<<"Packet Dropped"<<std::endl;
+      // Drop due to queue limit: reactive
+      if (m_Pmark == 1.0
+          || (GetMode () == Queue::QUEUE_MODE_BYTES && nQueued + item->GetPacketSize () > m_queueLimit))
+        {
+          NS_LOG_LOGIC ("Forced drop, queue size " << nQueued);
+          RecordDecision (nQueued, FORCED_DROP);
+          m_stats.forcedDrop++;
+          Drop (item);
+          return false;
+        }
+      else if (DropEarly (item->GetPacketSize ()))
+        {
+          if (m_useEcn && item->Mark ())
+            {
+              NS_LOG_LOGIC ("Unforced mark, queue size " << nQueued << " Pmark " << m_Pmark.Get ());
+              RecordDecision (nQueued, UNFORCED_MARK);
+              m_stats.unforcedMark++;
+              isMarked = true;
+            }
+          else
+            {
+              NS_LOG_LOGIC ("Unforced drop, queue size " << nQueued << " Pmark " << m_Pmark.Get ());
+              RecordDecision (nQueued, UNFORCED_DROP);
+              m_stats.unforcedDrop++;
+              Drop (item);
+              return false;
+            }
+        }
     }
-    else
+  else
     {
-      if(DropEarly ())
-      {
-        m_stats.unforcedDrop++;
-        std::cout<<"Packet Dropped"<<std::endl;
-        Drop (item);
-        return false;
-      }
-         std::cout<<"Packet Enqueued"<<std::endl;
-      // No drop
-      bool isEnqueued = GetInternalQueue (0)->Enqueue (item);
+      if (m_isIdle)
+        {
+          DecrementPmark ();
+          m_isIdle = false; // not idle anymore
+        }
+
+      if ((GetMode () == Queue::QUEUE_MODE_PACKETS && nQueued >= m_queueLimit)
+          || (GetMode () == Queue::QUEUE_MODE_BYTES && nQueued + item->GetPacketSize () > m_queueLimit))
+        {
+          NS_LOG_LOGIC ("Forced drop, queue size " << nQueued);
+          RecordDecision (nQueued, FORCED_DROP);
 
-      NS_LOG_LOGIC ("\t bytesInQueue  " << GetInternalQueue (0)->GetNBytes ());
-      NS_LOG_LOGIC ("\t packetsInQueue  " << GetInternalQueue (0)->GetNPackets ());
+          // Increment the Pmark
+          IncrementPmark ();
 
-      return isEnqueued;
+          // Drops due to queue limit: reactive
+          m_stats.forcedDrop++;
+          Drop (item);
+          return false;
+        }
+      else if (DropEarly (item->GetPacketSize ()))
+        {
+          // Increment the Pmark
+          IncrementPmark ();
+
+          if (m_useEcn && item->Mark ())
+            {
+              NS_LOG_LOGIC ("Unforced mark, queue size " << nQueued << " Pmark " << m_Pmark.Get ());
+              RecordDecision (nQueued, UNFORCED_MARK);
+
+              // Early probability mark: proactive
+              m_stats.unforcedMark++;
+              isMarked = true;
+            }
+          else
+            {
+              NS_LOG_LOGIC ("Unforced drop, queue size " << nQueued << " Pmark " << m_Pmark.Get ());
+              RecordDecision (nQueued, UNFORCED_DROP);
+
+              // Early probability drop: proactive
+              m_stats.unforcedDrop++;
+              Drop (item);
+              return false;
+            }
+        }
     }
-  }
-  else
-  {
-          std::cout<<nQueued<<std::endl;
-    if (m_isIdle)
+
+  // No drop
+  bool isEnqueued = GetInternalQueue (0)->Enqueue (item);
+  if (!isEnqueued)
     {
-      DecrementPmark ();
-      m_isIdle = false; // not idle anymore
+      // the internal queue dropped the packet
+      RecordDecision (nQueued, FORCED_DROP);
+    }
+  else if (!isMarked)
+    {
+      RecordDecision (nQueued, ENQUEUED);
     }
 
-    if ((GetMode () == Queue::QUEUE_MODE_PACKETS && nQueued >= m_queueLimit)
-        || (GetMode () == Queue::QUEUE_MODE_BYTES && nQueued + item->GetPacketSize () > m_queueLimit))
-      {
-        // Increment the Pmark
-        IncrementPmark ();
+  NS_LOG_LOGIC ("\t bytesInQueue  " << GetInternalQueue (0)->GetNBytes ());
+  NS_LOG_LOGIC ("\t packetsInQueue  " << GetInternalQueue (0)->GetNPackets ());
 
-        // Drops due to queue limit: reactive
-        m_stats.forcedDrop++;
+  return isEnqueued;
+}
 
-       Drop (item);
-       return false;
-      }
-    else if (DropEarly ())
-       {
-         // Increment the Pmark
-         IncrementPmark ();
+void
+BlueQueueDisc::RecordDecision (uint32_t nQueued, Verdict verdict)
+{
+  Event event;
+  event.time = Simulator::Now ().GetTimeStep ();
+  event.qlen = nQueued;
+  event.verdict = verdict;
+  event.pmark = m_Pmark;
+
+  if (m_eventLogSize > 0)
+    {
+      if (m_eventLog.size () < m_eventLogSize)
+        {
+          m_eventLog.push_back (event);
+        }
+      else
+        {
+          // the log is full: overwrite the oldest decision
+          m_eventLog[m_eventLogHead] = event;
+          m_eventLogHead = (m_eventLogHead + 1) % m_eventLogSize;
+        }
+    }
 
-         // Early probability drop: proactive
-         m_stats.unforcedDrop++;
-         Drop (item);
-         return false;
-       }
+  m_traceDecision (event);
+}
 
-    // No drop
-    bool isEnqueued = GetInternalQueue (0)->Enqueue (item);
+std::vector<BlueQueueDisc::Event>
+BlueQueueDisc::GetEventLog (void) const
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<Event> events;
+  events.reserve (m_eventLog.size ());
+  events.insert (events.end (), m_eventLog.begin () + m_eventLogHead, m_eventLog.end ());
+  events.insert (events.end (), m_eventLog.begin (), m_eventLog.begin () + m_eventLogHead);
+  return events;
+}
 
-    NS_LOG_LOGIC ("\t bytesInQueue  " << GetInternalQueue (0)->GetNBytes ());
-    NS_LOG_LOGIC ("\t packetsInQueue  " << GetInternalQueue (0)->GetNPackets ());
+bool
+BlueQueueDisc::DumpEventLog (std::string filename) const
+{
+  NS_LOG_FUNCTION (this << filename);
+  std::ofstream os (filename.c_str (), std::ios::out | std::ios::binary);
+  if (!os)
+    {
+      NS_LOG_ERROR ("Cannot open " << filename);
+      return false;
+    }
 
-    return isEnqueued;
-  }
+  std::vector<Event> events = GetEventLog ();
+  uint32_t header[4];
+  header[0] = EVENT_LOG_MAGIC;
+  header[1] = EVENT_LOG_VERSION;
+  header[2] = sizeof (Event);
+  header[3] = events.size ();
+  os.write (reinterpret_cast<const char *> (header), sizeof (header));
+  if (!events.empty ())
+    {
+      os.write (reinterpret_cast<const char *> (&events[0]), events.size () * sizeof (Event));
+    }
+  return os.good ();
 }
 
 void
@@ -258,14 +518,51 @@ BlueQueueDisc::InitializeParams (void)
   m_idleStartTime = Time (Seconds (0.0));
   m_stats.forcedDrop = 0;
   m_stats.unforcedDrop = 0;
+  m_stats.unforcedMark = 0;
+  m_lastAdapt = Simulator::Now ();
+  m_queueBytesSum = 0;
+  m_queueSamples = 0;
+  m_txBytes = 0;
+  m_nIncrements = 0;
+  m_nDecrements = 0;
   m_isIdle = true;
+  m_rngBatch.clear ();
+  m_rngBatchIndex = 0;
+  m_eventLog.clear ();
+  m_eventLog.reserve (m_eventLogSize);
+  m_eventLogHead = 0;
+  UpdatePmarkTable ();
 }
 
-bool BlueQueueDisc::DropEarly (void)
+double
+BlueQueueDisc::GetUniform (void)
 {
-  NS_LOG_FUNCTION (this);
-  double u =  m_uv->GetValue ();
-  if (u <= m_Pmark)
+  if (m_rngBatchIndex >= m_rngBatch.size ())
+    {
+      // Values are consumed in the order they are drawn, hence the sequence
+      // seen by DropEarly is the same as when drawing one value per packet
+      m_rngBatch.resize (m_rngBatchSize);
+      for (uint32_t i = 0; i < m_rngBatchSize; i++)
+        {
+          m_rngBatch[i] = m_uv->GetValue ();
+        }
+      m_rngBatchIndex = 0;
+    }
+  return m_rngBatch[m_rngBatchIndex++];
+}
+
+bool BlueQueueDisc::DropEarly (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  double pmark = m_Pmark;
+  if (m_isGentleBlue && GetMode () == Queue::QUEUE_MODE_BYTES)
+    {
+      // In byte mode, the probability is scaled by the packet size, so that
+      // small packets (e.g., ACKs) are less likely to be dropped than large ones
+      pmark = std::min (pmark * size / m_meanPktSize, 1.0);
+    }
+  double u = GetUniform ();
+  if (u <= pmark)
     {
       return true;
     }
@@ -278,12 +575,9 @@ void BlueQueueDisc::IncrementPmark (void)
   Time now = Simulator::Now ();
   if (now - m_lastUpdateTime > m_freezeTime)
     {
-      m_Pmark += m_increment;
+      m_Pmark = std::min (m_Pmark.Get () + m_increment, 1.0);
       m_lastUpdateTime = now;
-      if (m_Pmark > 1.0)
-        {
-          m_Pmark = 1.0;
-        }
+      m_nIncrements++;
     }
 }
 
@@ -293,51 +587,109 @@ void BlueQueueDisc::DecrementPmark (void)
   Time now = Simulator::Now ();
   if (m_isIdle)
     {
-      uint32_t m = 0; // stores the number of times Pmark should be decremented
-      m = ((now - m_idleStartTime) / m_freezeTime);
-      m_Pmark -= (m_decrement * m);
+      uint32_t m = GetIdleDecrements (now); // number of times Pmark should be decremented
+      m_Pmark = std::max (m_Pmark.Get () - m_decrement * m, 0.0);
       m_lastUpdateTime = now;
-      if (m_Pmark < 0.0)
-        {
-          m_Pmark = 0.0;
-        }
+      m_nDecrements += (m > 0 ? 1 : 0);
     }
   else if (now - m_lastUpdateTime > m_freezeTime)
     {
-      m_Pmark -= m_decrement;
+      m_Pmark = std::max (m_Pmark.Get () - m_decrement, 0.0);
       m_lastUpdateTime = now;
-      if (m_Pmark < 0.0)
-        {
-          m_Pmark = 0.0;
-        }
+      m_nDecrements++;
     }
 }       
 
-void BlueQueueDisc::UpdatePmark (void)
+uint32_t
+BlueQueueDisc::GetIdleDecrements (Time now) const
+{
+  if (!m_freezeTime.IsStrictlyPositive ())
+    {
+      return 0;
+    }
+  return (now - m_idleStartTime) / m_freezeTime;
+}
+
+double
+BlueQueueDisc::GetPmark (void) const
 {
   NS_LOG_FUNCTION (this);
-  Time now = Simulator::Now ();
-  uint32_t nQueued = GetQueueSize ();
-  double thresholdQueueLimit = m_queueLimit * m_threshold;
-  double reverseInitPmark = 1 - m_initPmark;
-  if(nQueued >= 0 && nQueued <= thresholdQueueLimit)
-  {
-//    if(now - m_lastUpdateTime > m_freezeTime)
-//    {
-      m_Pmark = ((nQueued / thresholdQueueLimit) * ((m_queueLimit - thresholdQueueLimit) / m_queueLimit) * (reverseInitPmark));
-      m_lastUpdateTime = now;
-//    } 
-  }
-  else if(nQueued > thresholdQueueLimit && nQueued < m_queueLimit)
+  if (GetNInternalQueues () == 0)
     {
-      m_Pmark = ((m_queueLimit - thresholdQueueLimit) / m_queueLimit) * (reverseInitPmark) + (nQueued / m_queueLimit) * (1 - (m_queueLimit - thresholdQueueLimit)) * (reverseInitPmark);
-      m_lastUpdateTime = now;
+      // not initialized yet
+      return m_Pmark;
     }
-  else
-  {
-    m_Pmark = 0.0;
-    m_lastUpdateTime = now;
-  }
+
+  if (m_isGentleBlue)
+    {
+      // Pmark only depends on the current queue size
+      Ptr<Queue> queue = GetInternalQueue (0);
+      return GetGentlePmark (m_mode == Queue::QUEUE_MODE_BYTES ? queue->GetNBytes () : queue->GetNPackets ());
+    }
+
+  if (m_isIdle)
+    {
+      // Pmark is decremented once per freeze time elapsed in the idle period,
+      // which is applied when the next packet arrives
+      return std::max (m_Pmark.Get () - m_decrement * GetIdleDecrements (Simulator::Now ()), 0.0);
+    }
+
+  return m_Pmark;
+}
+
+void
+BlueQueueDisc::Adapt (Time now)
+{
+  NS_LOG_FUNCTION (this << now);
+  double interval = (now - m_lastAdapt).GetSeconds ();
+  double bitRate = m_linkBandwidth.GetBitRate ();
+  double meanQueueBytes = (m_queueSamples > 0 ? m_queueBytesSum / (double) m_queueSamples : 0.0);
+  double delay = 8.0 * meanQueueBytes / bitRate;
+  double utilisation = 8.0 * m_txBytes / (bitRate * interval);
+  double targetDelay = m_targetDelay.GetSeconds ();
+
+  if (delay > 1.2 * targetDelay)
+    {
+      // Pmark grows too slowly to control the queue: react faster
+      m_increment = std::min (m_increment * (1 + m_alpha), MAX_STEP);
+      m_decrement = std::max (m_decrement * m_beta, MIN_STEP);
+      if (m_nDecrements == 0 && m_freezeTime > m_targetDelay)
+        {
+          // shrink the freeze time down to the target delay, never raise it
+          m_freezeTime = Max (m_freezeTime * m_beta, m_targetDelay);
+        }
+    }
+  else if (delay < 0.8 * targetDelay && utilisation < 0.95)
+    {
+      // Pmark is too high to keep the link busy: back off
+      m_increment = std::max (m_increment * m_beta, MIN_STEP);
+      m_decrement = std::min (m_decrement * (1 + m_alpha), MAX_STEP);
+    }
+
+  if (m_nIncrements > 0 && m_nDecrements > 0)
+    {
+      // Pmark went both up and down: slow down its updates to damp the
+      // oscillations of the queue
+      m_freezeTime = Min (m_freezeTime * (1 + m_alpha), m_interval);
+    }
+
+  NS_LOG_DEBUG ("Delay " << delay << " utilisation " << utilisation
+                << " increment " << m_increment << " decrement " << m_decrement
+                << " freeze time " << m_freezeTime.GetSeconds ());
+
+  m_lastAdapt = now;
+  m_queueBytesSum = 0;
+  m_queueSamples = 0;
+  m_txBytes = 0;
+  m_nIncrements = 0;
+  m_nDecrements = 0;
+}
+
+void BlueQueueDisc::UpdatePmark (uint32_t nQueued)
+{
+  NS_LOG_FUNCTION (this << nQueued);
+  // In Gentle-BLUE, Pmark only depends on the queue size
+  m_Pmark = GetGentlePmark (nQueued);
 }
 
 Ptr<QueueDiscItem>
@@ -352,6 +704,17 @@ BlueQueueDisc::DoDequeue (void)
   NS_LOG_LOGIC ("Number packets " << GetInternalQueue (0)->GetNPackets ());
   NS_LOG_LOGIC ("Number bytes " << GetInternalQueue (0)->GetNBytes ());
 
+  if (item != 0)
+    {
+      m_txBytes += item->GetPacketSize ();
+    }
+
+  if (m_isGentleBlue)
+    {
+      // keep the traced Pmark in line with the queue size
+      UpdatePmark (GetQueueSize ());
+    }
+
   if (GetInternalQueue (0)->IsEmpty () && !m_isIdle)
     {
       NS_LOG_LOGIC ("Queue empty");
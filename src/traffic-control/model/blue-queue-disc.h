@@ -24,6 +24,8 @@
 #define BLUE_QUEUE_DISC_H
 
 #include <queue>
+#include <vector>
+#include <string>
 #include "ns3/packet.h"
 #include "ns3/queue-disc.h"
 #include "ns3/nstime.h"
@@ -32,6 +34,8 @@
 #include "ns3/timer.h"
 #include "ns3/event-id.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/traced-callback.h"
+#include "ns3/traced-value.h"
 
 namespace ns3 {
 
@@ -63,8 +67,46 @@ public:
   {
     uint32_t unforcedDrop;      //!< Early probability drops: proactive
     uint32_t forcedDrop;        //!< Drops due to queue limit: reactive
+    uint32_t unforcedMark;      //!< Early probability marks: proactive
   } Stats;
 
+  /**
+   * \brief Verdicts on an incoming packet
+   */
+  enum Verdict
+  {
+    ENQUEUED,          //!< The packet was enqueued
+    UNFORCED_DROP,     //!< Early probability drop
+    FORCED_DROP,       //!< Drop due to queue limit
+    UNFORCED_MARK,     //!< Early probability mark, the packet was enqueued
+  };
+
+  /**
+   * \brief A decision taken on an incoming packet
+   *
+   * Records are kept in a fixed-size ring buffer when the EventLogSize
+   * attribute is non-zero, and are written as is (native byte order) by
+   * DumpEventLog after a header made of EVENT_LOG_MAGIC, EVENT_LOG_VERSION,
+   * the record size and the number of records (four uint32_t).
+   */
+  struct Event
+  {
+    int64_t time;       //!< Time of the decision, in time steps
+    uint32_t qlen;      //!< Queue size (bytes or packets) seen by the packet
+    uint32_t verdict;   //!< Verdict on the packet
+    double pmark;       //!< Marking probability when the decision was taken
+  };
+
+  static const uint32_t EVENT_LOG_MAGIC = 0x45554c42;   //!< "BLUE" in little endian byte order
+  static const uint32_t EVENT_LOG_VERSION = 1;          //!< Version of the event log file format
+
+  /**
+   * TracedCallback signature for decisions on incoming packets.
+   *
+   * \param [in] event The decision.
+   */
+  typedef void (* DecisionTracedCallback)(const Event & event);
+
   /**
    * \brief Set the operating mode of this queue.
    *
@@ -93,6 +135,61 @@ public:
    */
   void SetQueueLimit (uint32_t lim);
 
+  /**
+   * \brief Set the fraction of the queue limit at which Gentle-BLUE
+   * switches to the steeper part of its marking curve.
+   *
+   * \param threshold The threshold, as a fraction of the queue limit.
+   */
+  void SetThreshold (double threshold);
+
+  /**
+   * \brief Get the Gentle-BLUE threshold.
+   *
+   * \returns The threshold, as a fraction of the queue limit.
+   */
+  double GetThreshold (void) const;
+
+  /**
+   * \brief Set the initial marking probability used by Gentle-BLUE.
+   *
+   * \param initPmark The initial marking probability.
+   */
+  void SetInitPmark (double initPmark);
+
+  /**
+   * \brief Get the initial marking probability used by Gentle-BLUE.
+   *
+   * \returns The initial marking probability.
+   */
+  double GetInitPmark (void) const;
+
+  /**
+   * \brief Get the Gentle-BLUE marking probability for a given queue size.
+   *
+   * The probability is read from a piecewise-linear table which is rebuilt
+   * only when QueueLimit, Threshold or IntiPmark change, so that a lookup
+   * costs a couple of compares and one multiply-add.
+   *
+   * \param nQueued The queue size in bytes or packets.
+   * \returns The marking probability.
+   */
+  double GetGentlePmark (uint32_t nQueued) const;
+
+  /**
+   * \brief Get the current marking probability.
+   *
+   * The value is computed in closed form from the state left by the last
+   * packet: in Gentle-BLUE mode, from the current queue size; in BLUE mode,
+   * from the value at the start of the idle period (if the queue is idle)
+   * minus one Decrement per FreezeTime elapsed since. No event is scheduled
+   * to update Pmark, and the Pmark trace source only fires when the value
+   * is updated by a packet.
+   *
+   * \returns The marking probability the next packet would see.
+   */
+  double GetPmark (void) const;
+
   /**
    * \brief Get queue delay
    */
@@ -105,6 +202,21 @@ public:
    */
   Stats GetStats ();
 
+  /**
+   * \brief Get the decisions recorded in the event log.
+   *
+   * \returns The most recent decisions (at most EventLogSize), oldest first.
+   */
+  std::vector<Event> GetEventLog (void) const;
+
+  /**
+   * \brief Write the event log to a binary file.
+   *
+   * \param filename The name of the file.
+   * \returns True if the file was successfully written.
+   */
+  bool DumpEventLog (std::string filename) const;
+
   /**
    * Assign a fixed random variable stream number to the random variables
    * used by this model.  Return the number of streams (possibly zero) that
@@ -141,25 +253,78 @@ protected:
    */
   virtual void DecrementPmark (void);
 
+  /**
+   * \brief Adapt the increment, the decrement and the freeze time to the
+   * queuing delay and the link utilisation observed since the last call
+   * \param now the current time
+   */
+  virtual void Adapt (Time now);
+
   /**
    * \brief update the m_Pmark based on Gentle-BLUE
+   * \param nQueued the current queue size in bytes or packets
    */
-  virtual void UpdatePmark (void);
+  virtual void UpdatePmark (uint32_t nQueued);
 
   /**
    * \brief Check if a packet needs to be dropped due to probability drop
+   *
+   * In Gentle-BLUE byte mode, the marking probability is scaled by the
+   * ratio of the packet size to MeanPktSize.
+   *
+   * \param size the size of the packet in bytes
    * \returns false for no drop, true for drop
    */
-  virtual bool DropEarly (void);
+  virtual bool DropEarly (uint32_t size);
 
 private:
+  /**
+   * \brief Get the number of freeze times elapsed in the idle period
+   * \param now the current time
+   * \returns the number of times Pmark has to be decremented
+   */
+  uint32_t GetIdleDecrements (Time now) const;
+
+  /**
+   * \brief Rebuild the Gentle-BLUE marking probability table
+   */
+  void UpdatePmarkTable (void);
+
+  /**
+   * \brief Record a decision in the event log and notify the trace sinks
+   * \param nQueued the queue size seen by the packet
+   * \param verdict the verdict on the packet
+   */
+  void RecordDecision (uint32_t nQueued, Verdict verdict);
+
+  /**
+   * \brief Get the next uniform random value from the pre-drawn batch
+   * \returns a uniform random value in [0, 1)
+   */
+  double GetUniform (void);
+
+  /**
+   * \brief A segment of the piecewise-linear Gentle-BLUE marking curve
+   *
+   * Over the queue sizes it covers, the marking probability is
+   * Pmark (queue) = offset + queue * slope.  The first segment starts at
+   * an empty queue, and each other segment starts just above the upper
+   * bound of the previous one.
+   */
+  struct PmarkSegment
+  {
+    double upper;   //!< Largest queue size covered by this segment
+    double offset;  //!< Intercept of the linear Pmark (queue) function of this segment, i.e., its value extrapolated to an empty queue
+    double slope;   //!< Marking probability increase per byte / packet
+  };
+
   Queue::QueueMode m_mode;                      //!< Mode (bytes or packets)
   uint32_t m_queueLimit;                        //!< Queue limit in bytes / packets
   Stats m_stats;                                //!< BLUE statistics
   Ptr<UniformRandomVariable> m_uv;              //!< Rng stream
 
   // ** Variables supplied by user
-  double m_Pmark;                               //!< Marking Probability
+  TracedValue<double> m_Pmark;                  //!< Marking Probability
   uint32_t m_meanPktSize;                       //!< Average Packet Size
   double m_increment;                           //!< increment value for marking probability
   double m_decrement;                           //!< decrement value for marking probability
@@ -172,8 +337,39 @@ private:
 
   // ** Variables maintained by Gentle-BLUE
   bool m_isGentleBlue;                          //!< True to enable Feng's Adaptive RED
+  bool m_useEcn;                                //!< True to mark ECN-capable packets instead of dropping them early
   double m_initPmark;                           //!< Initial Marking Probability
-  double m_threshold;                           //!< 
+  double m_threshold;                           //!< Fraction of the queue limit where the marking curve gets steeper
+  PmarkSegment m_pmarkTable[2];                 //!< Piecewise-linear Gentle-BLUE marking curve
+
+  // ** Variables maintained by adaptive BLUE
+  bool m_isAdaptive;                            //!< True to adapt m_increment, m_decrement and m_freezeTime
+  Time m_targetDelay;                           //!< Target average queuing delay
+  Time m_interval;                              //!< Time interval between adaptations
+  double m_alpha;                               //!< Relative increase of the adapted parameters
+  double m_beta;                                //!< Relative decrease of the adapted parameters
+  DataRate m_linkBandwidth;                     //!< Link bandwidth
+  Time m_lastAdapt;                             //!< Last time the parameters were adapted
+  uint64_t m_queueBytesSum;                     //!< Sum of the queue sizes (bytes) seen by incoming packets
+  uint32_t m_queueSamples;                      //!< Number of queue sizes in m_queueBytesSum
+  uint64_t m_txBytes;                           //!< Bytes dequeued since the last adaptation
+  uint32_t m_nIncrements;                       //!< Pmark increments since the last adaptation
+  uint32_t m_nDecrements;                       //!< Pmark decrements since the last adaptation
+
+  static const double MIN_STEP;                 //!< Smallest adapted increment / decrement
+  static const double MAX_STEP;                 //!< Largest adapted increment / decrement
+
+  // ** Pre-drawn uniform random values
+  uint32_t m_rngBatchSize;                      //!< Number of uniform values drawn at once
+  std::vector<double> m_rngBatch;               //!< Pre-drawn uniform values
+  uint32_t m_rngBatchIndex;                     //!< Index of the next unused value in m_rngBatch
+
+  // ** Decision history
+  uint32_t m_eventLogSize;                      //!< Capacity of the event log (0 to disable it)
+  std::string m_eventLogFile;                   //!< File the event log is written to on dispose
+  std::vector<Event> m_eventLog;                //!< Ring buffer of the most recent decisions
+  uint32_t m_eventLogHead;                      //!< Index of the oldest decision once the log is full
+  TracedCallback<const Event &> m_traceDecision; //!< Fired for every decision on an incoming packet
 };
 
 } // namespace ns3
@@ -67,6 +67,12 @@ QueueDiscItem::SetTxQueueIndex (uint8_t txq)
   m_txq = txq;
 }
 
+bool
+QueueDiscItem::Mark (void)
+{
+  return false;
+}
+
 void
 QueueDiscItem::Print (std::ostream& os) const
 {
@@ -404,7 +410,10 @@ QueueDisc::Drop (Ptr<QueueDiscItem> item)
   m_nTotalDroppedBytes += item->GetPacketSize ();
 
   NS_LOG_LOGIC ("m_traceDrop (p)");
-  m_traceDrop (item);
+  if (!m_traceDrop.IsEmpty ())
+    {
+      m_traceDrop (item);
+    }
 }
 
 bool
@@ -418,7 +427,10 @@ QueueDisc::Enqueue (Ptr<QueueDiscItem> item)
   m_nTotalReceivedBytes += item->GetPacketSize ();
 
   NS_LOG_LOGIC ("m_traceEnqueue (p)");
-  m_traceEnqueue (item);
+  if (!m_traceEnqueue.IsEmpty ())
+    {
+      m_traceEnqueue (item);
+    }
 
   return DoEnqueue (item);
 }
@@ -437,7 +449,10 @@ QueueDisc::Dequeue (void)
       m_nBytes -= item->GetPacketSize ();
 
       NS_LOG_LOGIC ("m_traceDequeue (p)");
-      m_traceDequeue (item);
+      if (!m_traceDequeue.IsEmpty ())
+        {
+          m_traceDequeue (item);
+        }
     }
 
   return item;
@@ -527,7 +542,10 @@ QueueDisc::DequeuePacket ()
             m_nBytes -= item->GetPacketSize ();
 
             NS_LOG_LOGIC ("m_traceDequeue (p)");
-            m_traceDequeue (item);
+            if (!m_traceDequeue.IsEmpty ())
+              {
+                m_traceDequeue (item);
+              }
           }
     }
   else
@@ -564,7 +582,10 @@ QueueDisc::Requeue (Ptr<QueueDiscItem> item)
   m_nTotalRequeuedBytes += item->GetPacketSize ();
 
   NS_LOG_LOGIC ("m_traceRequeue (p)");
-  m_traceRequeue (item);
+  if (!m_traceRequeue.IsEmpty ())
+    {
+      m_traceRequeue (item);
+    }
 }
 
 bool
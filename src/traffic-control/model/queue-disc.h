@@ -85,6 +85,17 @@ public:
    */
   virtual void AddHeader (void) = 0;
 
+  /**
+   * \brief Mark the packet as having experienced congestion
+   *
+   * Subclasses storing packets of protocols that support Explicit Congestion
+   * Notification set the Congestion Experienced codepoint, if the packet was
+   * sent by an ECN-capable transport. The default implementation does nothing.
+   *
+   * \return true if the packet has been marked, false otherwise.
+   */
+  virtual bool Mark (void);
+
   /**
    * \brief Print the item contents.
    * \param os output stream in which the data should be printed.
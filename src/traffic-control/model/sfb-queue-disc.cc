@@ -0,0 +1,545 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Sourabh Jain <sourabhjain560@outlook.com>
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+#include "ns3/log.h"
+#include "ns3/enum.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/simulator.h"
+#include "ns3/abort.h"
+#include "ns3/hash.h"
+#include "sfb-queue-disc.h"
+#include "ns3/drop-tail-queue.h"
+#include <algorithm>
+#include <limits>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SfbQueueDisc");
+
+NS_OBJECT_ENSURE_REGISTERED (SfbQueueDisc);
+
+TypeId SfbQueueDisc::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::SfbQueueDisc")
+    .SetParent<QueueDisc> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<SfbQueueDisc> ()
+    .AddAttribute ("Mode",
+                   "Determines unit for QueueLimit and the bin sizes",
+                   EnumValue (Queue::QUEUE_MODE_PACKETS),
+                   MakeEnumAccessor (&SfbQueueDisc::SetMode),
+                   MakeEnumChecker (Queue::QUEUE_MODE_BYTES, "QUEUE_MODE_BYTES",
+                                    Queue::QUEUE_MODE_PACKETS, "QUEUE_MODE_PACKETS"))
+    .AddAttribute ("QueueLimit",
+                   "Queue limit in bytes/packets",
+                   UintegerValue (1000),
+                   MakeUintegerAccessor (&SfbQueueDisc::SetQueueLimit),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Levels",
+                   "Number of levels of bins",
+                   UintegerValue (8),
+                   MakeUintegerAccessor (&SfbQueueDisc::m_levels),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("BinsPerLevel",
+                   "Number of bins in each level (a power of two)",
+                   UintegerValue (16),
+                   MakeUintegerAccessor (&SfbQueueDisc::m_binsPerLevel),
+                   MakeUintegerChecker<uint32_t> (2))
+    .AddAttribute ("TargetBinSize",
+                   "Bin occupancy in bytes/packets at which the marking probability of the bin reaches 1",
+                   UintegerValue (20),
+                   MakeUintegerAccessor (&SfbQueueDisc::m_targetBinSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("MaxBinSize",
+                   "Largest bin occupancy in bytes/packets",
+                   UintegerValue (25),
+                   MakeUintegerAccessor (&SfbQueueDisc::m_maxBinSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Threshold",
+                   "Fraction of the target bin size at which the marking probability grows faster",
+                   DoubleValue (0.6),
+                   MakeDoubleAccessor (&SfbQueueDisc::m_threshold),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("InitPmark",
+                   "Initial Marking Probability",
+                   DoubleValue (0.15),
+                   MakeDoubleAccessor (&SfbQueueDisc::m_initPmark),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("PenaltyRate",
+                   "Rate (packets per second) at which the flows with a marking probability of 1 may enqueue packets",
+                   DoubleValue (10),
+                   MakeDoubleAccessor (&SfbQueueDisc::m_penaltyRate),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("PenaltyBurst",
+                   "Burst (packets) of the flows with a marking probability of 1",
+                   UintegerValue (20),
+                   MakeUintegerAccessor (&SfbQueueDisc::m_penaltyBurst),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("RehashInterval",
+                   "Interval between changes of the hash perturbation (0 to never change it)",
+                   TimeValue (Seconds (600)),
+                   MakeTimeAccessor (&SfbQueueDisc::m_rehashInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("WarmupTime",
+                   "Time the new set of bins accounts packets before the perturbation is changed",
+                   TimeValue (Seconds (60)),
+                   MakeTimeAccessor (&SfbQueueDisc::m_warmupTime),
+                   MakeTimeChecker ())
+  ;
+
+  return tid;
+}
+
+SfbQueueDisc::SfbQueueDisc () :
+  QueueDisc ()
+{
+  NS_LOG_FUNCTION (this);
+  m_uv = CreateObject<UniformRandomVariable> ();
+}
+
+SfbQueueDisc::~SfbQueueDisc ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+SfbQueueDisc::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_uv = 0;
+  m_packetInfo.clear ();
+  QueueDisc::DoDispose ();
+}
+
+void
+SfbQueueDisc::SetMode (Queue::QueueMode mode)
+{
+  NS_LOG_FUNCTION (this << mode);
+  m_mode = mode;
+}
+
+Queue::QueueMode
+SfbQueueDisc::GetMode (void)
+{
+  NS_LOG_FUNCTION (this);
+  return m_mode;
+}
+
+void
+SfbQueueDisc::SetQueueLimit (uint32_t lim)
+{
+  NS_LOG_FUNCTION (this << lim);
+  m_queueLimit = lim;
+}
+
+uint32_t
+SfbQueueDisc::GetQueueSize (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (GetMode () == Queue::QUEUE_MODE_BYTES)
+    {
+      return GetInternalQueue (0)->GetNBytes ();
+    }
+  else if (GetMode () == Queue::QUEUE_MODE_PACKETS)
+    {
+      return GetInternalQueue (0)->GetNPackets ();
+    }
+  else
+    {
+      NS_ABORT_MSG ("Unknown SFB mode.");
+    }
+}
+
+SfbQueueDisc::Stats
+SfbQueueDisc::GetStats ()
+{
+  NS_LOG_FUNCTION (this);
+  return m_stats;
+}
+
+int64_t
+SfbQueueDisc::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_uv->SetStream (stream);
+  return 1;
+}
+
+void
+SfbQueueDisc::UpdatePmarkTable (void)
+{
+  NS_LOG_FUNCTION (this);
+  // Same marking curve as Gentle-BLUE, with the target bin size in place
+  // of the queue limit
+  double target = m_targetBinSize;
+  double thresholdTarget = target * m_threshold;
+  double reverseInitPmark = 1 - m_initPmark;
+  double aboveThreshold = (target - thresholdTarget) / target;
+
+  m_pmarkTable[0].upper = thresholdTarget;
+  m_pmarkTable[0].offset = 0.0;
+  m_pmarkTable[0].slope = 0.0;
+  if (thresholdTarget > 0)
+    {
+      m_pmarkTable[0].slope = aboveThreshold * reverseInitPmark / thresholdTarget;
+    }
+
+  m_pmarkTable[1].upper = target;
+  m_pmarkTable[1].offset = aboveThreshold * reverseInitPmark;
+  m_pmarkTable[1].slope = (1 - aboveThreshold) * reverseInitPmark / target;
+}
+
+double
+SfbQueueDisc::GetBinPmark (uint32_t binSize) const
+{
+  if (binSize <= m_pmarkTable[0].upper)
+    {
+      return m_pmarkTable[0].offset + binSize * m_pmarkTable[0].slope;
+    }
+  if (binSize < m_pmarkTable[1].upper)
+    {
+      return m_pmarkTable[1].offset + binSize * m_pmarkTable[1].slope;
+    }
+  return 1.0;
+}
+
+uint64_t
+SfbQueueDisc::HashFlow (int32_t flow, uint32_t slot) const
+{
+  uint32_t buf[2];
+  buf[0] = static_cast<uint32_t> (flow);
+  buf[1] = m_perturbation[slot];
+  return Hash64 (reinterpret_cast<char *> (buf), sizeof (buf));
+}
+
+uint32_t
+SfbQueueDisc::GetMinBinSize (uint64_t hash, uint32_t slot) const
+{
+  const std::vector<uint32_t> &bins = m_bins[slot];
+  uint64_t mask = m_binsPerLevel - 1;
+  uint32_t minBinSize = std::numeric_limits<uint32_t>::max ();
+  for (uint32_t level = 0, offset = 0; level < m_levels; level++, offset += m_binsPerLevel)
+    {
+      uint32_t bin = offset + ((hash >> (level * m_binBits)) & mask);
+      minBinSize = std::min (minBinSize, bins[bin]);
+    }
+  return minBinSize;
+}
+
+void
+SfbQueueDisc::UpdateBins (uint64_t hash, uint32_t slot, uint32_t size, bool add)
+{
+  std::vector<uint32_t> &bins = m_bins[slot];
+  uint64_t mask = m_binsPerLevel - 1;
+  for (uint32_t level = 0, offset = 0; level < m_levels; level++, offset += m_binsPerLevel)
+    {
+      uint32_t bin = offset + ((hash >> (level * m_binBits)) & mask);
+      if (add)
+        {
+          bins[bin] += size;
+        }
+      else
+        {
+          bins[bin] -= std::min (bins[bin], size);
+        }
+    }
+}
+
+void
+SfbQueueDisc::Rehash (void)
+{
+  NS_LOG_FUNCTION (this);
+  // The set of bins in use is reset with a new perturbation, while the
+  // other set (which accounted packets during the warmup time) takes over.
+  // Packets accounted in the reset set are not removed from it on dequeue.
+  m_perturbation[m_slot] = m_uv->GetInteger (0, std::numeric_limits<uint32_t>::max ());
+  std::fill (m_bins[m_slot].begin (), m_bins[m_slot].end (), 0);
+  m_epoch[m_slot]++;
+  m_slot ^= 1;
+  m_doubleBuffering = false;
+  m_rehashTime = Simulator::Now () + m_rehashInterval;
+}
+
+bool
+SfbQueueDisc::RateLimit (void)
+{
+  NS_LOG_FUNCTION (this);
+  Time now = Simulator::Now ();
+  m_tokens += (now - m_lastTokenUpdate).GetSeconds () * m_penaltyRate;
+  m_tokens = std::min (m_tokens, static_cast<double> (m_penaltyBurst));
+  m_lastTokenUpdate = now;
+  if (m_tokens < 1.0)
+    {
+      return true;
+    }
+  m_tokens -= 1.0;
+  return false;
+}
+
+bool
+SfbQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  Time now = Simulator::Now ();
+  if (m_rehashInterval.IsStrictlyPositive () && now >= m_rehashTime)
+    {
+      Rehash ();
+    }
+  else if (!m_doubleBuffering && m_warmupTime.IsStrictlyPositive ()
+           && m_rehashInterval.IsStrictlyPositive () && now >= m_rehashTime - m_warmupTime)
+    {
+      NS_LOG_LOGIC ("Start accounting packets in both sets of bins");
+      m_doubleBuffering = true;
+    }
+
+  uint32_t nQueued = GetQueueSize ();
+  uint32_t size = (GetMode () == Queue::QUEUE_MODE_BYTES ? item->GetPacketSize () : 1);
+
+  // Drops due to queue limit: reactive
+  if (nQueued + size > m_queueLimit)
+    {
+      NS_LOG_LOGIC ("Queue full, queue size " << nQueued);
+      m_stats.forcedDrop++;
+      Drop (item);
+      return false;
+    }
+
+  int32_t flow = Classify (item);
+  if (flow == PacketFilter::PF_NO_MATCH)
+    {
+      NS_LOG_DEBUG ("No filter has been able to classify this packet, use flow 0");
+      flow = 0;
+    }
+
+  uint32_t other = m_slot ^ 1;
+  PacketInfo info;
+  info.size = size;
+  info.hash[m_slot] = HashFlow (flow, m_slot);
+  info.accounted[m_slot] = true;
+  info.accounted[other] = m_doubleBuffering;
+  if (m_doubleBuffering)
+    {
+      info.hash[other] = HashFlow (flow, other);
+    }
+
+  uint32_t minBinSize = GetMinBinSize (info.hash[m_slot], m_slot);
+  if (minBinSize + size > m_maxBinSize)
+    {
+      NS_LOG_LOGIC ("All the bins of flow " << flow << " are full");
+      m_stats.bucketDrop++;
+      Drop (item);
+      return false;
+    }
+
+  double pmark = GetBinPmark (minBinSize);
+  if (pmark >= 1.0)
+    {
+      // The flow does not respond to drops: rate limit it
+      if (RateLimit ())
+        {
+          NS_LOG_LOGIC ("Penalty drop, flow " << flow);
+          m_stats.penaltyDrop++;
+          Drop (item);
+          return false;
+        }
+    }
+  else if (m_uv->GetValue () < pmark)
+    {
+      // Early probability drop: proactive
+      NS_LOG_LOGIC ("Unforced drop, flow " << flow << " Pmark " << pmark);
+      m_stats.unforcedDrop++;
+      Drop (item);
+      return false;
+    }
+
+  bool isEnqueued = GetInternalQueue (0)->Enqueue (item);
+  if (isEnqueued)
+    {
+      UpdateBins (info.hash[m_slot], m_slot, size, true);
+      if (m_doubleBuffering)
+        {
+          UpdateBins (info.hash[other], other, size, true);
+        }
+      info.epoch[0] = m_epoch[0];
+      info.epoch[1] = m_epoch[1];
+      m_packetInfo.push_back (info);
+    }
+
+  NS_LOG_LOGIC ("\t bytesInQueue  " << GetInternalQueue (0)->GetNBytes ());
+  NS_LOG_LOGIC ("\t packetsInQueue  " << GetInternalQueue (0)->GetNPackets ());
+
+  return isEnqueued;
+}
+
+void
+SfbQueueDisc::InitializeParams (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_binBits = 0;
+  while ((1u << m_binBits) < m_binsPerLevel)
+    {
+      m_binBits++;
+    }
+
+  for (uint32_t slot = 0; slot < 2; slot++)
+    {
+      m_bins[slot].assign (m_levels * m_binsPerLevel, 0);
+      m_perturbation[slot] = m_uv->GetInteger (0, std::numeric_limits<uint32_t>::max ());
+      m_epoch[slot] = 0;
+    }
+  m_slot = 0;
+  m_doubleBuffering = false;
+  m_rehashTime = Simulator::Now () + m_rehashInterval;
+  m_tokens = m_penaltyBurst;
+  m_lastTokenUpdate = Simulator::Now ();
+  m_packetInfo.clear ();
+
+  m_stats.unforcedDrop = 0;
+  m_stats.forcedDrop = 0;
+  m_stats.bucketDrop = 0;
+  m_stats.penaltyDrop = 0;
+
+  UpdatePmarkTable ();
+}
+
+Ptr<QueueDiscItem>
+SfbQueueDisc::DoDequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Ptr<QueueDiscItem> item = StaticCast<QueueDiscItem> (GetInternalQueue (0)->Dequeue ());
+
+  if (item == 0)
+    {
+      NS_LOG_LOGIC ("Queue empty");
+      return 0;
+    }
+
+  NS_ASSERT (!m_packetInfo.empty ());
+  const PacketInfo &info = m_packetInfo.front ();
+  for (uint32_t slot = 0; slot < 2; slot++)
+    {
+      if (info.accounted[slot] && info.epoch[slot] == m_epoch[slot])
+        {
+          UpdateBins (info.hash[slot], slot, info.size, false);
+        }
+    }
+  m_packetInfo.pop_front ();
+
+  NS_LOG_LOGIC ("Popped " << item);
+
+  NS_LOG_LOGIC ("Number packets " << GetInternalQueue (0)->GetNPackets ());
+  NS_LOG_LOGIC ("Number bytes " << GetInternalQueue (0)->GetNBytes ());
+
+  return item;
+}
+
+Ptr<const QueueDiscItem>
+SfbQueueDisc::DoPeek () const
+{
+  NS_LOG_FUNCTION (this);
+  if (GetInternalQueue (0)->IsEmpty ())
+    {
+      NS_LOG_LOGIC ("Queue empty");
+      return 0;
+    }
+
+  Ptr<const QueueDiscItem> item = StaticCast<const QueueDiscItem> (GetInternalQueue (0)->Peek ());
+
+  NS_LOG_LOGIC ("Number packets " << GetInternalQueue (0)->GetNPackets ());
+  NS_LOG_LOGIC ("Number bytes " << GetInternalQueue (0)->GetNBytes ());
+
+  return item;
+}
+
+bool
+SfbQueueDisc::CheckConfig (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (GetNQueueDiscClasses () > 0)
+    {
+      NS_LOG_ERROR ("SfbQueueDisc cannot have classes");
+      return false;
+    }
+
+  if (GetNPacketFilters () == 0)
+    {
+      NS_LOG_ERROR ("SfbQueueDisc needs at least a packet filter to identify flows");
+      return false;
+    }
+
+  if ((m_binsPerLevel & (m_binsPerLevel - 1)) != 0)
+    {
+      NS_LOG_ERROR ("The number of bins per level must be a power of two");
+      return false;
+    }
+
+  uint32_t binBits = 0;
+  while ((1u << binBits) < m_binsPerLevel)
+    {
+      binBits++;
+    }
+  if (m_levels * binBits > 64)
+    {
+      NS_LOG_ERROR ("The bins of all the levels must be addressable with a 64-bit hash");
+      return false;
+    }
+
+  if (GetNInternalQueues () == 0)
+    {
+      // create a DropTail queue
+      Ptr<Queue> queue = CreateObjectWithAttributes<DropTailQueue> ("Mode", EnumValue (m_mode));
+      if (m_mode == Queue::QUEUE_MODE_PACKETS)
+        {
+          queue->SetMaxPackets (m_queueLimit);
+        }
+      else
+        {
+          queue->SetMaxBytes (m_queueLimit);
+        }
+      AddInternalQueue (queue);
+    }
+
+  if (GetNInternalQueues () != 1)
+    {
+      NS_LOG_ERROR ("SfbQueueDisc needs 1 internal queue");
+      return false;
+    }
+
+  if (GetInternalQueue (0)->GetMode () != m_mode)
+    {
+      NS_LOG_ERROR ("The mode of the provided queue does not match the mode set on the SfbQueueDisc");
+      return false;
+    }
+
+  if ((m_mode ==  Queue::QUEUE_MODE_PACKETS && GetInternalQueue (0)->GetMaxPackets () < m_queueLimit)
+      || (m_mode ==  Queue::QUEUE_MODE_BYTES && GetInternalQueue (0)->GetMaxBytes () < m_queueLimit))
+    {
+      NS_LOG_ERROR ("The size of the internal queue is less than the queue disc limit");
+      return false;
+    }
+
+  return true;
+}
+
+} //namespace ns3
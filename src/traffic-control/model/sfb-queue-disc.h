@@ -0,0 +1,251 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Sourabh Jain <sourabhjain560@outlook.com>
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+#ifndef SFB_QUEUE_DISC_H
+#define SFB_QUEUE_DISC_H
+
+#include <deque>
+#include <vector>
+#include "ns3/packet.h"
+#include "ns3/queue-disc.h"
+#include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
+
+namespace ns3 {
+
+class UniformRandomVariable;
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief A Stochastic Fair BLUE packet queue disc
+ *
+ * Packets are stored in a single FIFO queue, but the drop decision is taken
+ * per flow. Each flow is mapped, through a hash of the value returned by the
+ * packet filters and of a random perturbation, to one bin in each of the
+ * Levels levels of BinsPerLevel bins. Every bin counts the bytes or packets
+ * of the flows mapped to it and derives its own Gentle-BLUE marking
+ * probability from its occupancy. A packet is dropped with the smallest
+ * marking probability among the bins of its flow, so that a responsive flow
+ * is only penalized if it shares all of its bins with unresponsive flows.
+ * Flows whose marking probability is pinned at 1 are rate limited to
+ * PenaltyRate packets per second (with a burst of PenaltyBurst packets).
+ *
+ * Two sets of bins are kept: the perturbation of the set in use is changed
+ * every RehashInterval, and the other set starts accounting packets
+ * WarmupTime before it takes over, so that it is not empty when it does.
+ *
+ * The per-packet cost is one hash computation and Levels bin accesses for
+ * each set of bins in use, independently of the number of flows.
+ */
+class SfbQueueDisc : public QueueDisc
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief SfbQueueDisc Constructor
+   */
+  SfbQueueDisc ();
+
+  /**
+   * \brief SfbQueueDisc Destructor
+   */
+  virtual ~SfbQueueDisc ();
+
+  /**
+   * \brief Stats
+   */
+  typedef struct
+  {
+    uint32_t unforcedDrop;      //!< Early probability drops: proactive
+    uint32_t forcedDrop;        //!< Drops due to queue limit: reactive
+    uint32_t bucketDrop;        //!< Drops due to the bins of the flow being full
+    uint32_t penaltyDrop;       //!< Drops of rate limited flows
+  } Stats;
+
+  /**
+   * \brief Set the operating mode of this queue.
+   *
+   * \param mode The operating mode of this queue.
+   */
+  void SetMode (Queue::QueueMode mode);
+
+  /**
+   * \brief Get the encapsulation mode of this queue.
+   *
+   * \returns The encapsulation mode of this queue.
+   */
+  Queue::QueueMode GetMode (void);
+
+  /**
+   * \brief Get the current value of the queue in bytes or packets.
+   *
+   * \returns The queue size in bytes or packets.
+   */
+  uint32_t GetQueueSize (void);
+
+  /**
+   * \brief Set the limit of the queue in bytes or packets.
+   *
+   * \param lim The limit in bytes or packets.
+   */
+  void SetQueueLimit (uint32_t lim);
+
+  /**
+   * \brief Get the marking probability of a bin for a given occupancy.
+   *
+   * \param binSize The occupancy of the bin in bytes or packets.
+   * \returns The marking probability.
+   */
+  double GetBinPmark (uint32_t binSize) const;
+
+  /**
+   * \brief Get SFB statistics after running.
+   *
+   * \returns The drop statistics.
+   */
+  Stats GetStats ();
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.  Return the number of streams (possibly zero) that
+   * have been assigned.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+protected:
+  /**
+   * \brief Dispose of the object
+   */
+  virtual void DoDispose (void);
+
+private:
+  virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
+  virtual Ptr<QueueDiscItem> DoDequeue (void);
+  virtual Ptr<const QueueDiscItem> DoPeek (void) const;
+  virtual bool CheckConfig (void);
+  virtual void InitializeParams (void);
+
+  /**
+   * \brief Per-packet information needed to update the bins on dequeue
+   */
+  struct PacketInfo
+  {
+    uint64_t hash[2];       //!< Hash of the flow for each set of bins
+    uint32_t epoch[2];      //!< Epoch of each set of bins when the packet was enqueued
+    bool accounted[2];      //!< Whether the packet was accounted in each set of bins
+    uint32_t size;          //!< Bytes or packets accounted for the packet
+  };
+
+  /**
+   * \brief Compute the hash of a flow for a set of bins
+   * \param flow the value returned by the packet filters
+   * \param slot the set of bins
+   * \returns the hash of the flow
+   */
+  uint64_t HashFlow (int32_t flow, uint32_t slot) const;
+
+  /**
+   * \brief Get the smallest occupancy among the bins of a flow
+   * \param hash the hash of the flow
+   * \param slot the set of bins
+   * \returns the smallest occupancy
+   */
+  uint32_t GetMinBinSize (uint64_t hash, uint32_t slot) const;
+
+  /**
+   * \brief Add or remove a packet from the bins of its flow
+   * \param hash the hash of the flow
+   * \param slot the set of bins
+   * \param size the bytes or packets accounted for the packet
+   * \param add true to add the packet, false to remove it
+   */
+  void UpdateBins (uint64_t hash, uint32_t slot, uint32_t size, bool add);
+
+  /**
+   * \brief Change the perturbation of the set of bins in use, and start
+   * using the other set
+   */
+  void Rehash (void);
+
+  /**
+   * \brief Check whether a rate limited flow may enqueue a packet
+   * \returns true if the packet has to be dropped
+   */
+  bool RateLimit (void);
+
+  /**
+   * \brief Rebuild the per-bin marking probability table
+   */
+  void UpdatePmarkTable (void);
+
+  /**
+   * \brief A segment of the piecewise-linear Gentle-BLUE marking curve
+   */
+  struct PmarkSegment
+  {
+    double upper;   //!< Largest bin occupancy covered by this segment
+    double offset;  //!< Marking probability at an empty bin
+    double slope;   //!< Marking probability increase per byte / packet
+  };
+
+  Queue::QueueMode m_mode;                      //!< Mode (bytes or packets)
+  uint32_t m_queueLimit;                        //!< Queue limit in bytes / packets
+  Stats m_stats;                                //!< SFB statistics
+  Ptr<UniformRandomVariable> m_uv;              //!< Rng stream
+
+  // ** Variables supplied by user
+  uint32_t m_levels;                            //!< Number of levels of bins
+  uint32_t m_binsPerLevel;                      //!< Number of bins in each level
+  uint32_t m_targetBinSize;                     //!< Bin occupancy at which the marking probability reaches 1
+  uint32_t m_maxBinSize;                        //!< Largest bin occupancy
+  double m_threshold;                           //!< Fraction of the target bin size where the marking curve gets steeper
+  double m_initPmark;                           //!< Initial Marking Probability
+  double m_penaltyRate;                         //!< Rate of rate limited flows, in packets per second
+  uint32_t m_penaltyBurst;                      //!< Burst of rate limited flows, in packets
+  Time m_rehashInterval;                        //!< Interval between changes of the perturbation
+  Time m_warmupTime;                            //!< Time a new set of bins accounts packets before it is used
+
+  // ** Variables maintained by SFB
+  uint32_t m_binBits;                           //!< Number of hash bits used to select a bin in a level
+  std::vector<uint32_t> m_bins[2];              //!< Occupancy of the bins of each set
+  uint32_t m_perturbation[2];                   //!< Perturbation of the hash of each set of bins
+  uint32_t m_epoch[2];                          //!< Number of times each set of bins was reset
+  uint32_t m_slot;                              //!< Set of bins in use
+  bool m_doubleBuffering;                       //!< True if packets are accounted in both sets of bins
+  Time m_rehashTime;                            //!< Time of the next change of the perturbation
+  double m_tokens;                              //!< Tokens available to rate limited flows
+  Time m_lastTokenUpdate;                       //!< Last time the tokens were updated
+  std::deque<PacketInfo> m_packetInfo;          //!< Information on the queued packets, in FIFO order
+  PmarkSegment m_pmarkTable[2];                 //!< Piecewise-linear Gentle-BLUE marking curve of a bin
+};
+
+} // namespace ns3
+
+#endif // SFB_QUEUE_DISC_H
@@ -26,8 +26,12 @@
 #include "ns3/uinteger.h"
 #include "ns3/string.h"
 #include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/data-rate.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
+#include <fstream>
+#include <algorithm>
 
 using namespace ns3;
 
@@ -58,6 +62,55 @@ BlueQueueDiscTestItem::AddHeader (void)
 {
 }
 
+class BlueQueueDiscEcnTestItem : public QueueDiscItem
+{
+public:
+  BlueQueueDiscEcnTestItem (Ptr<Packet> p, const Address & addr, uint16_t protocol, bool ecnCapable);
+  virtual ~BlueQueueDiscEcnTestItem ();
+  virtual void AddHeader (void);
+  virtual bool Mark (void);
+  bool IsMarked (void) const;
+
+private:
+  BlueQueueDiscEcnTestItem ();
+  BlueQueueDiscEcnTestItem (const BlueQueueDiscEcnTestItem &);
+  BlueQueueDiscEcnTestItem &operator = (const BlueQueueDiscEcnTestItem &);
+  bool m_ecnCapable;
+  bool m_marked;
+};
+
+BlueQueueDiscEcnTestItem::BlueQueueDiscEcnTestItem (Ptr<Packet> p, const Address & addr, uint16_t protocol, bool ecnCapable)
+  : QueueDiscItem (p, addr, protocol),
+    m_ecnCapable (ecnCapable),
+    m_marked (false)
+{
+}
+
+BlueQueueDiscEcnTestItem::~BlueQueueDiscEcnTestItem ()
+{
+}
+
+void
+BlueQueueDiscEcnTestItem::AddHeader (void)
+{
+}
+
+bool
+BlueQueueDiscEcnTestItem::Mark (void)
+{
+  if (m_ecnCapable)
+    {
+      m_marked = true;
+    }
+  return m_marked;
+}
+
+bool
+BlueQueueDiscEcnTestItem::IsMarked (void) const
+{
+  return m_marked;
+}
+
 class BlueQueueDiscTestCase : public TestCase
 {
 public:
@@ -257,6 +310,488 @@ BlueQueueDiscTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class BlueQueueDiscGentlePmarkTestCase : public TestCase
+{
+public:
+  BlueQueueDiscGentlePmarkTestCase ();
+  virtual void DoRun (void);
+private:
+  double ExpectedPmark (uint32_t nQueued, uint32_t qLimit, double threshold, double initPmark);
+};
+
+BlueQueueDiscGentlePmarkTestCase::BlueQueueDiscGentlePmarkTestCase ()
+  : TestCase ("Check the Gentle-BLUE marking probability table")
+{
+}
+
+double
+BlueQueueDiscGentlePmarkTestCase::ExpectedPmark (uint32_t nQueued, uint32_t qLimit, double threshold, double initPmark)
+{
+  double thresholdQueueLimit = qLimit * threshold;
+  double aboveThreshold = (qLimit - thresholdQueueLimit) / qLimit;
+  if (nQueued <= thresholdQueueLimit)
+    {
+      return (nQueued / thresholdQueueLimit) * aboveThreshold * (1 - initPmark);
+    }
+  else if (nQueued < qLimit)
+    {
+      return aboveThreshold * (1 - initPmark) + (nQueued / (double) qLimit) * (1 - aboveThreshold) * (1 - initPmark);
+    }
+  return 1.0;
+}
+
+void
+BlueQueueDiscGentlePmarkTestCase::DoRun (void)
+{
+  uint32_t qLimit = 100;
+  Ptr<BlueQueueDisc> queue = CreateObject<BlueQueueDisc> ();
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("QueueLimit", UintegerValue (qLimit)), true,
+                         "Verify that we can actually set the attribute QueueLimit");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("Thresold", DoubleValue (0.6)), true,
+                         "Verify that we can actually set the attribute Thresold");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("IntiPmark", DoubleValue (0.15)), true,
+                         "Verify that we can actually set the attribute IntiPmark");
+
+  for (uint32_t n = 0; n <= qLimit + 10; n++)
+    {
+      NS_TEST_EXPECT_MSG_EQ_TOL (queue->GetGentlePmark (n), ExpectedPmark (n, qLimit, 0.6, 0.15), 1e-9,
+                                 "Wrong marking probability for queue size " << n);
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetGentlePmark (qLimit), 1.0, "A full queue should force a drop");
+
+  // the table must be rebuilt when the attributes change
+  qLimit = 400;
+  queue->SetQueueLimit (qLimit);
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("Thresold", DoubleValue (0.3)), true,
+                         "Verify that we can actually set the attribute Thresold");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("IntiPmark", DoubleValue (0.5)), true,
+                         "Verify that we can actually set the attribute IntiPmark");
+  for (uint32_t n = 0; n <= qLimit; n += 7)
+    {
+      NS_TEST_EXPECT_MSG_EQ_TOL (queue->GetGentlePmark (n), ExpectedPmark (n, qLimit, 0.3, 0.5), 1e-9,
+                                 "Wrong marking probability after changing the attributes, queue size " << n);
+    }
+}
+
+class BlueQueueDiscEventLogTestCase : public TestCase
+{
+public:
+  BlueQueueDiscEventLogTestCase ();
+  virtual void DoRun (void);
+private:
+  void Decision (const BlueQueueDisc::Event & event);
+  uint32_t m_nDecisions;
+};
+
+BlueQueueDiscEventLogTestCase::BlueQueueDiscEventLogTestCase ()
+  : TestCase ("Check the BLUE decision trace and event log"),
+    m_nDecisions (0)
+{
+}
+
+void
+BlueQueueDiscEventLogTestCase::Decision (const BlueQueueDisc::Event & event)
+{
+  m_nDecisions++;
+}
+
+void
+BlueQueueDiscEventLogTestCase::DoRun (void)
+{
+  Ptr<BlueQueueDisc> queue = CreateObject<BlueQueueDisc> ();
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("QueueLimit", UintegerValue (6)), true,
+                         "Verify that we can actually set the attribute QueueLimit");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("EventLogSize", UintegerValue (4)), true,
+                         "Verify that we can actually set the attribute EventLogSize");
+  queue->TraceConnectWithoutContext ("Decision", MakeCallback (&BlueQueueDiscEventLogTestCase::Decision, this));
+  queue->Initialize ();
+
+  Address dest;
+  for (uint32_t i = 0; i < 8; i++)
+    {
+      queue->Enqueue (Create<BlueQueueDiscTestItem> (Create<Packet> (100), dest, 0));
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_nDecisions, 8, "The trace source should fire once per packet");
+
+  // only the last four decisions are kept: two enqueued packets and two forced drops
+  std::vector<BlueQueueDisc::Event> events = queue->GetEventLog ();
+  NS_TEST_ASSERT_MSG_EQ (events.size (), 4, "The event log should hold four decisions");
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (events[i].qlen, std::min (i + 4, 6u), "Decisions should be ordered oldest first");
+    }
+  NS_TEST_EXPECT_MSG_EQ (events[1].verdict, BlueQueueDisc::ENQUEUED, "The sixth packet should be enqueued");
+  NS_TEST_EXPECT_MSG_EQ (events[2].verdict, BlueQueueDisc::FORCED_DROP, "The seventh packet should be dropped");
+
+  std::string filename = CreateTempDirFilename ("blue-event-log.bin");
+  NS_TEST_ASSERT_MSG_EQ (queue->DumpEventLog (filename), true, "Cannot write the event log");
+  std::ifstream is (filename.c_str (), std::ios::in | std::ios::binary);
+  uint32_t header[4];
+  is.read (reinterpret_cast<char *> (header), sizeof (header));
+  NS_TEST_EXPECT_MSG_EQ (header[0], BlueQueueDisc::EVENT_LOG_MAGIC, "Wrong magic number");
+  NS_TEST_EXPECT_MSG_EQ (header[2], sizeof (BlueQueueDisc::Event), "Wrong record size");
+  NS_TEST_EXPECT_MSG_EQ (header[3], 4, "Wrong number of records");
+  BlueQueueDisc::Event last;
+  is.seekg (3 * sizeof (BlueQueueDisc::Event), std::ios::cur);
+  is.read (reinterpret_cast<char *> (&last), sizeof (last));
+  NS_TEST_EXPECT_MSG_EQ (is.good (), true, "The event log file is truncated");
+  NS_TEST_EXPECT_MSG_EQ (last.verdict, BlueQueueDisc::FORCED_DROP, "Wrong verdict in the last record");
+  queue->Dispose ();
+
+  // no file is written when the log is disabled
+  std::string disabled = CreateTempDirFilename ("blue-event-log-disabled.bin");
+  queue = CreateObject<BlueQueueDisc> ();
+  queue->SetAttribute ("EventLogFile", StringValue (disabled));
+  queue->Initialize ();
+  queue->Enqueue (Create<BlueQueueDiscTestItem> (Create<Packet> (100), dest, 0));
+  queue->Dispose ();
+  std::ifstream none (disabled.c_str ());
+  NS_TEST_EXPECT_MSG_EQ (none.is_open (), false, "The disabled event log should not be written");
+}
+
+class BlueQueueDiscEcnTestCase : public TestCase
+{
+public:
+  BlueQueueDiscEcnTestCase ();
+  virtual void DoRun (void);
+private:
+  void RunEcnTest (bool useEcn);
+};
+
+BlueQueueDiscEcnTestCase::BlueQueueDiscEcnTestCase ()
+  : TestCase ("Check that BLUE marks ECN-capable packets instead of dropping them")
+{
+}
+
+void
+BlueQueueDiscEcnTestCase::RunEcnTest (bool useEcn)
+{
+  // With a marking probability of 1, every packet is subject to an early
+  // drop or mark
+  Ptr<BlueQueueDisc> queue = CreateObject<BlueQueueDisc> ();
+  queue->SetAttribute ("QueueLimit", UintegerValue (20));
+  queue->SetAttribute ("PMark", DoubleValue (1.0));
+  queue->SetAttribute ("UseEcn", BooleanValue (useEcn));
+  queue->SetAttribute ("EventLogSize", UintegerValue (10));
+  queue->Initialize ();
+
+  Address dest;
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      queue->Enqueue (Create<BlueQueueDiscEcnTestItem> (Create<Packet> (100), dest, 0, i % 2 == 0));
+    }
+
+  BlueQueueDisc::Stats st = queue->GetStats ();
+  if (!useEcn)
+    {
+      NS_TEST_EXPECT_MSG_EQ (st.unforcedMark, 0, "No packet should be marked if ECN is disabled");
+      NS_TEST_EXPECT_MSG_EQ (st.unforcedDrop, 10, "All the packets should be dropped if ECN is disabled");
+      queue->Dispose ();
+      return;
+    }
+  NS_TEST_EXPECT_MSG_EQ (st.unforcedMark, 5, "The ECN-capable packets should be marked");
+  NS_TEST_EXPECT_MSG_EQ (st.unforcedDrop, 5, "The other packets should be dropped");
+  NS_TEST_EXPECT_MSG_EQ (st.forcedDrop, 0, "There should be no forced drops");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetQueueSize (), 5, "The marked packets should be enqueued");
+
+  std::vector<BlueQueueDisc::Event> events = queue->GetEventLog ();
+  NS_TEST_ASSERT_MSG_EQ (events.size (), 10, "The event log should hold ten decisions");
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (events[i].verdict, (i % 2 == 0 ? BlueQueueDisc::UNFORCED_MARK : BlueQueueDisc::UNFORCED_DROP),
+                             "Wrong verdict for packet " << i);
+    }
+
+  Ptr<BlueQueueDiscEcnTestItem> item;
+  while ((item = DynamicCast<BlueQueueDiscEcnTestItem> (queue->Dequeue ())) != 0)
+    {
+      NS_TEST_EXPECT_MSG_EQ (item->IsMarked (), true, "The dequeued packets should be marked");
+    }
+  queue->Dispose ();
+}
+
+void
+BlueQueueDiscEcnTestCase::DoRun (void)
+{
+  RunEcnTest (true);
+  RunEcnTest (false);
+}
+
+class BlueQueueDiscAdaptiveTestCase : public TestCase
+{
+public:
+  BlueQueueDiscAdaptiveTestCase ();
+  virtual void DoRun (void);
+private:
+  Ptr<BlueQueueDisc> CreateAdaptiveQueue (Time freezeTime);
+  void Enqueue (Ptr<BlueQueueDisc> queue, bool dequeue);
+};
+
+BlueQueueDiscAdaptiveTestCase::BlueQueueDiscAdaptiveTestCase ()
+  : TestCase ("Check the adaptation of the BLUE parameters to the target delay")
+{
+}
+
+Ptr<BlueQueueDisc>
+BlueQueueDiscAdaptiveTestCase::CreateAdaptiveQueue (Time freezeTime)
+{
+  Ptr<BlueQueueDisc> queue = CreateObject<BlueQueueDisc> ();
+  queue->SetAttribute ("QueueLimit", UintegerValue (2000));
+  queue->SetAttribute ("AdaptiveBlue", BooleanValue (true));
+  queue->SetAttribute ("LinkBandwidth", DataRateValue (DataRate ("1Mbps")));
+  queue->SetAttribute ("TargetDelay", TimeValue (MilliSeconds (10)));
+  queue->SetAttribute ("Interval", TimeValue (MilliSeconds (100)));
+  queue->SetAttribute ("Increment", DoubleValue (0.001));
+  queue->SetAttribute ("Decrement", DoubleValue (0.001));
+  queue->SetAttribute ("FreezeTime", TimeValue (freezeTime));
+  queue->Initialize ();
+  return queue;
+}
+
+void
+BlueQueueDiscAdaptiveTestCase::Enqueue (Ptr<BlueQueueDisc> queue, bool dequeue)
+{
+  Address dest;
+  queue->Enqueue (Create<BlueQueueDiscTestItem> (Create<Packet> (1000), dest, 0));
+  if (dequeue)
+    {
+      queue->Dequeue ();
+    }
+}
+
+void
+BlueQueueDiscAdaptiveTestCase::DoRun (void)
+{
+  // 1000 byte packets arriving every ms on a 1 Mbps link: the queue keeps growing
+  Ptr<BlueQueueDisc> queue = CreateAdaptiveQueue (MilliSeconds (50));
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      Simulator::Schedule (MilliSeconds (i), &BlueQueueDiscAdaptiveTestCase::Enqueue, this, queue, false);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  DoubleValue increment;
+  DoubleValue decrement;
+  TimeValue freezeTime;
+  queue->GetAttribute ("Increment", increment);
+  queue->GetAttribute ("Decrement", decrement);
+  queue->GetAttribute ("FreezeTime", freezeTime);
+  NS_TEST_EXPECT_MSG_GT (increment.Get (), 0.001, "The increment should grow when the delay is above the target");
+  NS_TEST_EXPECT_MSG_LT (decrement.Get (), 0.001, "The decrement should shrink when the delay is above the target");
+  NS_TEST_EXPECT_MSG_LT (freezeTime.Get (), MilliSeconds (50), "The freeze time should shrink when the delay is above the target");
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (freezeTime.Get (), MilliSeconds (10), "The freeze time should not go below the target delay");
+  queue->Dispose ();
+
+  // same arrivals, with a freeze time below the target delay
+  queue = CreateAdaptiveQueue (MilliSeconds (5));
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      Simulator::Schedule (MilliSeconds (i), &BlueQueueDiscAdaptiveTestCase::Enqueue, this, queue, false);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  queue->GetAttribute ("Increment", increment);
+  queue->GetAttribute ("FreezeTime", freezeTime);
+  NS_TEST_EXPECT_MSG_GT (increment.Get (), 0.001, "The increment should grow when the delay is above the target");
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (freezeTime.Get (), MilliSeconds (5), "The freeze time should not grow when the delay is above the target");
+  queue->Dispose ();
+
+  // a packet every 10 ms, which is forwarded at once: the link is underused
+  queue = CreateAdaptiveQueue (MilliSeconds (50));
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      Simulator::Schedule (MilliSeconds (10 * i), &BlueQueueDiscAdaptiveTestCase::Enqueue, this, queue, true);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  queue->GetAttribute ("Increment", increment);
+  queue->GetAttribute ("Decrement", decrement);
+  NS_TEST_EXPECT_MSG_LT (increment.Get (), 0.001, "The increment should shrink when the link is underused");
+  NS_TEST_EXPECT_MSG_GT (decrement.Get (), 0.001, "The decrement should grow when the link is underused");
+  queue->Dispose ();
+}
+
+class BlueQueueDiscPmarkTestCase : public TestCase
+{
+public:
+  BlueQueueDiscPmarkTestCase ();
+  virtual void DoRun (void);
+private:
+  void PmarkTrace (double oldValue, double newValue);
+  void CheckPmark (Ptr<BlueQueueDisc> queue, double expected);
+  void Enqueue (Ptr<BlueQueueDisc> queue, uint32_t nPkt);
+  void Dequeue (Ptr<BlueQueueDisc> queue, uint32_t nPkt);
+  double m_tracedPmark;
+};
+
+BlueQueueDiscPmarkTestCase::BlueQueueDiscPmarkTestCase ()
+  : TestCase ("Check the lazily evaluated BLUE marking probability"),
+    m_tracedPmark (-1)
+{
+}
+
+void
+BlueQueueDiscPmarkTestCase::PmarkTrace (double oldValue, double newValue)
+{
+  m_tracedPmark = newValue;
+}
+
+void
+BlueQueueDiscPmarkTestCase::CheckPmark (Ptr<BlueQueueDisc> queue, double expected)
+{
+  NS_TEST_EXPECT_MSG_EQ_TOL (queue->GetPmark (), expected, 1e-9,
+                             "Wrong marking probability at " << Simulator::Now ().GetSeconds ());
+}
+
+void
+BlueQueueDiscPmarkTestCase::Enqueue (Ptr<BlueQueueDisc> queue, uint32_t nPkt)
+{
+  Address dest;
+  for (uint32_t i = 0; i < nPkt; i++)
+    {
+      queue->Enqueue (Create<BlueQueueDiscTestItem> (Create<Packet> (100), dest, 0));
+    }
+}
+
+void
+BlueQueueDiscPmarkTestCase::Dequeue (Ptr<BlueQueueDisc> queue, uint32_t nPkt)
+{
+  for (uint32_t i = 0; i < nPkt; i++)
+    {
+      queue->Dequeue ();
+    }
+}
+
+void
+BlueQueueDiscPmarkTestCase::DoRun (void)
+{
+  // BLUE: Pmark decays by one Decrement per FreezeTime of idle period
+  Ptr<BlueQueueDisc> queue = CreateObject<BlueQueueDisc> ();
+  queue->SetAttribute ("PMark", DoubleValue (0.5));
+  queue->SetAttribute ("Decrement", DoubleValue (0.1));
+  queue->SetAttribute ("FreezeTime", TimeValue (MilliSeconds (10)));
+  queue->TraceConnectWithoutContext ("Pmark", MakeCallback (&BlueQueueDiscPmarkTestCase::PmarkTrace, this));
+  queue->Initialize ();
+
+  // whether the packet is dropped or not, the queue gets idle at 0 s; Pmark
+  // is not incremented, since the freeze time has not elapsed
+  Simulator::Schedule (Seconds (0), &BlueQueueDiscPmarkTestCase::Enqueue, this, queue, 1);
+  Simulator::Schedule (Seconds (0), &BlueQueueDiscPmarkTestCase::Dequeue, this, queue, 1);
+  Simulator::Schedule (MilliSeconds (5), &BlueQueueDiscPmarkTestCase::CheckPmark, this, queue, 0.5);
+  Simulator::Schedule (MilliSeconds (25), &BlueQueueDiscPmarkTestCase::CheckPmark, this, queue, 0.3);
+  Simulator::Schedule (MilliSeconds (100), &BlueQueueDiscPmarkTestCase::CheckPmark, this, queue, 0.0);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_tracedPmark, -1.0, 1e-9, "The traced Pmark should not change while the queue is idle");
+  queue->Dispose ();
+
+  // Gentle-BLUE: Pmark follows the queue size, also when packets leave
+  queue = CreateObject<BlueQueueDisc> ();
+  queue->SetAttribute ("GentleBlue", BooleanValue (true));
+  queue->SetAttribute ("QueueLimit", UintegerValue (10));
+  queue->SetAttribute ("IntiPmark", DoubleValue (1.0));
+  queue->TraceConnectWithoutContext ("Pmark", MakeCallback (&BlueQueueDiscPmarkTestCase::PmarkTrace, this));
+  queue->Initialize ();
+
+  // with an initial Pmark of 1, Pmark is 0 below the queue limit
+  Enqueue (queue, 5);
+  NS_TEST_EXPECT_MSG_EQ_TOL (queue->GetPmark (), queue->GetGentlePmark (5), 1e-9, "Pmark should follow the queue size");
+  queue->SetAttribute ("IntiPmark", DoubleValue (0.15));
+  NS_TEST_EXPECT_MSG_EQ_TOL (queue->GetPmark (), queue->GetGentlePmark (5), 1e-9, "Pmark should follow the curve");
+  NS_TEST_EXPECT_MSG_GT (queue->GetPmark (), 0.0, "Pmark should be positive with a non empty queue");
+  Dequeue (queue, 2);
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_tracedPmark, queue->GetGentlePmark (3), 1e-9, "The traced Pmark should follow the dequeues");
+  Dequeue (queue, 3);
+  NS_TEST_EXPECT_MSG_EQ_TOL (queue->GetPmark (), 0.0, 1e-9, "Pmark should be 0 when the queue is idle");
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_tracedPmark, 0.0, 1e-9, "The traced Pmark should be 0 when the queue is idle");
+  queue->Dispose ();
+}
+
+class BlueQueueDiscByteModeTestQueue : public BlueQueueDisc
+{
+public:
+  bool Decide (uint32_t nQueued, uint32_t size)
+  {
+    UpdatePmark (nQueued);
+    return DropEarly (size);
+  }
+};
+
+class BlueQueueDiscByteModeTestCase : public TestCase
+{
+public:
+  BlueQueueDiscByteModeTestCase ();
+  virtual void DoRun (void);
+private:
+  double DropRate (Ptr<BlueQueueDiscByteModeTestQueue> queue, uint32_t nQueued, uint32_t size, uint32_t nTrials);
+};
+
+BlueQueueDiscByteModeTestCase::BlueQueueDiscByteModeTestCase ()
+  : TestCase ("Check the packet size aware marking of Gentle-BLUE in byte mode")
+{
+}
+
+double
+BlueQueueDiscByteModeTestCase::DropRate (Ptr<BlueQueueDiscByteModeTestQueue> queue, uint32_t nQueued,
+                                         uint32_t size, uint32_t nTrials)
+{
+  uint32_t drops = 0;
+  for (uint32_t i = 0; i < nTrials; i++)
+    {
+      if (queue->Decide (nQueued, size))
+        {
+          drops++;
+        }
+    }
+  return drops / (double) nTrials;
+}
+
+void
+BlueQueueDiscByteModeTestCase::DoRun (void)
+{
+  uint32_t meanPktSize = 1000;
+  uint32_t nTrials = 10000;
+  Ptr<BlueQueueDiscByteModeTestQueue> queue = CreateObject<BlueQueueDiscByteModeTestQueue> ();
+  queue->SetAttribute ("Mode", StringValue ("QUEUE_MODE_BYTES"));
+  queue->SetAttribute ("GentleBlue", BooleanValue (true));
+  queue->SetAttribute ("QueueLimit", UintegerValue (100000));
+  queue->SetAttribute ("MeanPktSize", UintegerValue (meanPktSize));
+  queue->Initialize ();
+  queue->AssignStreams (1);
+
+  // the drop probability is proportional to the packet size
+  uint32_t nQueued = 50000;
+  double pmark = queue->GetGentlePmark (nQueued);
+  double small = DropRate (queue, nQueued, 100, nTrials);
+  double large = DropRate (queue, nQueued, 1500, nTrials);
+  NS_TEST_EXPECT_MSG_EQ_TOL (small, pmark * 100 / meanPktSize, 0.02, "Wrong drop rate of small packets");
+  NS_TEST_EXPECT_MSG_EQ_TOL (large, std::min (pmark * 1500 / meanPktSize, 1.0), 0.02, "Wrong drop rate of large packets");
+  NS_TEST_EXPECT_MSG_LT (small, large, "Small packets should be dropped less often than large ones");
+
+  // the scaled probability cannot exceed 1
+  nQueued = 95000;
+  NS_TEST_EXPECT_MSG_EQ_TOL (DropRate (queue, nQueued, 64000, nTrials), 1.0, 1e-9, "Huge packets should always be dropped");
+  queue->Dispose ();
+
+  // packets not fitting in the queue are dropped by the queue disc
+  Ptr<BlueQueueDisc> blue = CreateObject<BlueQueueDisc> ();
+  blue->SetAttribute ("Mode", StringValue ("QUEUE_MODE_BYTES"));
+  blue->SetAttribute ("GentleBlue", BooleanValue (true));
+  blue->SetAttribute ("QueueLimit", UintegerValue (1000));
+  blue->SetAttribute ("IntiPmark", DoubleValue (1.0));
+  blue->Initialize ();
+  Address dest;
+  blue->Enqueue (Create<BlueQueueDiscTestItem> (Create<Packet> (600), dest, 0));
+  blue->Enqueue (Create<BlueQueueDiscTestItem> (Create<Packet> (600), dest, 0));
+  NS_TEST_EXPECT_MSG_EQ (blue->GetQueueSize (), 600, "There should be one packet in the queue");
+  NS_TEST_EXPECT_MSG_EQ (blue->GetNPackets (), 1, "The queue disc should count one packet");
+  NS_TEST_EXPECT_MSG_EQ (blue->GetStats ().forcedDrop, 1, "The second packet should be a forced drop");
+  blue->Dispose ();
+}
+
 static class BlueQueueDiscTestSuite : public TestSuite
 {
 public:
@@ -264,5 +799,11 @@ public:
     : TestSuite ("blue-queue-disc", UNIT)
   {
     AddTestCase (new BlueQueueDiscTestCase (), TestCase::QUICK);
+    AddTestCase (new BlueQueueDiscGentlePmarkTestCase (), TestCase::QUICK);
+    AddTestCase (new BlueQueueDiscEventLogTestCase (), TestCase::QUICK);
+    AddTestCase (new BlueQueueDiscEcnTestCase (), TestCase::QUICK);
+    AddTestCase (new BlueQueueDiscAdaptiveTestCase (), TestCase::QUICK);
+    AddTestCase (new BlueQueueDiscPmarkTestCase (), TestCase::QUICK);
+    AddTestCase (new BlueQueueDiscByteModeTestCase (), TestCase::QUICK);
   }
 } g_blueQueueTestSuite;
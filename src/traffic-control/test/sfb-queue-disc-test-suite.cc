@@ -0,0 +1,309 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Sourabh Jain <sourabhjain560@outlook.com>
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+#include "ns3/test.h"
+#include "ns3/sfb-queue-disc.h"
+#include "ns3/packet-filter.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+class SfbQueueDiscTestItem : public QueueDiscItem
+{
+public:
+  SfbQueueDiscTestItem (Ptr<Packet> p, const Address & addr, uint16_t protocol, int32_t flow);
+  virtual ~SfbQueueDiscTestItem ();
+  virtual void AddHeader (void);
+  int32_t GetFlow (void) const;
+
+private:
+  SfbQueueDiscTestItem ();
+  SfbQueueDiscTestItem (const SfbQueueDiscTestItem &);
+  SfbQueueDiscTestItem &operator = (const SfbQueueDiscTestItem &);
+  int32_t m_flow;
+};
+
+SfbQueueDiscTestItem::SfbQueueDiscTestItem (Ptr<Packet> p, const Address & addr, uint16_t protocol, int32_t flow)
+  : QueueDiscItem (p, addr, protocol),
+    m_flow (flow)
+{
+}
+
+SfbQueueDiscTestItem::~SfbQueueDiscTestItem ()
+{
+}
+
+void
+SfbQueueDiscTestItem::AddHeader (void)
+{
+}
+
+int32_t
+SfbQueueDiscTestItem::GetFlow (void) const
+{
+  return m_flow;
+}
+
+/**
+ * Classify the test items based on the flow they carry
+ */
+class SfbQueueDiscTestFilter : public PacketFilter
+{
+public:
+  SfbQueueDiscTestFilter ();
+  virtual ~SfbQueueDiscTestFilter ();
+
+private:
+  virtual bool CheckProtocol (Ptr<QueueDiscItem> item) const;
+  virtual int32_t DoClassify (Ptr<QueueDiscItem> item) const;
+};
+
+SfbQueueDiscTestFilter::SfbQueueDiscTestFilter ()
+{
+}
+
+SfbQueueDiscTestFilter::~SfbQueueDiscTestFilter ()
+{
+}
+
+bool
+SfbQueueDiscTestFilter::CheckProtocol (Ptr<QueueDiscItem> item) const
+{
+  return (DynamicCast<SfbQueueDiscTestItem> (item) != 0);
+}
+
+int32_t
+SfbQueueDiscTestFilter::DoClassify (Ptr<QueueDiscItem> item) const
+{
+  return DynamicCast<SfbQueueDiscTestItem> (item)->GetFlow ();
+}
+
+static Ptr<SfbQueueDisc>
+CreateSfbQueueDisc (void)
+{
+  Ptr<SfbQueueDisc> queue = CreateObject<SfbQueueDisc> ();
+  queue->AddPacketFilter (CreateObject<SfbQueueDiscTestFilter> ());
+  queue->AssignStreams (1);
+  return queue;
+}
+
+static uint32_t
+EnqueueFlow (Ptr<SfbQueueDisc> queue, int32_t flow, uint32_t nPkt)
+{
+  Address dest;
+  uint32_t nEnqueued = 0;
+  for (uint32_t i = 0; i < nPkt; i++)
+    {
+      if (queue->Enqueue (Create<SfbQueueDiscTestItem> (Create<Packet> (500), dest, 0, flow)))
+        {
+          nEnqueued++;
+        }
+    }
+  return nEnqueued;
+}
+
+class SfbQueueDiscTestCase : public TestCase
+{
+public:
+  SfbQueueDiscTestCase ();
+  virtual void DoRun (void);
+};
+
+SfbQueueDiscTestCase::SfbQueueDiscTestCase ()
+  : TestCase ("Sanity check on the sfb queue disc implementation")
+{
+}
+
+void
+SfbQueueDiscTestCase::DoRun (void)
+{
+  Ptr<SfbQueueDisc> queue = CreateSfbQueueDisc ();
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("QueueLimit", UintegerValue (5)), true,
+                         "Verify that we can actually set the attribute QueueLimit");
+  queue->Initialize ();
+
+  Address dest;
+  for (int32_t flow = 1; flow <= 3; flow++)
+    {
+      queue->Enqueue (Create<SfbQueueDiscTestItem> (Create<Packet> (100 * flow), dest, 0, flow));
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetQueueSize (), 3, "There should be three packets in there");
+
+  for (uint32_t size = 100; size <= 300; size += 100)
+    {
+      Ptr<QueueDiscItem> item = queue->Dequeue ();
+      NS_TEST_EXPECT_MSG_EQ ((item != 0), true, "I want to remove a packet");
+      NS_TEST_EXPECT_MSG_EQ (item->GetPacket ()->GetSize (), size, "Packets should be dequeued in FIFO order");
+    }
+  NS_TEST_EXPECT_MSG_EQ ((queue->Dequeue () == 0), true, "There are really no packets in there");
+
+  NS_TEST_EXPECT_MSG_EQ (EnqueueFlow (queue, 4, 7), 5, "Only five packets fit in the queue");
+  SfbQueueDisc::Stats st = queue->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (st.forcedDrop, 2, "Two packets should be dropped due to the queue limit");
+  NS_TEST_EXPECT_MSG_EQ (st.unforcedDrop + st.bucketDrop + st.penaltyDrop, 0, "There should be no other drops");
+
+  queue->Dispose ();
+}
+
+class SfbQueueDiscFairnessTestCase : public TestCase
+{
+public:
+  SfbQueueDiscFairnessTestCase ();
+  virtual void DoRun (void);
+};
+
+SfbQueueDiscFairnessTestCase::SfbQueueDiscFairnessTestCase ()
+  : TestCase ("Check that the unresponsive flows are isolated from the other flows")
+{
+}
+
+void
+SfbQueueDiscFairnessTestCase::DoRun (void)
+{
+  // An initial Pmark of 1 makes the bin marking probability 0 below the
+  // target bin size and 1 from there on, so that the drops are deterministic
+  Ptr<SfbQueueDisc> queue = CreateSfbQueueDisc ();
+  queue->SetAttribute ("InitPmark", DoubleValue (1.0));
+  queue->SetAttribute ("TargetBinSize", UintegerValue (10));
+  queue->SetAttribute ("MaxBinSize", UintegerValue (25));
+  queue->SetAttribute ("PenaltyBurst", UintegerValue (5));
+  queue->Initialize ();
+
+  NS_TEST_EXPECT_MSG_EQ (EnqueueFlow (queue, 1, 100), 15, "The heavy flow reaches the target bin size and uses the penalty burst");
+  NS_TEST_EXPECT_MSG_EQ (EnqueueFlow (queue, 2, 10), 10, "The light flow should not be penalized");
+  SfbQueueDisc::Stats st = queue->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (st.penaltyDrop, 85, "The heavy flow should be rate limited");
+  NS_TEST_EXPECT_MSG_EQ (st.bucketDrop + st.unforcedDrop + st.forcedDrop, 0, "There should be no other drops");
+  queue->Dispose ();
+
+  // A small maximum bin size stops the heavy flow before the penalty burst is used up
+  queue = CreateSfbQueueDisc ();
+  queue->SetAttribute ("InitPmark", DoubleValue (1.0));
+  queue->SetAttribute ("TargetBinSize", UintegerValue (10));
+  queue->SetAttribute ("MaxBinSize", UintegerValue (12));
+  queue->Initialize ();
+
+  NS_TEST_EXPECT_MSG_EQ (EnqueueFlow (queue, 1, 100), 12, "The heavy flow fills its bins");
+  NS_TEST_EXPECT_MSG_EQ (EnqueueFlow (queue, 2, 10), 10, "The light flow should not be penalized");
+  st = queue->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (st.bucketDrop, 88, "The heavy flow should be dropped once its bins are full");
+  NS_TEST_EXPECT_MSG_EQ (st.penaltyDrop + st.unforcedDrop + st.forcedDrop, 0, "There should be no other drops");
+  queue->Dispose ();
+
+  // Many light flows sharing the queue with a heavy one, with enough bins
+  queue = CreateSfbQueueDisc ();
+  queue->SetAttribute ("QueueLimit", UintegerValue (20000));
+  queue->SetAttribute ("Levels", UintegerValue (4));
+  queue->SetAttribute ("BinsPerLevel", UintegerValue (65536));
+  queue->SetAttribute ("InitPmark", DoubleValue (1.0));
+  queue->SetAttribute ("TargetBinSize", UintegerValue (10));
+  queue->SetAttribute ("PenaltyBurst", UintegerValue (0));
+  queue->Initialize ();
+
+  NS_TEST_EXPECT_MSG_EQ (EnqueueFlow (queue, 0, 100), 10, "The heavy flow stops at the target bin size");
+  uint32_t nEnqueued = 0;
+  for (int32_t flow = 1; flow <= 10000; flow++)
+    {
+      nEnqueued += EnqueueFlow (queue, flow, 2);
+    }
+  NS_TEST_EXPECT_MSG_EQ (nEnqueued, 20000 - 10, "The light flows should only be dropped once the queue is full");
+  st = queue->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (st.forcedDrop, 10, "The queue limit should be reached");
+  queue->Dispose ();
+}
+
+class SfbQueueDiscRehashTestCase : public TestCase
+{
+public:
+  SfbQueueDiscRehashTestCase ();
+  virtual void DoRun (void);
+private:
+  void Enqueue (Ptr<SfbQueueDisc> queue, int32_t flow, uint32_t nPkt, uint32_t nExpected);
+  void Dequeue (Ptr<SfbQueueDisc> queue, uint32_t nPkt);
+};
+
+SfbQueueDiscRehashTestCase::SfbQueueDiscRehashTestCase ()
+  : TestCase ("Check the accounting of packets across changes of the hash perturbation")
+{
+}
+
+void
+SfbQueueDiscRehashTestCase::Enqueue (Ptr<SfbQueueDisc> queue, int32_t flow, uint32_t nPkt, uint32_t nExpected)
+{
+  NS_TEST_EXPECT_MSG_EQ (EnqueueFlow (queue, flow, nPkt), nExpected,
+                         "Unexpected number of enqueued packets at " << Simulator::Now ().GetSeconds ());
+}
+
+void
+SfbQueueDiscRehashTestCase::Dequeue (Ptr<SfbQueueDisc> queue, uint32_t nPkt)
+{
+  for (uint32_t i = 0; i < nPkt; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((queue->Dequeue () != 0), true, "I want to remove a packet");
+    }
+}
+
+void
+SfbQueueDiscRehashTestCase::DoRun (void)
+{
+  Ptr<SfbQueueDisc> queue = CreateSfbQueueDisc ();
+  queue->SetAttribute ("InitPmark", DoubleValue (1.0));
+  queue->SetAttribute ("TargetBinSize", UintegerValue (25));
+  queue->SetAttribute ("MaxBinSize", UintegerValue (25));
+  queue->SetAttribute ("RehashInterval", TimeValue (Seconds (1)));
+  queue->SetAttribute ("WarmupTime", TimeValue (Seconds (0.5)));
+  queue->Initialize ();
+
+  // before the warmup: only the bins in use account the packets
+  Simulator::Schedule (Seconds (0.2), &SfbQueueDiscRehashTestCase::Enqueue, this, queue, 1, 26, 25);
+  Simulator::Schedule (Seconds (0.3), &SfbQueueDiscRehashTestCase::Dequeue, this, queue, 25);
+  // during the warmup: both sets of bins account the packets
+  Simulator::Schedule (Seconds (0.7), &SfbQueueDiscRehashTestCase::Enqueue, this, queue, 1, 26, 25);
+  // after the rehash, the warmed up bins take over and still see the flow
+  Simulator::Schedule (Seconds (1.2), &SfbQueueDiscRehashTestCase::Enqueue, this, queue, 1, 1, 0);
+  // the packets accounted in both sets are removed from the bins in use
+  Simulator::Schedule (Seconds (1.3), &SfbQueueDiscRehashTestCase::Dequeue, this, queue, 25);
+  Simulator::Schedule (Seconds (1.4), &SfbQueueDiscRehashTestCase::Enqueue, this, queue, 1, 26, 25);
+  Simulator::Run ();
+
+  SfbQueueDisc::Stats st = queue->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (st.bucketDrop, 4, "Each burst should exceed the bins of the flow by one packet");
+  NS_TEST_EXPECT_MSG_EQ (st.penaltyDrop + st.unforcedDrop + st.forcedDrop, 0, "There should be no other drops");
+
+  Simulator::Destroy ();
+  queue->Dispose ();
+}
+
+static class SfbQueueDiscTestSuite : public TestSuite
+{
+public:
+  SfbQueueDiscTestSuite ()
+    : TestSuite ("sfb-queue-disc", UNIT)
+  {
+    AddTestCase (new SfbQueueDiscTestCase (), TestCase::QUICK);
+    AddTestCase (new SfbQueueDiscFairnessTestCase (), TestCase::QUICK);
+    AddTestCase (new SfbQueueDiscRehashTestCase (), TestCase::QUICK);
+  }
+} g_sfbQueueTestSuite;
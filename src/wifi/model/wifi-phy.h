@@ -1180,6 +1180,21 @@ public:
                              uint16_t channelNumber, uint32_t rate, WifiPreamble preamble,
                              WifiTxVector txVector, struct mpduInfo aMpdu);
 
+  /**
+   * Public method used to check whether a MonitorSniffer trace for the
+   * received packets is connected, before building its arguments.
+   *
+   * \return true if a sink is connected to the MonitorSnifferRx trace source
+   */
+  bool IsMonitorSniffRxTraced (void) const;
+  /**
+   * Public method used to check whether a MonitorSniffer trace for the
+   * transmitted packets is connected, before building its arguments.
+   *
+   * \return true if a sink is connected to the MonitorSnifferTx trace source
+   */
+  bool IsMonitorSniffTxTraced (void) const;
+
   /**
    * TracedCallback signature for monitor mode transmit events.
    *
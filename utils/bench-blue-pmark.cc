@@ -0,0 +1,207 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Micro-benchmark of the Gentle-BLUE drop decision: the table lookup and
+ * pre-drawn uniform values used by BlueQueueDisc are compared against a
+ * per-packet evaluation of the marking curve with one RNG draw per packet.
+ */
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/blue-queue-disc.h"
+#include <iostream>
+#include <stdlib.h> // for exit ()
+#include <limits>
+#include <algorithm>
+
+using namespace ns3;
+
+static uint32_t g_queueLimit = 1000;
+static double g_threshold = 0.6;
+static double g_initPmark = 0.15;
+static uint32_t g_drops = 0;
+
+/**
+ * Expose the protected drop decision of BlueQueueDisc to the benchmark,
+ * next to a reference decision evaluating the marking curve from the
+ * attributes and drawing one uniform value for every packet.
+ */
+class BenchBlueQueueDisc : public BlueQueueDisc
+{
+public:
+  BenchBlueQueueDisc ()
+    : m_referencePmark (0)
+  {
+    m_referenceUv = CreateObject<UniformRandomVariable> ();
+  }
+  virtual ~BenchBlueQueueDisc ()
+  {
+  }
+  void AssignReferenceStream (int64_t stream)
+  {
+    m_referenceUv->SetStream (stream);
+  }
+  bool Decide (uint32_t nQueued)
+  {
+    UpdatePmark (nQueued);
+    return DropEarly (1000);
+  }
+  bool DecideReference (uint32_t nQueued)
+  {
+    UpdatePmarkReference (nQueued);
+    return DropEarlyReference ();
+  }
+
+protected:
+  virtual void UpdatePmarkReference (uint32_t nQueued)
+  {
+    double thresholdQueueLimit = g_queueLimit * g_threshold;
+    double reverseInitPmark = 1 - g_initPmark;
+    if (nQueued <= thresholdQueueLimit)
+      {
+        m_referencePmark = ((nQueued / thresholdQueueLimit) * ((g_queueLimit - thresholdQueueLimit) / g_queueLimit) * (reverseInitPmark));
+      }
+    else if (nQueued < g_queueLimit)
+      {
+        m_referencePmark = ((g_queueLimit - thresholdQueueLimit) / g_queueLimit) * (reverseInitPmark)
+          + (nQueued / (double) g_queueLimit) * (1 - (g_queueLimit - thresholdQueueLimit) / g_queueLimit) * (reverseInitPmark);
+      }
+    else
+      {
+        m_referencePmark = 1.0;
+      }
+  }
+  virtual bool DropEarlyReference (void)
+  {
+    double u = m_referenceUv->GetValue ();
+    if (u <= m_referencePmark)
+      {
+        return true;
+      }
+    return false;
+  }
+
+private:
+  Ptr<UniformRandomVariable> m_referenceUv;
+  double m_referencePmark;
+};
+
+static Ptr<BenchBlueQueueDisc>
+CreateBenchQueue (void)
+{
+  Ptr<BenchBlueQueueDisc> queue = CreateObject<BenchBlueQueueDisc> ();
+  queue->SetAttribute ("QueueLimit", UintegerValue (g_queueLimit));
+  queue->SetAttribute ("Thresold", DoubleValue (g_threshold));
+  queue->SetAttribute ("IntiPmark", DoubleValue (g_initPmark));
+  queue->Initialize ();
+  queue->AssignStreams (1);
+  queue->AssignReferenceStream (1);
+  return queue;
+}
+
+static void
+benchReference (uint32_t n)
+{
+  Ptr<BenchBlueQueueDisc> queue = CreateBenchQueue ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      uint32_t nQueued = i % (g_queueLimit + 1);
+      if (nQueued >= g_queueLimit || queue->DecideReference (nQueued))
+        {
+          g_drops++;
+        }
+    }
+  queue->Dispose ();
+}
+
+static void
+benchTable (uint32_t n)
+{
+  Ptr<BenchBlueQueueDisc> queue = CreateBenchQueue ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      uint32_t nQueued = i % (g_queueLimit + 1);
+      if (nQueued >= g_queueLimit || queue->Decide (nQueued))
+        {
+          g_drops++;
+        }
+    }
+  queue->Dispose ();
+}
+
+static uint64_t
+runBenchOneIteration (void (*bench) (uint32_t), uint32_t n)
+{
+  SystemWallClockMs time;
+  g_drops = 0;
+  time.Start ();
+  (*bench) (n);
+  uint64_t deltaMs = time.End ();
+  return deltaMs;
+}
+
+static void
+runBench (void (*bench) (uint32_t), uint32_t n, uint32_t minIterations, char const *name)
+{
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max();
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      uint64_t delay = runBenchOneIteration(bench, n);
+      minDelay = std::min(minDelay, delay);
+    }
+  double ps = n;
+  ps *= 1000;
+  ps /= std::max<uint64_t> (minDelay, 1);
+  std::cout << ps << " decisions/s"
+            << " (" << minDelay << " ms elapsed, "
+            << g_drops << " drops)\t"
+            << name
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 0;
+  uint32_t minIterations = 1;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the Gentle-BLUE drop decision of BlueQueueDisc");
+  cmd.AddValue ("n", "number of drop decisions", n);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.AddValue ("queue-limit", "queue limit in packets", g_queueLimit);
+  cmd.AddValue ("threshold", "Gentle-BLUE threshold", g_threshold);
+  cmd.AddValue ("init-pmark", "Gentle-BLUE initial marking probability", g_initPmark);
+  cmd.Parse (argc, argv);
+
+  if (n == 0)
+    {
+      std::cerr << "Error-- number of decisions must be specified " <<
+        "by command-line argument --n=(number of decisions)" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-blue-pmark with n=" << n << std::endl;
+
+  runBench (&benchReference, n, minIterations, "Per-packet curve evaluation and RNG draw");
+  runBench (&benchTable, n, minIterations, "Pmark table and pre-drawn RNG values");
+
+  return 0;
+}
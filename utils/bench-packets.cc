@@ -302,6 +302,80 @@ benchByteTags (uint32_t n)
     }
 }
 
+/*
+ * Tag each packet with a few small packet tags and a byte tag of the
+ * size of the Ipv4FlowProbeTag, as FlowMonitor and QoS tagging do, and
+ * look them up in copies of the packet.
+ */
+static void
+benchPacketTags (uint32_t n)
+{
+  BenchTag<4> flowId;
+  BenchTag<1> tos;
+  BenchTag<2> priority;
+  BenchTag<20> flowProbe;
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (1000);
+      p->AddPacketTag (flowId);
+      p->AddPacketTag (tos);
+      p->AddByteTag (flowProbe);
+      Ptr<Packet> o = p->Copy ();
+      o->PeekPacketTag (flowId);
+      o->RemovePacketTag (tos);
+      o->ReplacePacketTag (priority);
+      o->PeekPacketTag (flowId);
+      o->FindFirstMatchingByteTag (flowProbe);
+    }
+}
+
+/*
+ * Segment a 64KB bulk transfer into 1448-byte segments, and
+ * reassemble them in order, as TcpTxBuffer and TcpRxBuffer do.
+ * The payload is either virtual (zero-filled, never allocated)
+ * or real (copied from an application buffer).
+ */
+static Ptr<Packet>
+bulkTransfer (Ptr<Packet> data)
+{
+  BenchHeader<20> ipv4;
+  BenchHeader<20> tcp;
+
+  Ptr<Packet> reassembled = Create<Packet> ();
+  uint32_t size = data->GetSize ();
+  for (uint32_t offset = 0; offset < size; offset += 1448)
+    {
+      Ptr<Packet> segment = data->CreateFragment (offset, std::min (1448U, size - offset));
+      segment->AddHeader (tcp);
+      segment->AddHeader (ipv4);
+
+      segment->RemoveHeader (ipv4);
+      segment->RemoveHeader (tcp);
+      reassembled->AddAtEnd (segment);
+    }
+  return reassembled;
+}
+
+static void
+benchBulkVirtual (uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      bulkTransfer (Create<Packet> (65536));
+    }
+}
+
+static void
+benchBulkReal (uint32_t n)
+{
+  static uint8_t payload[65536];
+  for (uint32_t i = 0; i < n; i++)
+    {
+      bulkTransfer (Create<Packet> (payload, sizeof (payload)));
+    }
+}
+
 static uint64_t
 runBenchOneIteration (void (*bench) (uint32_t), uint32_t n)
 {
@@ -336,14 +410,25 @@ int main (int argc, char *argv[])
   uint32_t n = 0;
   uint32_t minIterations = 1;
   bool enablePrinting = false;
+  bool lazyPrinting = false;
 
   CommandLine cmd;
   cmd.Usage ("Benchmark Packet class");
   cmd.AddValue ("n", "number of iterations", n);
   cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
   cmd.AddValue ("enable-printing", "enable packet printing", enablePrinting);
+  cmd.AddValue ("lazy-printing", "enable packet printing, with the metadata built on demand", lazyPrinting);
   cmd.Parse (argc, argv);
 
+  if (lazyPrinting)
+    {
+      Packet::EnableLazyPrinting ();
+    }
+  else if (enablePrinting)
+    {
+      Packet::EnablePrinting ();
+    }
+
   if (n == 0)
     {
       std::cerr << "Error-- number of packets must be specified " <<
@@ -359,6 +444,22 @@ int main (int argc, char *argv[])
   runBench (&benchD, n, minIterations, "Intermixed add/remove headers and tags");
   runBench (&benchFragment, n, minIterations, "Fragmentation and concatenation");
   runBench (&benchByteTags, n, minIterations, "Benchmark byte tags");
+  runBench (&benchPacketTags, n, minIterations, "Small packet and byte tags");
+  runBench (&benchBulkVirtual, n, minIterations, "Bulk transfer, virtual payload");
+  runBench (&benchBulkReal, n, minIterations, "Bulk transfer, real payload");
+
+  uint8_t payload[65536];
+  std::cout << "Bulk transfer, serialized size of the reassembled packet:"
+            << " virtual payload " << bulkTransfer (Create<Packet> (65536))->GetSerializedSize ()
+            << ", real payload " << bulkTransfer (Create<Packet> (payload, sizeof (payload)))->GetSerializedSize ()
+            << std::endl;
+
+  DataPool::Stats buffer = Buffer::GetPoolStats ();
+  DataPool::Stats metadata = PacketMetadata::GetPoolStats ();
+  std::cout << "Buffer data pool: " << buffer.hits << " hits, " << buffer.misses << " misses, "
+            << buffer.peakBytes << " peak bytes" << std::endl
+            << "Metadata data pool: " << metadata.hits << " hits, " << metadata.misses << " misses, "
+            << metadata.peakBytes << " peak bytes" << std::endl;
 
   return 0;
 }
@@ -0,0 +1,397 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Throughput benchmark of the queue discs: BLUE, Gentle-BLUE, RED, CoDel
+ * and pfifo_fast are driven directly with synthetic arrival patterns, and
+ * the time, the heap allocations and the drop rate per operation (one
+ * Enqueue or Dequeue call) are reported.
+ *
+ * The simulation time advances by one event every "batch" packet
+ * transmission times, so that the time-based algorithms see a realistic
+ * clock; the cost of these events is included in the time per operation.
+ * The allocations are only counted within the queue disc calls, and the
+ * queue disc items are recycled, hence allocs/op only accounts for the
+ * queue disc itself.
+ */
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/data-rate.h"
+#include "ns3/packet.h"
+#include "ns3/queue-disc.h"
+#include "ns3/packet-filter.h"
+#include "ns3/blue-queue-disc.h"
+#include "ns3/red-queue-disc.h"
+#include "ns3/codel-queue-disc.h"
+#include "ns3/pfifo-fast-queue-disc.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <new>
+#include <stdlib.h> // for exit (), malloc () and free ()
+#include <limits>
+#include <algorithm>
+
+using namespace ns3;
+
+// the exception specification of operator new was removed in C++11
+#if __cplusplus >= 201103L
+#define BENCH_THROW_BAD_ALLOC
+#define BENCH_NOTHROW noexcept
+#else
+#define BENCH_THROW_BAD_ALLOC throw (std::bad_alloc)
+#define BENCH_NOTHROW throw ()
+#endif
+
+// The replacements below allocate with malloc () and release with free ()
+// only, every operator new having its matching operator delete. They are
+// not inlined, so that the compiler does not pair the malloc () and free ()
+// calls they contain with the new and delete expressions of the callers,
+// which GCC 11 and later would report as mismatched allocation functions.
+#ifdef __GNUC__
+#define BENCH_NOINLINE __attribute__ ((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+static uint64_t g_allocs = 0;
+static bool g_countAllocs = false;
+
+BENCH_NOINLINE void *
+operator new (size_t size, const std::nothrow_t &) BENCH_NOTHROW
+{
+  if (g_countAllocs)
+    {
+      g_allocs++;
+    }
+  return malloc (size == 0 ? 1 : size);
+}
+
+BENCH_NOINLINE void *
+operator new (size_t size) BENCH_THROW_BAD_ALLOC
+{
+  void *p = operator new (size, std::nothrow);
+  if (p == 0)
+    {
+      throw std::bad_alloc ();
+    }
+  return p;
+}
+
+BENCH_NOINLINE void *
+operator new[] (size_t size) BENCH_THROW_BAD_ALLOC
+{
+  return operator new (size);
+}
+
+BENCH_NOINLINE void *
+operator new[] (size_t size, const std::nothrow_t &) BENCH_NOTHROW
+{
+  return operator new (size, std::nothrow);
+}
+
+BENCH_NOINLINE void
+operator delete (void *p) BENCH_NOTHROW
+{
+  free (p);
+}
+
+BENCH_NOINLINE void
+operator delete[] (void *p) BENCH_NOTHROW
+{
+  free (p);
+}
+
+BENCH_NOINLINE void
+operator delete (void *p, const std::nothrow_t &) BENCH_NOTHROW
+{
+  free (p);
+}
+
+BENCH_NOINLINE void
+operator delete[] (void *p, const std::nothrow_t &) BENCH_NOTHROW
+{
+  free (p);
+}
+
+#ifdef __cpp_sized_deallocation
+BENCH_NOINLINE void
+operator delete (void *p, size_t) BENCH_NOTHROW
+{
+  free (p);
+}
+
+BENCH_NOINLINE void
+operator delete[] (void *p, size_t) BENCH_NOTHROW
+{
+  free (p);
+}
+#endif
+
+/**
+ * Queue disc item with no header to add.
+ */
+class BenchQueueDiscItem : public QueueDiscItem
+{
+public:
+  BenchQueueDiscItem (Ptr<Packet> p, const Address & addr, uint16_t protocol)
+    : QueueDiscItem (p, addr, protocol)
+  {
+  }
+  virtual ~BenchQueueDiscItem ()
+  {
+  }
+  virtual void AddHeader (void)
+  {
+  }
+};
+
+/**
+ * Packet filter putting all the packets in the same band of pfifo_fast.
+ */
+class BenchPacketFilter : public PacketFilter
+{
+public:
+  virtual ~BenchPacketFilter ()
+  {
+  }
+
+private:
+  virtual bool CheckProtocol (Ptr<QueueDiscItem> item) const
+  {
+    return true;
+  }
+  virtual int32_t DoClassify (Ptr<QueueDiscItem> item) const
+  {
+    return 1;
+  }
+};
+
+/// Arrival patterns
+enum Pattern
+{
+  STEADY,     //!< One arrival per transmission time: the link is fully used
+  BURSTY,     //!< The same load, in bursts of g_burst packets
+  OVERLOAD    //!< Two arrivals per transmission time
+};
+
+static uint32_t g_pktSize = 1000;
+static DataRate g_linkRate ("10Mbps");
+static uint32_t g_batch = 16;
+static uint32_t g_burst = 64;
+
+/**
+ * Drive a queue disc with one of the arrival patterns, one packet being
+ * dequeued per transmission time.
+ */
+class Bench
+{
+public:
+  Bench (Ptr<QueueDisc> qdisc, enum Pattern pattern, uint32_t n)
+    : m_qdisc (qdisc),
+      m_pattern (pattern),
+      m_n (n),
+      m_ops (0),
+      m_slot (0)
+  {
+  }
+  void Run (void)
+  {
+    Simulator::ScheduleNow (&Bench::Tick, this);
+    Simulator::Run ();
+    Simulator::Destroy ();
+    m_free.clear ();
+  }
+  uint64_t GetOps (void) const
+  {
+    return m_ops;
+  }
+
+private:
+  void Tick (void)
+  {
+    for (uint32_t i = 0; i < g_batch; i++, m_slot++)
+      {
+        uint32_t arrivals = 1;
+        if (m_pattern == BURSTY)
+          {
+            arrivals = (m_slot % g_burst == 0) ? g_burst : 0;
+          }
+        else if (m_pattern == OVERLOAD)
+          {
+            arrivals = 2;
+          }
+        for (uint32_t j = 0; j < arrivals; j++)
+          {
+            Ptr<QueueDiscItem> item = NewItem ();
+            g_countAllocs = true;
+            bool enqueued = m_qdisc->Enqueue (item);
+            g_countAllocs = false;
+            if (!enqueued)
+              {
+                m_free.push_back (item);
+              }
+          }
+        g_countAllocs = true;
+        Ptr<QueueDiscItem> item = m_qdisc->Dequeue ();
+        g_countAllocs = false;
+        if (item != 0)
+          {
+            m_free.push_back (item);
+          }
+        m_ops += arrivals + 1;
+      }
+    if (m_ops < m_n)
+      {
+        Simulator::Schedule (g_linkRate.CalculateBytesTxTime (g_pktSize * g_batch), &Bench::Tick, this);
+      }
+  }
+  Ptr<QueueDiscItem> NewItem (void)
+  {
+    if (m_free.empty ())
+      {
+        return Create<BenchQueueDiscItem> (Create<Packet> (g_pktSize), Address (), 0);
+      }
+    Ptr<QueueDiscItem> item = m_free.back ();
+    m_free.pop_back ();
+    return item;
+  }
+
+  Ptr<QueueDisc> m_qdisc;
+  enum Pattern m_pattern;
+  uint64_t m_n;
+  uint64_t m_ops;
+  uint64_t m_slot;
+  std::vector<Ptr<QueueDiscItem> > m_free;
+};
+
+static Ptr<QueueDisc>
+CreateQueueDisc (std::string type)
+{
+  Ptr<QueueDisc> qdisc;
+  if (type == "BLUE" || type == "GentleBLUE")
+    {
+      qdisc = CreateObject<BlueQueueDisc> ();
+      qdisc->SetAttribute ("GentleBlue", BooleanValue (type == "GentleBLUE"));
+    }
+  else if (type == "RED")
+    {
+      qdisc = CreateObject<RedQueueDisc> ();
+      qdisc->SetAttribute ("LinkBandwidth", DataRateValue (g_linkRate));
+    }
+  else if (type == "CoDel")
+    {
+      qdisc = CreateObject<CoDelQueueDisc> ();
+    }
+  else if (type == "PfifoFast")
+    {
+      qdisc = CreateObject<PfifoFastQueueDisc> ();
+      qdisc->AddPacketFilter (CreateObject<BenchPacketFilter> ());
+    }
+  else
+    {
+      std::cerr << "Unknown queue disc " << type << std::endl;
+      exit (1);
+    }
+  qdisc->Initialize ();
+  return qdisc;
+}
+
+static void
+runBench (std::string type, enum Pattern pattern, uint32_t n, uint32_t minIterations, char const *name)
+{
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max();
+  uint64_t ops = 0;
+  uint64_t allocs = 0;
+  double dropRate = 0;
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      Ptr<QueueDisc> qdisc = CreateQueueDisc (type);
+      Bench bench (qdisc, pattern, n);
+      g_allocs = 0;
+      SystemWallClockMs time;
+      time.Start ();
+      bench.Run ();
+      uint64_t delay = time.End ();
+      if (delay < minDelay)
+        {
+          minDelay = delay;
+          ops = bench.GetOps ();
+          allocs = g_allocs;
+          dropRate = qdisc->GetTotalDroppedPackets () / (double) std::max<uint32_t> (qdisc->GetTotalReceivedPackets (), 1);
+        }
+      qdisc->Dispose ();
+    }
+  std::cout << std::setw (9) << minDelay * 1e6 / ops << " ns/op "
+            << std::setw (7) << allocs / (double) ops << " allocs/op "
+            << std::setw (7) << dropRate << " drop rate\t"
+            << type << " " << name
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 0;
+  uint32_t minIterations = 1;
+  std::string queueDiscs = "BLUE,GentleBLUE,RED,CoDel,PfifoFast";
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the enqueue and dequeue operations of the queue discs");
+  cmd.AddValue ("n", "number of enqueue and dequeue operations", n);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.AddValue ("queue-discs", "comma separated list of queue discs (BLUE, GentleBLUE, RED, CoDel, PfifoFast)", queueDiscs);
+  cmd.AddValue ("pkt-size", "packet size in bytes", g_pktSize);
+  cmd.AddValue ("link-rate", "rate at which packets are dequeued", g_linkRate);
+  cmd.AddValue ("batch", "number of packet transmission times per simulation event", g_batch);
+  cmd.AddValue ("burst", "number of packets per burst in the bursty pattern", g_burst);
+  cmd.Parse (argc, argv);
+
+  if (n == 0)
+    {
+      std::cerr << "Error-- number of operations must be specified " <<
+        "by command-line argument --n=(number of operations)" << std::endl;
+      exit (1);
+    }
+  if (g_batch == 0 || g_burst == 0)
+    {
+      std::cerr << "Error-- batch and burst must be positive" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-queue-disc with n=" << n << std::endl;
+
+  std::string::size_type start = 0;
+  while (start <= queueDiscs.size ())
+    {
+      std::string::size_type end = queueDiscs.find (',', start);
+      if (end == std::string::npos)
+        {
+          end = queueDiscs.size ();
+        }
+      std::string type = queueDiscs.substr (start, end - start);
+      runBench (type, STEADY, n, minIterations, "steady");
+      runBench (type, BURSTY, n, minIterations, "bursty");
+      runBench (type, OVERLOAD, n, minIterations, "overload");
+      start = end + 1;
+    }
+
+  return 0;
+}
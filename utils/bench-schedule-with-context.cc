@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Stress benchmark of Simulator::ScheduleWithContext called from threads
+ * other than the simulation thread, as done by the emulation and tap
+ * bridge devices: N threads inject events as fast as they can while the
+ * simulation thread runs and executes them.
+ */
+
+#include "ns3/core-module.h"
+#include <iostream>
+#include <list>
+#include <vector>
+#include <utility>
+#include <stdlib.h> // for exit ()
+#include <limits>
+#include <algorithm>
+
+using namespace ns3;
+
+static uint32_t g_events = 0;
+static uint32_t g_threads = 4;
+static uint64_t g_received = 0;
+static std::vector<uint64_t> g_injectMs;
+
+static void
+Receive (void)
+{
+  g_received++;
+}
+
+static void
+Poll (void)
+{
+  // keep the simulation alive until all the events have been received
+  if (g_received < uint64_t (g_threads) * g_events)
+    {
+      Simulator::Schedule (NanoSeconds (100), &Poll);
+    }
+}
+
+static void
+Inject (uint32_t threadno)
+{
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t i = 0; i < g_events; i++)
+    {
+      Simulator::ScheduleWithContext (threadno, NanoSeconds (10), &Receive);
+    }
+  g_injectMs[threadno] = time.End ();
+}
+
+static uint64_t
+runBenchOneIteration (uint64_t *injectMs)
+{
+  std::list<Ptr<SystemThread> > threads;
+  for (uint32_t i = 0; i < g_threads; i++)
+    {
+      threads.push_back (Create<SystemThread> (MakeBoundCallback (&Inject, i)));
+    }
+
+  g_received = 0;
+  g_injectMs.assign (g_threads, 0);
+  Simulator::Schedule (NanoSeconds (100), &Poll);
+
+  SystemWallClockMs time;
+  time.Start ();
+  for (std::list<Ptr<SystemThread> >::iterator it = threads.begin (); it != threads.end (); ++it)
+    {
+      (*it)->Start ();
+    }
+  Simulator::Run ();
+  uint64_t deltaMs = time.End ();
+
+  for (std::list<Ptr<SystemThread> >::iterator it = threads.begin (); it != threads.end (); ++it)
+    {
+      (*it)->Join ();
+    }
+  Simulator::Destroy ();
+  *injectMs = *std::max_element (g_injectMs.begin (), g_injectMs.end ());
+  return deltaMs;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t minIterations = 1;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark Simulator::ScheduleWithContext called concurrently from several threads");
+  cmd.AddValue ("n", "number of events injected by each thread", g_events);
+  cmd.AddValue ("threads", "number of injecting threads", g_threads);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.Parse (argc, argv);
+
+  if (g_events == 0 || g_threads == 0)
+    {
+      std::cerr << "Error-- number of events must be specified " <<
+        "by command-line argument --n=(number of events)" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-schedule-with-context with n=" << g_events
+            << " threads=" << g_threads << std::endl;
+
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+  uint64_t minInject = std::numeric_limits<uint64_t>::max ();
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      uint64_t injectMs;
+      minDelay = std::min (minDelay, runBenchOneIteration (&injectMs));
+      minInject = std::min (minInject, injectMs);
+    }
+
+  double total = double (g_events) * g_threads;
+  std::cout << total * 1000 / std::max<uint64_t> (minInject, 1) << " events/s injected"
+            << " (" << minInject << " ms for the slowest thread)" << std::endl;
+  std::cout << total * 1000 / std::max<uint64_t> (minDelay, 1) << " events/s executed"
+            << " (" << minDelay << " ms elapsed)" << std::endl;
+
+  return 0;
+}
@@ -23,6 +23,7 @@
 #include <fstream>
 #include <vector>
 #include <string.h>
+#include <stdlib.h>
 
 #include "ns3/core-module.h"
 
@@ -125,17 +126,42 @@ Bench::Cb (void)
 
 
 Ptr<RandomVariableStream>
-GetRandomStream (std::string filename)
+GetRandomStream (std::string filename, std::string distribution)
 {
   Ptr<RandomVariableStream> stream = 0;
   
-  if (filename == "")
+  if (filename == "" && distribution == "exponential")
     {
       LOGME ("using default exponential distribution");
       Ptr<ExponentialRandomVariable> erv = CreateObject<ExponentialRandomVariable> ();
       erv->SetAttribute ("Mean", DoubleValue (100));
       stream = erv;
     }
+  else if (filename == "" && distribution == "uniform")
+    {
+      LOGME ("using uniform distribution");
+      Ptr<UniformRandomVariable> urv = CreateObject<UniformRandomVariable> ();
+      urv->SetAttribute ("Min", DoubleValue (0));
+      urv->SetAttribute ("Max", DoubleValue (200));
+      stream = urv;
+    }
+  else if (filename == "" && distribution == "bimodal")
+    {
+      LOGME ("using bimodal distribution");
+      // 90% of short intervals, uniform in [0, 20] ns, and 10% of long
+      // ones, uniform in [820, 1000] ns: the mean is 100 ns
+      Ptr<EmpiricalRandomVariable> erv = CreateObject<EmpiricalRandomVariable> ();
+      erv->CDF (0, 0.0);
+      erv->CDF (20, 0.9);
+      erv->CDF (820, 0.9);
+      erv->CDF (1000, 1.0);
+      stream = erv;
+    }
+  else if (filename == "")
+    {
+      std::cerr << g_me << "unknown distribution " << distribution << std::endl;
+      exit (1);
+    }
   else
     {
       std::istream *input; 
@@ -186,17 +212,21 @@ int main (int argc, char *argv[])
   bool schedHeap = false;
   bool schedList = false;
   bool schedMap  = true;
+  bool schedLadder = false;
+  bool pool = true;
 
   uint32_t pop   =  100000;
   uint32_t total = 1000000;
   uint32_t runs  =       1;
   std::string filename = "";
+  std::string distribution = "exponential";
   
   CommandLine cmd;
   cmd.Usage ("Benchmark the simulator scheduler.\n"
              "\n"
              "Event intervals are taken from one of:\n"
-             "  an exponential distribution, with mean 100 ns,\n"
+             "  an exponential (default), uniform or bimodal distribution,\n"
+             "  with mean 100 ns, given by the --dist argument,\n"
              "  an ascii file, given by the --file=\"<filename>\" argument,\n"
              "  or standard input, by the argument --file=\"-\"\n"
              "In the case of either --file form, the input is expected\n"
@@ -205,11 +235,14 @@ int main (int argc, char *argv[])
   cmd.AddValue ("heap",  "use HeapScheduler",             schedHeap);
   cmd.AddValue ("list",  "use ListSheduler",              schedList);
   cmd.AddValue ("map",   "use MapScheduler (default)",    schedMap);
+  cmd.AddValue ("ladder", "use LadderScheduler",          schedLadder);
   cmd.AddValue ("debug", "enable debugging output",       g_debug);
   cmd.AddValue ("pop",   "event population size (default 1E5)",         pop);
   cmd.AddValue ("total", "total number of events to run (default 1E6)", total);
   cmd.AddValue ("runs",  "number of runs (default 1)",    runs);
   cmd.AddValue ("file",  "file of relative event times",  filename);
+  cmd.AddValue ("pool",  "allocate the events from free lists (default true)", pool);
+  cmd.AddValue ("dist",  "distribution of the event intervals: exponential, uniform or bimodal", distribution);
   cmd.AddValue ("prec",  "printed output precision",      g_fwidth);
   cmd.Parse (argc, argv);
   g_me = cmd.GetName () + ": ";
@@ -219,7 +252,9 @@ int main (int argc, char *argv[])
   if (schedCal)  { factory.SetTypeId ("ns3::CalendarScheduler"); }
   if (schedHeap) { factory.SetTypeId ("ns3::HeapScheduler");     }
   if (schedList) { factory.SetTypeId ("ns3::ListScheduler");     }  
+  if (schedLadder) { factory.SetTypeId ("ns3::LadderScheduler"); }
   Simulator::SetScheduler (factory);
+  EventImpl::SetPoolEnabled (pool);
 
   LOGME (std::setprecision (g_fwidth - 6));
   DEB ("debugging is ON");
@@ -228,9 +263,10 @@ int main (int argc, char *argv[])
   LOGME ("population: " << pop);
   LOGME ("total events: " << total);
   LOGME ("runs: " << runs);
+  LOGME ("event free lists: " << (pool ? "enabled" : "disabled"));
   
   Bench *bench = new Bench (pop, total);
-  bench->SetRandomStream (GetRandomStream (filename));
+  bench->SetRandomStream (GetRandomStream (filename, distribution));
 
   // table header
   LOG ("");
@@ -269,6 +305,10 @@ int main (int argc, char *argv[])
       bench->RunBench ();
     }
 
+  EventImpl::PoolStats stats = EventImpl::GetPoolStats ();
+  LOG ("");
+  LOGME ("event allocations: " << stats.hits << " from the free lists, "
+         << stats.misses << " from the system allocator");
   LOG ("");
   return 0;
 
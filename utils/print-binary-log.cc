@@ -0,0 +1,48 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Convert a log written by the binary logging backend (configured with
+ * --enable-binary-logs) to the text the logging macros print otherwise.
+ */
+
+#include "ns3/core-module.h"
+#include <fstream>
+#include <iostream>
+
+using namespace ns3;
+
+int main (int argc, char *argv[])
+{
+  std::string input = "ns3-log.bin";
+
+  CommandLine cmd;
+  cmd.AddValue ("input", "the binary log file", input);
+  cmd.Parse (argc, argv);
+
+  std::ifstream is (input.c_str (), std::ios::binary);
+  if (!is)
+    {
+      std::cerr << "could not open " << input << std::endl;
+      return 1;
+    }
+  if (!LogBinaryPrint (is, std::cout))
+    {
+      std::cerr << input << " is not a complete binary log" << std::endl;
+      return 1;
+    }
+  return 0;
+}